@@ -0,0 +1,29 @@
+echo
+echo "##########################################################"
+echo "#               Compiling Benchmarks....                 #"
+echo "##########################################################"
+
+BENCH_FLAGS="-std=c99 -O2 -Wall -Werror -D_DEFAULT_SOURCE"
+INCLUDE_FLAGS="-Iinclude -Isrc -Isrc/memory -Ibench -lm -lpthread"
+ZETA_SRC="src/zeta.c src/dirichlet.c src/parallel.c src/memory/page_arena.c src/memory/scratch_arena.c src/memory/scratch_pool.c"
+
+mkdir -p bench_lib
+
+clang $BENCH_FLAGS bench/bench_expr.c src/expr.c $ZETA_SRC -o bench_lib/expr_bench $INCLUDE_FLAGS || exit 1
+clang $BENCH_FLAGS bench/bench_hugepage.c $ZETA_SRC -o bench_lib/hugepage_bench $INCLUDE_FLAGS || exit 1
+clang $BENCH_FLAGS bench/bench_scratch.c $ZETA_SRC -o bench_lib/scratch_bench $INCLUDE_FLAGS || exit 1
+clang $BENCH_FLAGS bench/bench_ring.c src/memory/ring_queue.c $ZETA_SRC -o bench_lib/ring_bench $INCLUDE_FLAGS || exit 1
+clang $BENCH_FLAGS bench/bench_hash.c src/memory/hash_table.c $ZETA_SRC -o bench_lib/hash_bench $INCLUDE_FLAGS || exit 1
+clang $BENCH_FLAGS bench/bench_vcache.c src/vcache.c src/lod.c $ZETA_SRC -o bench_lib/vcache_bench $INCLUDE_FLAGS || exit 1
+
+echo "[X] Benchmark compilation complete...."
+echo
+echo "Running benchmarks:"
+
+for i in bench_lib/*_bench
+do
+    if test -f $i
+    then
+        ./$i | tee -a bench_output.txt
+    fi
+done
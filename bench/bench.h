@@ -0,0 +1,16 @@
+#ifndef m_BENCH_H
+#define m_BENCH_H
+
+#include <time.h>
+#include "common_types.h"
+
+static inline f64 benchNow(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (f64)ts.tv_sec + (f64)ts.tv_nsec * 1e-9;
+}
+
+#define BENCH_REPORT(name, seconds, items) \
+    fprintf(stdout, "%-40s %10.3f ms %12.2f ns/item\n", name, (seconds) * 1e3, (seconds) * 1e9 / (f64)(items))
+
+#endif
@@ -0,0 +1,84 @@
+#include <math.h>
+#include "bench.h"
+#include "zeta.h"
+#include "expr.h"
+
+#define GRID_W 512
+#define GRID_H 128
+#define REPEAT 3
+
+typedef struct ScalarCtx {
+    ComplexFunc func;
+} ScalarCtx;
+
+static void scalarRow(void* ctx, const f32* sigma, f32 t, u32 count, f32* re_out, f32* im_out) {
+    ScalarCtx* s = ctx;
+    for (u32 j = 0; j < count; j++) {
+        s->func(sigma[j], t, &re_out[j], &im_out[j]);
+    }
+}
+
+static f32 sigmaRow[GRID_W];
+static f32 outRe[GRID_W];
+static f32 outIm[GRID_W];
+static f32 refRe[GRID_W];
+static f32 refIm[GRID_W];
+
+static f64 timeRows(ComplexRowFunc func, void* ctx) {
+    f64 best = 1e30;
+    for (u32 r = 0; r < REPEAT; r++) {
+        f64 start = benchNow();
+        for (u32 i = 0; i < GRID_H; i++) {
+            func(ctx, sigmaRow, 5.0f + i * 0.1f, GRID_W, outRe, outIm);
+        }
+        f64 elapsed = benchNow() - start;
+        best = (elapsed < best) ? elapsed : best;
+    }
+    return best;
+}
+
+static f32 maxError(ComplexRowFunc a, void* actx, ComplexRowFunc b, void* bctx) {
+    a(actx, sigmaRow, 14.0f, GRID_W, refRe, refIm);
+    b(bctx, sigmaRow, 14.0f, GRID_W, outRe, outIm);
+    f32 worst = 0.0f;
+    for (u32 j = 0; j < GRID_W; j++) {
+        f32 scale = fmaxf(1.0f, sqrtf(refRe[j] * refRe[j] + refIm[j] * refIm[j]));
+        f32 err = (fabsf(refRe[j] - outRe[j]) + fabsf(refIm[j] - outIm[j])) / scale;
+        worst = (err > worst) ? err : worst;
+    }
+    return worst;
+}
+
+static void compare(const char* label, const char* source, ComplexRowFunc hand, void* handCtx) {
+    ExprProgram program;
+    if(exprCompile(&program, source) != 0) {
+        fprintf(stdout, "%s: failed to compile '%s'\n", label, source);
+        return;
+    }
+    f64 handTime = timeRows(hand, handCtx);
+    f64 exprTime = timeRows(exprRow, &program);
+    char name[64];
+    snprintf(name, sizeof(name), "%s hand C", label);
+    BENCH_REPORT(name, handTime, GRID_W * GRID_H);
+    snprintf(name, sizeof(name), "%s expr '%s'", label, source);
+    BENCH_REPORT(name, exprTime, GRID_W * GRID_H);
+    fprintf(stdout, "  ratio %.2fx, %u instructions, max rel error %g\n", exprTime / handTime,
+            program.codeCount, maxError(hand, handCtx, exprRow, &program));
+}
+
+int main(void) {
+    for (u32 j = 0; j < GRID_W; j++) {
+        sigmaRow[j] = 0.5f + j * (0.5f / (GRID_W - 1));
+    }
+    fprintf(stdout, "expression interpreter vs hand written C, %dx%d grid, %d lanes\n", GRID_W, GRID_H, EXPR_LANES);
+
+    ScalarCtx zeta = { .func = zetaApprox };
+    ScalarCtx expi = { .func = expITheta };
+    ScalarCtx sinc = { .func = sin_complex };
+    compare("zetaApprox", "zeta(s)", scalarRow, &zeta);
+    compare("zetaApproxRow", "zeta(s)", zetaApproxRow, NULL);
+    compare("expITheta", "exp(i*s)", scalarRow, &expi);
+    compare("sin_complex", "sin(s)", scalarRow, &sinc);
+    compare("sin_complex", "(exp(i*s) - exp(-i*s)) / (2*i)", scalarRow, &sinc);
+    return 0;
+}
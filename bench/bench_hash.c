@@ -0,0 +1,176 @@
+#include "bench.h"
+#include "arena_base.h"
+#include "page_arena.h"
+#include "hash_table.h"
+
+#define MAX_KEYS 1000000
+
+typedef struct ChainNode {
+    u64 key;
+    u64 value;
+    struct ChainNode* next;
+} ChainNode;
+
+//the baseline: one malloc per entry and a pointer chase per probe
+typedef struct ChainTable {
+    ChainNode** buckets;
+    u64 mask;
+} ChainTable;
+
+static void chainInit(ChainTable* table, u32 expected) {
+    u64 count = 16;
+    while(count < expected) {
+        count <<= 1;
+    }
+    table->buckets = calloc(count, sizeof(ChainNode*));
+    table->mask = count - 1;
+}
+
+static u64* chainInsert(ChainTable* table, u64 key) {
+    ChainNode** bucket = &table->buckets[hashMix64(key) & table->mask];
+    for (ChainNode* n = *bucket; n; n = n->next) {
+        if(n->key == key) {
+            return &n->value;
+        }
+    }
+    ChainNode* node = malloc(sizeof(ChainNode));
+    node->key = key;
+    node->value = 0;
+    node->next = *bucket;
+    *bucket = node;
+    return &node->value;
+}
+
+static u64* chainFind(ChainTable* table, u64 key) {
+    for (ChainNode* n = table->buckets[hashMix64(key) & table->mask]; n; n = n->next) {
+        if(n->key == key) {
+            return &n->value;
+        }
+    }
+    return NULL;
+}
+
+static void chainRemove(ChainTable* table, u64 key) {
+    ChainNode** link = &table->buckets[hashMix64(key) & table->mask];
+    while(*link) {
+        if((*link)->key == key) {
+            ChainNode* dead = *link;
+            *link = dead->next;
+            free(dead);
+            return;
+        }
+        link = &(*link)->next;
+    }
+}
+
+static void chainDestroy(ChainTable* table) {
+    for (u64 b = 0; b <= table->mask; b++) {
+        ChainNode* n = table->buckets[b];
+        while(n) {
+            ChainNode* next = n->next;
+            free(n);
+            n = next;
+        }
+    }
+    free(table->buckets);
+}
+
+static u64 keys[MAX_KEYS];
+
+//tile ids and quantized zero positions are clustered, not random
+static void makeKeys(u32 count) {
+    for (u32 i = 0; i < count; i++) {
+        u64 level = i % 8;
+        u64 tx = (i / 8) % 1024;
+        u64 ty = i / 8192;
+        keys[i] = (level << 48) | (ty << 24) | tx;
+    }
+}
+
+static void benchCount(memMap* map, u32 count) {
+    char name[64];
+    u64 sink = 0;
+    makeKeys(count);
+
+    PageArena* arena = createPageArena(map, (usize)count * 48 + MiB(1));
+    HashTable table;
+    if(!arena || hashInit(&table, arena, count, sizeof(u64)) != 0) {
+        return;
+    }
+    f64 start = benchNow();
+    for (u32 i = 0; i < count; i++) {
+        *(u64*)hashInsert(&table, keys[i], NULL) = i;
+    }
+    f64 insert = benchNow() - start;
+    start = benchNow();
+    for (u32 i = 0; i < count; i++) {
+        sink += *(u64*)hashFind(&table, keys[i]);
+    }
+    f64 hit = benchNow() - start;
+    start = benchNow();
+    for (u32 i = 0; i < count; i++) {
+        sink += hashFind(&table, keys[i] | (1ull << 60)) != NULL;
+    }
+    f64 miss = benchNow() - start;
+    start = benchNow();
+    for (u32 i = 0; i < count; i += 2) {
+        hashRemove(&table, keys[i]);
+    }
+    f64 removal = benchNow() - start;
+    arenaPagePop(map);
+
+    snprintf(name, sizeof(name), "swiss insert %u", count);
+    BENCH_REPORT(name, insert, count);
+    snprintf(name, sizeof(name), "swiss find hit %u", count);
+    BENCH_REPORT(name, hit, count);
+    snprintf(name, sizeof(name), "swiss find miss %u", count);
+    BENCH_REPORT(name, miss, count);
+    snprintf(name, sizeof(name), "swiss remove %u", count);
+    BENCH_REPORT(name, removal, count / 2);
+
+    ChainTable chain;
+    chainInit(&chain, count);
+    start = benchNow();
+    for (u32 i = 0; i < count; i++) {
+        *chainInsert(&chain, keys[i]) = i;
+    }
+    insert = benchNow() - start;
+    start = benchNow();
+    for (u32 i = 0; i < count; i++) {
+        sink += *chainFind(&chain, keys[i]);
+    }
+    hit = benchNow() - start;
+    start = benchNow();
+    for (u32 i = 0; i < count; i++) {
+        sink += chainFind(&chain, keys[i] | (1ull << 60)) != NULL;
+    }
+    miss = benchNow() - start;
+    start = benchNow();
+    for (u32 i = 0; i < count; i += 2) {
+        chainRemove(&chain, keys[i]);
+    }
+    removal = benchNow() - start;
+    chainDestroy(&chain);
+
+    snprintf(name, sizeof(name), "chained insert %u", count);
+    BENCH_REPORT(name, insert, count);
+    snprintf(name, sizeof(name), "chained find hit %u", count);
+    BENCH_REPORT(name, hit, count);
+    snprintf(name, sizeof(name), "chained find miss %u", count);
+    BENCH_REPORT(name, miss, count);
+    snprintf(name, sizeof(name), "chained remove %u", count);
+    BENCH_REPORT(name, removal, count / 2);
+    fprintf(stdout, "checksum %llu\n", (unsigned long long)sink);
+}
+
+int main(void) {
+    memMap* map = initMemMap(MiB(128));
+    if(!map) {
+        return 1;
+    }
+    benchCount(map, 1000);
+    benchCount(map, 100000);
+    benchCount(map, MAX_KEYS);
+    releasePages(map);
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include "bench.h"
+#include "zeta.h"
+#include "arena_base.h"
+#include "page_arena.h"
+
+#define GRID_W 1024
+#define GRID_H 1024
+#define REPEAT 3
+
+typedef struct MeshTimes {
+    f64 populate;
+    f64 generate;
+    f64 firstTouch;
+} MeshTimes;
+
+static void buildMesh(PageArena* arena, MeshTimes* times) {
+    usize points = (usize)GRID_W * GRID_H;
+    usize indexCount = (usize)(GRID_W - 1) * (GRID_H - 1) * 6;
+    ZetaPoint* grid = arenaPageAlloc(arena, points * sizeof(ZetaPoint), ALIGN_16);
+    ZetaVertex* vertices = arenaPageAlloc(arena, points * sizeof(ZetaVertex), ALIGN_16);
+    u32* indices = arenaPageAlloc(arena, indexCount * sizeof(u32), ALIGN_16);
+    if(!grid || !vertices || !indices) {
+        LOG_ERROR("Mesh arena too small");
+        return;
+    }
+
+    //first pass pays the page faults, later passes see only TLB behaviour
+    f64 start = benchNow();
+    populateMesh(grid, vertices, GRID_W, GRID_H, 0.0f, 1.0f, 0.0f, 50.0f, expITheta);
+    generateMesh(indices, GRID_H, GRID_W);
+    times->firstTouch = benchNow() - start;
+
+    times->populate = 1e30;
+    times->generate = 1e30;
+    for (u32 r = 0; r < REPEAT; r++) {
+        start = benchNow();
+        populateMesh(grid, vertices, GRID_W, GRID_H, 0.0f, 1.0f, 0.0f, 50.0f, expITheta);
+        f64 elapsed = benchNow() - start;
+        times->populate = (elapsed < times->populate) ? elapsed : times->populate;
+
+        start = benchNow();
+        generateMesh(indices, GRID_H, GRID_W);
+        elapsed = benchNow() - start;
+        times->generate = (elapsed < times->generate) ? elapsed : times->generate;
+    }
+}
+
+static void report(const char* label, PageArena* arena, const MeshTimes* times) {
+    char name[64];
+    usize points = (usize)GRID_W * GRID_H;
+    fprintf(stdout, "%s arena: %s\n", label, pageBackingName(arena->backing));
+    snprintf(name, sizeof(name), "%s first touch", label);
+    BENCH_REPORT(name, times->firstTouch, points);
+    snprintf(name, sizeof(name), "%s populateMesh", label);
+    BENCH_REPORT(name, times->populate, points);
+    snprintf(name, sizeof(name), "%s generateMesh", label);
+    BENCH_REPORT(name, times->generate, points);
+}
+
+int main(void) {
+    usize meshBytes = (usize)GRID_W * GRID_H * (sizeof(ZetaPoint) + sizeof(ZetaVertex) + 6 * sizeof(u32)) + MiB(4);
+    memMap* map = initMemMapReserve(4 * meshBytes);
+    if(!map) {
+        return 1;
+    }
+
+    MeshTimes times;
+    PageArena* small = createPageArena(map, meshBytes);
+    if(small) {
+        buildMesh(small, &times);
+        report("small", small, &times);
+        arenaPagePop(map);
+    }
+
+    PageArena* huge = createPageArenaHuge(map, meshBytes);
+    if(huge) {
+        buildMesh(huge, &times);
+        report("huge", huge, &times);
+        arenaPagePop(map);
+    }
+
+    releasePages(map);
+    return 0;
+}
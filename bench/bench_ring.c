@@ -0,0 +1,192 @@
+#include <pthread.h>
+#include <sched.h>
+#include "bench.h"
+#include "arena_base.h"
+#include "page_arena.h"
+#include "ring_queue.h"
+
+#define ITEMS 1000000
+#define RING_SIZE 4096
+#define ROUND_TRIPS 2000
+#define MAX_PRODUCERS 4
+#define MAX_BATCH 32
+
+typedef struct RingJob {
+    SpscRing* spsc;
+    MpscRing* mpsc;
+    SpscRing* reply;
+    u64 count;
+    u32 batch;
+    u32 id;
+} RingJob;
+
+//spin a little before giving the core away, the consumer may be on the same one
+static void backoff(u32* spins) {
+    if(++(*spins) > 64) {
+        sched_yield();
+        *spins = 0;
+    }
+}
+
+static void* spscProducer(void* arg) {
+    RingJob* job = arg;
+    u64 items[MAX_BATCH];
+    u32 spins = 0;
+    for (u64 i = 0; i < job->count;) {
+        u32 n = (job->count - i < job->batch) ? (u32)(job->count - i) : job->batch;
+        for (u32 k = 0; k < n; k++) {
+            items[k] = i + k;
+        }
+        u32 pushed = 0;
+        while(pushed < n) {
+            u32 done = spscPush(job->spsc, items + pushed, n - pushed);
+            pushed += done;
+            if(!done) {
+                backoff(&spins);
+            }
+        }
+        i += n;
+    }
+    return NULL;
+}
+
+static void* mpscProducer(void* arg) {
+    RingJob* job = arg;
+    u64 items[MAX_BATCH];
+    u32 spins = 0;
+    for (u64 i = 0; i < job->count;) {
+        u32 n = (job->count - i < job->batch) ? (u32)(job->count - i) : job->batch;
+        for (u32 k = 0; k < n; k++) {
+            items[k] = ((u64)job->id << 40) | (i + k);
+        }
+        u32 pushed = 0;
+        while(pushed < n) {
+            u32 done = mpscPush(job->mpsc, items + pushed, n - pushed);
+            pushed += done;
+            if(!done) {
+                backoff(&spins);
+            }
+        }
+        i += n;
+    }
+    return NULL;
+}
+
+static f64 spscThroughput(PageArena* arena, u32 batch) {
+    SpscRing* ring = spscCreate(arena, RING_SIZE, sizeof(u64));
+    RingJob job = { .spsc = ring, .count = ITEMS, .batch = batch };
+    u64 items[MAX_BATCH];
+    u64 received = 0;
+    u64 sum = 0;
+    u32 spins = 0;
+    pthread_t producer;
+    f64 start = benchNow();
+    pthread_create(&producer, NULL, spscProducer, &job);
+    while(received < ITEMS) {
+        u32 n = spscPop(ring, items, batch);
+        for (u32 k = 0; k < n; k++) {
+            sum += items[k];
+        }
+        received += n;
+        if(!n) {
+            backoff(&spins);
+        }
+    }
+    pthread_join(producer, NULL);
+    f64 elapsed = benchNow() - start;
+    if(sum != (u64)ITEMS * (ITEMS - 1) / 2) {
+        fprintf(stdout, "spsc checksum mismatch\n");
+    }
+    return elapsed;
+}
+
+static f64 mpscThroughput(PageArena* arena, u32 producers, u32 batch) {
+    MpscRing* ring = mpscCreate(arena, RING_SIZE, sizeof(u64));
+    RingJob jobs[MAX_PRODUCERS];
+    pthread_t threads[MAX_PRODUCERS];
+    u64 items[MAX_BATCH];
+    u64 total = (u64)ITEMS / producers * producers;
+    u64 received = 0;
+    u32 spins = 0;
+    f64 start = benchNow();
+    for (u32 p = 0; p < producers; p++) {
+        jobs[p] = (RingJob){ .mpsc = ring, .count = ITEMS / producers, .batch = batch, .id = p };
+        pthread_create(&threads[p], NULL, mpscProducer, &jobs[p]);
+    }
+    while(received < total) {
+        u32 n = mpscPop(ring, items, MAX_BATCH);
+        received += n;
+        if(!n) {
+            backoff(&spins);
+        }
+    }
+    for (u32 p = 0; p < producers; p++) {
+        pthread_join(threads[p], NULL);
+    }
+    return benchNow() - start;
+}
+
+static void* echo(void* arg) {
+    RingJob* job = arg;
+    u64 item;
+    u32 spins = 0;
+    for (u64 i = 0; i < job->count; i++) {
+        while(!spscPop(job->spsc, &item, 1)) {
+            backoff(&spins);
+        }
+        while(!spscPush(job->reply, &item, 1)) {
+            backoff(&spins);
+        }
+    }
+    return NULL;
+}
+
+//one item there and back, half the round trip is the handoff latency
+static f64 pingPong(PageArena* arena) {
+    RingJob job = {
+        .spsc = spscCreate(arena, 16, sizeof(u64)),
+        .reply = spscCreate(arena, 16, sizeof(u64)),
+        .count = ROUND_TRIPS
+    };
+    pthread_t thread;
+    u32 spins = 0;
+    pthread_create(&thread, NULL, echo, &job);
+    f64 start = benchNow();
+    for (u64 i = 0; i < ROUND_TRIPS; i++) {
+        u64 item = i;
+        while(!spscPush(job.spsc, &item, 1)) {
+            backoff(&spins);
+        }
+        while(!spscPop(job.reply, &item, 1)) {
+            backoff(&spins);
+        }
+    }
+    f64 elapsed = benchNow() - start;
+    pthread_join(thread, NULL);
+    return elapsed;
+}
+
+int main(void) {
+    memMap* map = initMemMap(MiB(8));
+    PageArena* arena = map ? createPageArena(map, MiB(4)) : NULL;
+    if(!arena) {
+        return 1;
+    }
+    char name[64];
+    u32 batches[] = { 1, MAX_BATCH };
+    for (u32 b = 0; b < 2; b++) {
+        ArenaMark mark = arenaPageSave(arena);
+        snprintf(name, sizeof(name), "spsc throughput batch %u", batches[b]);
+        BENCH_REPORT(name, spscThroughput(arena, batches[b]), ITEMS);
+        for (u32 p = 1; p <= MAX_PRODUCERS; p *= 2) {
+            snprintf(name, sizeof(name), "mpsc %u producers batch %u", p, batches[b]);
+            BENCH_REPORT(name, mpscThroughput(arena, p, batches[b]), ITEMS);
+        }
+        arenaPageRestore(arena, mark);
+    }
+    BENCH_REPORT("spsc one-way latency", pingPong(arena) / 2, ROUND_TRIPS);
+
+    arenaPagePop(map);
+    releasePages(map);
+    return 0;
+}
@@ -0,0 +1,88 @@
+#include <pthread.h>
+#include "bench.h"
+#include "arena_base.h"
+#include "page_arena.h"
+#include "scratch_pool.h"
+
+#define MAX_THREADS 16
+#define JOBS 20000
+#define BUFFERS_PER_JOB 8
+#define SLOT_SIZE (1024 * 64)
+
+typedef struct ThreadJob {
+    ScratchArena* scratch;
+    u32 usePool;
+    u32 checksum;
+} ThreadJob;
+
+static const usize bufferSizes[BUFFERS_PER_JOB] = { 64, 256, 1024, 4096, 128, 512, 2048, 8192 };
+
+//every job grabs a handful of temporaries of mixed sizes, touches them and drops them
+static void* runJobs(void* arg) {
+    ThreadJob* job = arg;
+    u8* buffers[BUFFERS_PER_JOB];
+    u32 sum = 0;
+    for (u32 n = 0; n < JOBS; n++) {
+        if(job->usePool) {
+            resetScratchArena(job->scratch);
+        }
+        for (u32 b = 0; b < BUFFERS_PER_JOB; b++) {
+            if(job->usePool) {
+                buffers[b] = arenaScratchAlloc(job->scratch, bufferSizes[b], ALIGN_16);
+            } else {
+                buffers[b] = malloc(bufferSizes[b]);
+            }
+            buffers[b][0] = (u8)n;
+            buffers[b][bufferSizes[b] - 1] = (u8)b;
+        }
+        for (u32 b = 0; b < BUFFERS_PER_JOB; b++) {
+            sum += buffers[b][0] + buffers[b][bufferSizes[b] - 1];
+            if(!job->usePool) {
+                free(buffers[b]);
+            }
+        }
+    }
+    job->checksum = sum;
+    return NULL;
+}
+
+static f64 runThreads(ScratchPool* pool, u32 threadCount, u32 usePool) {
+    pthread_t threads[MAX_THREADS];
+    ThreadJob jobs[MAX_THREADS];
+    f64 start = benchNow();
+    for (u32 i = 0; i < threadCount; i++) {
+        jobs[i].scratch = scratchPoolGet(pool, i);
+        jobs[i].usePool = usePool;
+        pthread_create(&threads[i], NULL, runJobs, &jobs[i]);
+    }
+    for (u32 i = 0; i < threadCount; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    return benchNow() - start;
+}
+
+int main(void) {
+    memMap* map = initMemMap(MAX_THREADS * (SLOT_SIZE + SCRATCH_CACHE_LINE) + MiB(1));
+    if(!map) {
+        return 1;
+    }
+    PageArena* arena = createPageArena(map, MAX_THREADS * (SLOT_SIZE + SCRATCH_CACHE_LINE) + 4096);
+    ScratchPool pool;
+    if(!arena || scratchPoolInit(&pool, arena, MAX_THREADS, SLOT_SIZE) != 0) {
+        releasePages(map);
+        return 1;
+    }
+
+    char name[64];
+    for (u32 threadCount = 1; threadCount <= MAX_THREADS; threadCount *= 2) {
+        u64 items = (u64)threadCount * JOBS * BUFFERS_PER_JOB;
+        snprintf(name, sizeof(name), "malloc/free, %u threads", threadCount);
+        BENCH_REPORT(name, runThreads(&pool, threadCount, 0), items);
+        snprintf(name, sizeof(name), "scratch pool, %u threads", threadCount);
+        BENCH_REPORT(name, runThreads(&pool, threadCount, 1), items);
+    }
+
+    arenaPagePop(map);
+    releasePages(map);
+    return 0;
+}
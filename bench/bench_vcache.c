@@ -0,0 +1,113 @@
+#include "bench.h"
+#include "arena_base.h"
+#include "page_arena.h"
+#include "zeta.h"
+#include "lod.h"
+#include "vcache.h"
+
+#define ARENA_BYTES MiB(192)
+#define MAX_GRID 1025
+
+//the default 100x100 grid trimmed to whole chunks, and what a few budgets plan
+static const u32 gridSizes[] = { 97, 257, 513, MAX_GRID };
+//llvmpipe and older desktop parts sit near the small end, recent hardware near the large one
+static const u32 cacheSizes[] = { 16, 32 };
+
+static void report(const char* name, const u32* indices, u32 count, u32 vertexCount, PageArena* arena) {
+    fprintf(stdout, "  %-28s", name);
+    for (u32 c = 0; c < sizeof(cacheSizes) / sizeof(cacheSizes[0]); c++) {
+        VcacheStats stats;
+        vcacheMeasure(&stats, indices, count, vertexCount, cacheSizes[c], arena);
+        fprintf(stdout, "  fifo %2u acmr %.3f atvr %.3f fetch %.3f", cacheSizes[c], stats.acmr, stats.atvr, stats.fetch);
+    }
+    fprintf(stdout, "\n");
+}
+
+//odd triangles after a restart are wound (b, a, c) like GL draws them
+static u32 stripToList(u32* out, const u16* strip, u32 count) {
+    u32 n = 0;
+    u32 first = 0;
+    for (u32 i = 0; i < count; i++) {
+        if(strip[i] == LOD_RESTART) {
+            first = i + 1;
+            continue;
+        }
+        if(i < first + 2) {
+            continue;
+        }
+        u16 a = strip[i - 2], b = strip[i - 1], c = strip[i];
+        if(a != b && b != c && a != c) {
+            u32 odd = (i - first) & 1;
+            out[n++] = odd ? b : a;
+            out[n++] = odd ? a : b;
+            out[n++] = c;
+        }
+    }
+    return n;
+}
+
+int main(void) {
+    memMap* map = initMemMap(ARENA_BYTES + MiB(4));
+    if(!map) {
+        return 1;
+    }
+    PageArena* arena = createPageArena(map, ARENA_BYTES);
+    u32* indices = arena ? arenaPageAlloc(arena, (usize)(MAX_GRID - 1) * (MAX_GRID - 1) * 6 * sizeof(u32), ALIGN_16) : NULL;
+    u32* order = arena ? arenaPageAlloc(arena, (usize)MAX_GRID * MAX_GRID * sizeof(u32), ALIGN_16) : NULL;
+    if(!indices || !order) {
+        releasePages(map);
+        return 1;
+    }
+
+    char name[64];
+    fprintf(stdout, "INFO: post-transform cache, full row-major mesh\n");
+    for (u32 g = 0; g < sizeof(gridSizes) / sizeof(gridSizes[0]); g++) {
+        u32 n = gridSizes[g];
+        u32 count = (n - 1) * (n - 1) * 6;
+        generateMesh(indices, n, n);
+        snprintf(name, sizeof(name), "%ux%u row-major", n, n);
+        report(name, indices, count, n * n, arena);
+        f64 start = benchNow();
+        vcacheOptimize(indices, count, n * n, arena);
+        f64 optimize = benchNow() - start;
+        snprintf(name, sizeof(name), "%ux%u forsyth", n, n);
+        report(name, indices, count, n * n, arena);
+        start = benchNow();
+        vcacheVertexOrder(indices, count, n * n, order, arena);
+        f64 reorder = benchNow() - start;
+        snprintf(name, sizeof(name), "%ux%u forsyth + vertices", n, n);
+        report(name, indices, count, n * n, arena);
+        snprintf(name, sizeof(name), "forsyth %ux%u", n, n);
+        BENCH_REPORT(name, optimize, count / 3);
+        snprintf(name, sizeof(name), "vertex order %ux%u", n, n);
+        BENCH_REPORT(name, reorder, n * n);
+    }
+
+    //one chunk's templates are all the LOD path ever draws
+    ZetaLod lod;
+    ArenaMark mark = arenaPageSave(arena);
+    if(lodInit(&lod, arena, LOD_CHUNK + 1, LOD_CHUNK + 1) == 0) {
+        fprintf(stdout, "INFO: post-transform cache, LOD templates without stitching\n");
+        for (u32 l = 0; l < LOD_LEVELS; l++) {
+            const LodRange* range = &lod.ranges[l][0];
+            u32 count = stripToList(indices, &lod.indices[range->offset], range->count);
+            snprintf(name, sizeof(name), "level %u strips (%u indices)", l, range->count);
+            report(name, indices, count, LOD_CHUNK_VERTICES, arena);
+        }
+        if(lodCacheOptimize(&lod, arena) == 0) {
+            for (u32 l = 0; l < LOD_LEVELS; l++) {
+                const LodRange* range = &lod.ranges[l][0];
+                for (u32 i = 0; i < range->count; i++) {
+                    indices[i] = lod.indices[range->offset + i];
+                }
+                snprintf(name, sizeof(name), "level %u cache (%u indices)", l, range->count);
+                report(name, indices, range->count, LOD_CHUNK_VERTICES, arena);
+            }
+        }
+    }
+    arenaPageRestore(arena, mark);
+
+    arenaPagePop(map);
+    releasePages(map);
+    return 0;
+}
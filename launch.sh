@@ -4,7 +4,7 @@ echo "##########################################################"
 echo "#             Compiling OPENGL Testing....               #"
 echo "##########################################################"
 
-DEBUG_FLAGS="-fsanitize=address -g -O0 -Wall -Werror"
+DEBUG_FLAGS="-fsanitize=address -g -O0 -Wall -Werror -DARENA_INSTRUMENT"
 LIGHT_DBG_FLAGS="-g -Wall -Werror"
 CFLAGS=$LIGHT_DBG_FLAGS
 TEST_ONLY=false
@@ -57,16 +57,16 @@ SRC_DIR="src"
 INCLUDE_DIR="include"
 BIN_DIR="bin"
 TARGET="$BIN_DIR/mainModel"
-INCLUDE_FLAGS="-I/opt/homebrew/include -L/opt/homebrew/lib -Iinclude -Isrc/memory -lglfw -framework Cocoa -framework OpenGL -framework IOKit -DGL_SILENCE_DEPRECATION"
+INCLUDE_FLAGS="-I/opt/homebrew/include -L/opt/homebrew/lib -Iinclude -Isrc/memory -lglfw -lpthread -ldl -framework Cocoa -framework OpenGL -framework IOKit -DGL_SILENCE_DEPRECATION"
 SRC_MAIN="$SRC_DIR/main.c"
-SRC_SECONDARY="src/zeta.c src/memory/page_arena.c src/memory/scratch_arena.c"
+SRC_SECONDARY="src/zeta.c src/dirichlet.c src/parallel.c src/expr.c src/plugin.c src/sampling.c src/pyramid.c src/contour.c src/colormap.c src/lod.c src/vcache.c src/plan.c src/memory/page_arena.c src/memory/scratch_arena.c src/memory/scratch_pool.c src/memory/fixed_pool.c src/memory/arena_stats.c src/memory/hash_table.c"
 
-clang -std=c99 $LIGHT_DBG_FLAGS -o $TARGET $SRC_MAIN $SRC_SECONDARY $INCLUDE_FLAGS
+clang -std=c99 $CFLAGS -o $TARGET $SRC_MAIN $SRC_SECONDARY $INCLUDE_FLAGS || { echo "[ ] Compilation Failed."; exit 1; }
 
-if [ $? -ne 0 ]; then
-    echo "[ ] Compilation Failed."
-    exit 1
-fi
+for plugin in plugins/*.c
+do
+    clang -std=c99 $LIGHT_DBG_FLAGS -shared -fPIC -Isrc -o "${plugin%.c}.so" $plugin || { echo "[ ] Plugin $plugin Compilation Failed."; exit 1; }
+done
 
 echo "[X] Main Compilation Complete"
 echo 
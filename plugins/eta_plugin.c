@@ -0,0 +1,35 @@
+#include <math.h>
+#include "plugin_api.h"
+
+//Dirichlet eta, sum (-1)^(n-1) n^-s, as a sample f64 kernel
+#define ETA_TERMS 200
+
+static void etaEvaluate(void* state, const double* sre, const double* sim, uint32_t count,
+        double* re_out, double* im_out) {
+    for (uint32_t l = 0; l < count; l++) {
+        double re = 0.0;
+        double im = 0.0;
+        for (uint32_t n = 1; n <= ETA_TERMS; n++) {
+            double logn = log((double)n);
+            double amp = exp(-sre[l] * logn) * ((n & 1) ? 1.0 : -1.0);
+            re += amp * cos(sim[l] * logn);
+            im -= amp * sin(sim[l] * logn);
+        }
+        re_out[l] = re;
+        im_out[l] = im;
+    }
+}
+
+static const ZetaPluginInfo etaInfo = {
+    .abiVersion = ZETA_PLUGIN_ABI_VERSION,
+    .flags = ZETA_PLUGIN_F64 | ZETA_PLUGIN_THREAD_SAFE,
+    .batchWidth = 64,
+    .name = "eta",
+    .evaluateF32 = 0,
+    .evaluateF64 = etaEvaluate,
+    .state = 0
+};
+
+const ZetaPluginInfo* zetaPluginDescribe(void) {
+    return &etaInfo;
+}
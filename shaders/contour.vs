@@ -0,0 +1,15 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+
+//per-frame state shared by every program, see FrameUniforms in render_state.h
+layout (std140) uniform Frame {
+    mat4 projection;
+    mat4 view;
+    mat4 model;
+    //x wire line width in pixels, y palette layer, z 1 for the wire overlay
+    vec4 params;
+};
+
+void main() {
+    gl_Position = projection * view * model * vec4(aPos, 1.0);
+}
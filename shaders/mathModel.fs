@@ -5,25 +5,21 @@ in float FragArg;
 
 out vec4 FragColor;
 
-vec3 hsv2rgb(float h, float s, float v) {
-    float c = v * s;
-    float h_prime = mod(h / (3.1415926 / 3.0), 6.0);
-    float x = c * (1.0 - abs(mod(h_prime, 2.0) - 1.0));
-    vec3 rgb;
-    if (0.0 <= h_prime && h_prime < 1.0) rgb = vec3(c, x, 0);
-    else if (1.0 <= h_prime && h_prime < 2.0) rgb = vec3(x, c, 0);
-    else if (2.0 <= h_prime && h_prime < 3.0) rgb = vec3(0, c, x);
-    else if (3.0 <= h_prime && h_prime < 4.0) rgb = vec3(0, x, c);
-    else if (4.0 <= h_prime && h_prime < 5.0) rgb = vec3(x, 0, c);
-    else rgb = vec3(c, 0, x);
-    return rgb + vec3(v - c);
-}
+//palettes baked by colormap.c, one layer each, u is arg over a turn and v is log2 of the length
+uniform sampler2DArray colormap;
+//v = (log2(length) - colormapRange.x) * colormapRange.y
+uniform vec2 colormapRange;
 
-void main() { 
-    float brightness = length(FragPos);
-    float hue = FragArg;
-    float sat = 1.0;
+//per-frame state shared by every program, see FrameUniforms in render_state.h
+layout (std140) uniform Frame {
+    mat4 projection;
+    mat4 view;
+    mat4 model;
+    //x wire line width in pixels, y palette layer, z 1 for the wire overlay
+    vec4 params;
+};
 
-    vec3 color = hsv2rgb(hue, sat, brightness * 0.25);
-    FragColor = vec4(color, 1.0);
+void main() { 
+    vec2 uv = vec2(FragArg * (0.5 / 3.14159265) + 0.5, (log2(max(length(FragPos), 1e-20)) - colormapRange.x) * colormapRange.y);
+    FragColor = vec4(texture(colormap, vec3(uv, params.y)).rgb, 1.0);
 }
@@ -5,13 +5,24 @@ layout (location = 1) in float aArg;
 out vec3 FragPos;
 out float FragArg;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+//per-frame state shared by every program, see FrameUniforms in render_state.h
+layout (std140) uniform Frame {
+    mat4 projection;
+    mat4 view;
+    mat4 model;
+    //x wire line width in pixels, y palette layer, z 1 for the wire overlay
+    vec4 params;
+};
+//unorm16 vertices arrive in [0, 1] and are scaled back per chunk, float vertices use origin 0 and extent 1
+uniform vec3 posOrigin;
+uniform vec3 posExtent;
+//arg = argRange.x + aArg * argRange.y
+uniform vec2 argRange;
 
 void main() {
-    FragPos = aPos;
-    FragArg = aArg;
+    //FragPos stays in mesh space, the palette reads the sample value from it
+    FragPos = posOrigin + aPos * posExtent;
+    FragArg = argRange.x + aArg * argRange.y;
     
-    gl_Position = projection * view * vec4(FragPos, 1.0);
+    gl_Position = projection * view * model * vec4(FragPos, 1.0);
 }
@@ -0,0 +1,34 @@
+#version 330 core
+
+in vec3 WirePos;
+in float WireArg;
+noperspective in vec3 WireBary;
+
+out vec4 FragColor;
+
+//same lookup as mathModel.fs
+uniform sampler2DArray colormap;
+uniform vec2 colormapRange;
+
+//per-frame state shared by every program, see FrameUniforms in render_state.h
+layout (std140) uniform Frame {
+    mat4 projection;
+    mat4 view;
+    mat4 model;
+    //x line width in pixels, y palette layer, z 0 draws only the edges and 1 draws them dark over the filled surface
+    vec4 params;
+};
+
+void main() {
+    //1 on an edge fading to 0 params.x pixels away from it
+    vec3 pixels = WireBary / max(fwidth(WireBary), vec3(1e-6));
+    float edge = 1.0 - smoothstep(0.0, params.x, min(min(pixels.x, pixels.y), pixels.z));
+    vec2 uv = vec2(WireArg * (0.5 / 3.14159265) + 0.5, (log2(max(length(WirePos), 1e-20)) - colormapRange.x) * colormapRange.y);
+    vec3 color = texture(colormap, vec3(uv, params.y)).rgb;
+    if (params.z < 0.5) {
+        if (edge < 0.5) discard;
+        FragColor = vec4(color, 1.0);
+    } else {
+        FragColor = vec4(mix(color, vec3(0.0), edge), 1.0);
+    }
+}
@@ -0,0 +1,23 @@
+#version 330 core
+layout (triangles) in;
+layout (triangle_strip, max_vertices = 3) out;
+
+in vec3 FragPos[];
+in float FragArg[];
+
+out vec3 WirePos;
+out float WireArg;
+//screen-space barycentrics, the fragment shader measures edge distance in pixels with fwidth
+noperspective out vec3 WireBary;
+
+void main() {
+    for (int i = 0; i < 3; i++) {
+        WirePos = FragPos[i];
+        WireArg = FragArg[i];
+        WireBary = vec3(0.0);
+        WireBary[i] = 1.0;
+        gl_Position = gl_in[i].gl_Position;
+        EmitVertex();
+    }
+    EndPrimitive();
+}
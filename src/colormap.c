@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+#include "colormap.h"
+
+//oklch lightness climbs this span with log2 of the length, chroma narrows towards black and white to stay mostly inside sRGB
+#define CYCLIC_LIGHTNESS_MIN 0.18f
+#define CYCLIC_LIGHTNESS_MAX 0.92f
+#define CYCLIC_CHROMA 0.42f
+//each doubling of |f| ramps the band brightness from BANDS_FLOOR back up to 1
+#define BANDS_FLOOR 0.55f
+
+static const char* paletteNames[COLORMAP_PALETTES] = { "hsv", "cyclic", "bands" };
+
+const char* colormapName(u32 palette) {
+    return (palette < COLORMAP_PALETTES) ? paletteNames[palette] : "unknown";
+}
+
+u32 colormapFind(const char* name) {
+    for (u32 p = 0; p < COLORMAP_PALETTES; p++) {
+        if(strcmp(name, paletteNames[p]) == 0) {
+            return p;
+        }
+    }
+    return COLORMAP_PALETTES;
+}
+
+f32 colormapArg(u32 x) {
+    return -COLORMAP_PI + 2.0f * COLORMAP_PI * ((f32)x + 0.5f) / COLORMAP_WIDTH;
+}
+
+static f32 rowLog2(u32 y) {
+    return COLORMAP_LOG2_MIN + (COLORMAP_LOG2_MAX - COLORMAP_LOG2_MIN) * ((f32)y + 0.5f) / COLORMAP_HEIGHT;
+}
+
+f32 colormapLength(u32 y) {
+    return exp2f(rowLog2(y));
+}
+
+static f32 clamp01(f32 x) {
+    return (x < 0.0f) ? 0.0f : (x > 1.0f) ? 1.0f : x;
+}
+
+//the fragment shader's old hsv2rgb, v above 1 is left for the store to clamp like the framebuffer did
+static void hsv(f32* rgb, f32 h, f32 s, f32 v) {
+    f32 c = v * s;
+    f32 sector = h / (COLORMAP_PI / 3.0f);
+    sector -= 6.0f * floorf(sector / 6.0f);
+    f32 x = c * (1.0f - fabsf(fmodf(sector, 2.0f) - 1.0f));
+    f32 r = 0.0f, g = 0.0f, b = 0.0f;
+    switch((u32)sector) {
+        case 0: r = c; g = x; break;
+        case 1: r = x; g = c; break;
+        case 2: g = c; b = x; break;
+        case 3: g = x; b = c; break;
+        case 4: r = x; b = c; break;
+        default: r = c; b = x; break;
+    }
+    rgb[0] = r + v - c;
+    rgb[1] = g + v - c;
+    rgb[2] = b + v - c;
+}
+
+static f32 srgbEncode(f32 linear) {
+    linear = clamp01(linear);
+    return (linear <= 0.0031308f) ? 12.92f * linear : 1.055f * powf(linear, 1.0f / 2.4f) - 0.055f;
+}
+
+//Ottosson's oklab to linear sRGB, a hue wheel at fixed L and C reads as evenly bright all the way round
+static void oklch(f32* rgb, f32 lightness, f32 chroma, f32 hue) {
+    f32 a = chroma * cosf(hue);
+    f32 b = chroma * sinf(hue);
+    f32 l = lightness + 0.3963377774f * a + 0.2158037573f * b;
+    f32 m = lightness - 0.1055613458f * a - 0.0638541728f * b;
+    f32 s = lightness - 0.0894841775f * a - 1.2914855480f * b;
+    l = l * l * l;
+    m = m * m * m;
+    s = s * s * s;
+    rgb[0] = srgbEncode(4.0767416621f * l - 3.3077115913f * m + 0.2309699292f * s);
+    rgb[1] = srgbEncode(-1.2684380046f * l + 2.6097574011f * m - 0.3413193965f * s);
+    rgb[2] = srgbEncode(-0.0041960863f * l - 0.7034186147f * m + 1.7076147010f * s);
+}
+
+i32 colormapBake(u8* rgba, u32 palette) {
+    if(palette >= COLORMAP_PALETTES) {
+        LOG_ERROR("No palette %u", palette);
+        return -1;
+    }
+    for (u32 y = 0; y < COLORMAP_HEIGHT; y++) {
+        f32 length = colormapLength(y);
+        f32 t = ((f32)y + 0.5f) / COLORMAP_HEIGHT;
+        //the shaded length is |(re, im, |f|)| = sqrt(2) |f|
+        f32 octave = rowLog2(y) - 0.5f;
+        f32 lightness = CYCLIC_LIGHTNESS_MIN + (CYCLIC_LIGHTNESS_MAX - CYCLIC_LIGHTNESS_MIN) * t;
+        f32 chroma = CYCLIC_CHROMA * lightness * (1.0f - lightness);
+        f32 band = BANDS_FLOOR + (1.0f - BANDS_FLOOR) * (octave - floorf(octave));
+        u8* row = &rgba[(usize)y * COLORMAP_WIDTH * 4];
+        for (u32 x = 0; x < COLORMAP_WIDTH; x++) {
+            f32 arg = colormapArg(x);
+            f32 rgb[3];
+            switch(palette) {
+                case COLORMAP_HSV: hsv(rgb, arg, 1.0f, length * 0.25f); break;
+                case COLORMAP_CYCLIC: oklch(rgb, lightness, chroma, arg); break;
+                default: hsv(rgb, arg, 1.0f, band); break;
+            }
+            for (u32 k = 0; k < 3; k++) {
+                row[x * 4 + k] = (u8)(clamp01(rgb[k]) * 255.0f + 0.5f);
+            }
+            row[x * 4 + 3] = 255;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,33 @@
+#ifndef zeta_COLORMAP_H
+#define zeta_COLORMAP_H
+
+#include "common_types.h"
+
+//every palette is a COLORMAP_WIDTH x COLORMAP_HEIGHT rgba8 table, u is arg over one turn starting at -pi,
+//v is log2 of the shaded length from COLORMAP_LOG2_MIN to COLORMAP_LOG2_MAX, one layer of a texture array each
+#define COLORMAP_WIDTH 256
+#define COLORMAP_HEIGHT 64
+#define COLORMAP_LOG2_MIN -6.0f
+#define COLORMAP_LOG2_MAX 4.0f
+#define COLORMAP_LAYER_BYTES ((usize)COLORMAP_WIDTH * COLORMAP_HEIGHT * 4)
+#define COLORMAP_BYTES (COLORMAP_LAYER_BYTES * COLORMAP_PALETTES)
+#define COLORMAP_PI 3.14159265f
+
+//P cycles through these at runtime, ZETA_PALETTE=name picks the startup one
+typedef enum ColormapPalette {
+    COLORMAP_HSV,
+    COLORMAP_CYCLIC,
+    COLORMAP_BANDS,
+    COLORMAP_PALETTES
+} ColormapPalette;
+
+const char* colormapName(u32 palette);
+//COLORMAP_PALETTES when nothing matches
+u32 colormapFind(const char* name);
+//the arg and length a texel centre stands for, the shader maps them back the same way
+f32 colormapArg(u32 x);
+f32 colormapLength(u32 y);
+//fills one layer, rows of COLORMAP_WIDTH texels from the smallest length up
+i32 colormapBake(u8* rgba, u32 palette);
+
+#endif
@@ -0,0 +1,390 @@
+#include <stdlib.h>
+#include "arena_base.h"
+#include "contour.h"
+#include "parallel.h"
+
+//cell corners v0 (i, j), v1 (i, j + 1), v2 (i + 1, j + 1), v3 (i + 1, j), bit k set when vk > 0
+//edges e0 = v0v1, e1 = v1v2, e2 = v3v2, e3 = v0v3, pairs of edges per case, saddles 5 and 10 handled apart
+static const i8 caseSegments[16][4] = {
+    { -1, -1, -1, -1 }, { 3, 0, -1, -1 }, { 0, 1, -1, -1 }, { 3, 1, -1, -1 },
+    { 1, 2, -1, -1 },   { -1, -1, -1, -1 }, { 0, 2, -1, -1 }, { 3, 2, -1, -1 },
+    { 2, 3, -1, -1 },   { 0, 2, -1, -1 }, { -1, -1, -1, -1 }, { 1, 2, -1, -1 },
+    { 3, 1, -1, -1 },   { 0, 1, -1, -1 }, { 3, 0, -1, -1 },  { -1, -1, -1, -1 }
+};
+
+typedef struct ContourJob {
+    ContourField* field;
+    const ZetaPoint* grid;
+    const ZetaVertex* vertexGrid;
+} ContourJob;
+
+static inline f32 fieldValue(const ZetaPoint* zp, u32 component) {
+    return component ? zp->im : zp->re;
+}
+
+static inline u32 isPositive(const ZetaPoint* zp, u32 component) {
+    return fieldValue(zp, component) > 0.0f;
+}
+
+static u32 cellSegments(u32 code, f32 center, i8* edges) {
+    if(code == 5 || code == 10) {
+        //the sign at the cell centre decides which diagonal pair of corners is joined
+        u32 joinsV0V2 = (code == 5) == (center > 0.0f);
+        if(joinsV0V2) {
+            edges[0] = 0; edges[1] = 1; edges[2] = 2; edges[3] = 3;
+        } else {
+            edges[0] = 3; edges[1] = 0; edges[2] = 1; edges[3] = 2;
+        }
+        return 2;
+    }
+    if(caseSegments[code][0] < 0) {
+        return 0;
+    }
+    edges[0] = caseSegments[code][0];
+    edges[1] = caseSegments[code][1];
+    return 1;
+}
+
+static void countRows(void* ctx, u32 begin, u32 end) {
+    ContourJob* job = ctx;
+    ContourField* field = job->field;
+    u32 w = field->w;
+    for (u32 r = begin; r < end; r++) {
+        const ZetaPoint* row = &job->grid[(usize)r * w];
+        const ZetaPoint* next = row + w;
+        for (u32 component = 0; component < 2; component++) {
+            u32 count = 0;
+            for (u32 j = 0; j + 1 < w; j++) {
+                count += isPositive(&row[j], component) ^ isPositive(&row[j + 1], component);
+            }
+            if(r + 1 < field->h) {
+                for (u32 j = 0; j < w; j++) {
+                    count += isPositive(&row[j], component) ^ isPositive(&next[j], component);
+                }
+            }
+            field->rowCount[component * field->h + r] = count;
+        }
+    }
+}
+
+static void emitVertex(ContourLines* lines, u32 id, const ZetaVertex* a, const ZetaVertex* b, f32 fa, f32 fb) {
+    if(id >= lines->vertexCapacity) {
+        return;
+    }
+    f32 alpha = fa / (fa - fb);
+    ZetaVertex* out = &lines->vertices[id];
+    out->re = a->re + alpha * (b->re - a->re);
+    out->im = a->im + alpha * (b->im - a->im);
+    out->mag = a->mag + alpha * (b->mag - a->mag);
+    out->arg = a->arg + alpha * (b->arg - a->arg);
+    lines->neighbours[id * 2] = CONTOUR_NONE;
+    lines->neighbours[id * 2 + 1] = CONTOUR_NONE;
+    lines->visited[id] = 0;
+}
+
+static void writeVertices(void* ctx, u32 begin, u32 end) {
+    ContourJob* job = ctx;
+    ContourField* field = job->field;
+    u32 w = field->w;
+    for (u32 r = begin; r < end; r++) {
+        const ZetaPoint* row = &job->grid[(usize)r * w];
+        const ZetaVertex* vrow = &job->vertexGrid[(usize)r * w];
+        for (u32 component = 0; component < 2; component++) {
+            ContourLines* lines = component ? &field->imLines : &field->reLines;
+            u32* edgeH = field->edgeH + component * (usize)field->h * (w - 1);
+            u32* edgeV = field->edgeV + component * (usize)(field->h - 1) * w;
+            u32 id = field->rowCount[component * field->h + r];
+            for (u32 j = 0; j + 1 < w; j++) {
+                u32 slot = CONTOUR_NONE;
+                if(isPositive(&row[j], component) ^ isPositive(&row[j + 1], component)) {
+                    emitVertex(lines, id, &vrow[j], &vrow[j + 1], fieldValue(&row[j], component), 
+                            fieldValue(&row[j + 1], component));
+                    slot = (id < lines->vertexCapacity) ? id : CONTOUR_NONE;
+                    id++;
+                }
+                edgeH[(usize)r * (w - 1) + j] = slot;
+            }
+            if(r + 1 >= field->h) {
+                continue;
+            }
+            for (u32 j = 0; j < w; j++) {
+                u32 slot = CONTOUR_NONE;
+                if(isPositive(&row[j], component) ^ isPositive(&row[j + w], component)) {
+                    emitVertex(lines, id, &vrow[j], &vrow[j + w], fieldValue(&row[j], component), 
+                            fieldValue(&row[j + w], component));
+                    slot = (id < lines->vertexCapacity) ? id : CONTOUR_NONE;
+                    id++;
+                }
+                edgeV[(usize)r * w + j] = slot;
+            }
+        }
+    }
+}
+
+static void linkCells(void* ctx, u32 begin, u32 end) {
+    ContourJob* job = ctx;
+    ContourField* field = job->field;
+    u32 w = field->w;
+    for (u32 i = begin; i < end; i++) {
+        const ZetaPoint* row = &job->grid[(usize)i * w];
+        for (u32 component = 0; component < 2; component++) {
+            ContourLines* lines = component ? &field->imLines : &field->reLines;
+            const u32* edgeH = field->edgeH + component * (usize)field->h * (w - 1);
+            const u32* edgeV = field->edgeV + component * (usize)(field->h - 1) * w;
+            u8* codes = &lines->codes[(usize)i * (w - 1)];
+            for (u32 j = 0; j + 1 < w; j++) {
+                codes[j] = (u8)(isPositive(&row[j], component) | isPositive(&row[j + 1], component) << 1 |
+                        isPositive(&row[j + w + 1], component) << 2 | isPositive(&row[j + w], component) << 3);
+            }
+            for (u32 j = 0; j + 1 < w; j++) {
+                if(codes[j] == 0 || codes[j] == 15) {
+                    continue;
+                }
+                f32 center = fieldValue(&row[j], component) + fieldValue(&row[j + 1], component) +
+                        fieldValue(&row[j + w], component) + fieldValue(&row[j + w + 1], component);
+                i8 edges[4];
+                u32 segments = cellSegments(codes[j], center, edges);
+                //a cell owns one neighbour slot on each of its edges, so rows never collide
+                u32 vertexOf[4] = {
+                    edgeH[(usize)i * (w - 1) + j], edgeV[(usize)i * w + j + 1],
+                    edgeH[(usize)(i + 1) * (w - 1) + j], edgeV[(usize)i * w + j]
+                };
+                static const u32 slotOf[4] = { 1, 0, 0, 1 };
+                for (u32 s = 0; s < segments; s++) {
+                    u32 a = vertexOf[(u32)edges[s * 2]];
+                    u32 b = vertexOf[(u32)edges[s * 2 + 1]];
+                    if(a == CONTOUR_NONE || b == CONTOUR_NONE) {
+                        continue;
+                    }
+                    lines->neighbours[a * 2 + slotOf[(u32)edges[s * 2]]] = b;
+                    lines->neighbours[b * 2 + slotOf[(u32)edges[s * 2 + 1]]] = a;
+                }
+            }
+        }
+    }
+}
+
+static void edgePoint(const ZetaPoint* row, u32 w, u32 j, u32 component, i8 edge, f32* x, f32* y) {
+    const ZetaPoint* v0 = &row[j];
+    const ZetaPoint* v1 = &row[j + 1];
+    const ZetaPoint* v2 = &row[j + w + 1];
+    const ZetaPoint* v3 = &row[j + w];
+    const ZetaPoint* a = (edge == 2) ? v3 : (edge == 1) ? v1 : v0;
+    const ZetaPoint* b = (edge == 0) ? v1 : (edge == 3) ? v3 : v2;
+    f32 fa = fieldValue(a, component);
+    f32 alpha = fa / (fa - fieldValue(b, component));
+    switch(edge) {
+        case 0: *x = alpha; *y = 0.0f; break;
+        case 1: *x = 1.0f; *y = alpha; break;
+        case 2: *x = alpha; *y = 1.0f; break;
+        default: *x = 0.0f; *y = alpha; break;
+    }
+}
+
+static void findZeros(void* ctx, u32 begin, u32 end) {
+    ContourJob* job = ctx;
+    ContourField* field = job->field;
+    u32 w = field->w;
+    for (u32 i = begin; i < end; i++) {
+        const ZetaPoint* row = &job->grid[(usize)i * w];
+        const u8* reCodes = &field->reLines.codes[(usize)i * (w - 1)];
+        const u8* imCodes = &field->imLines.codes[(usize)i * (w - 1)];
+        for (u32 j = 0; j + 1 < w; j++) {
+            if(reCodes[j] == 0 || reCodes[j] == 15 || imCodes[j] == 0 || imCodes[j] == 15) {
+                continue;
+            }
+            i8 reEdges[4], imEdges[4];
+            f32 reCenter = row[j].re + row[j + 1].re + row[j + w].re + row[j + w + 1].re;
+            f32 imCenter = row[j].im + row[j + 1].im + row[j + w].im + row[j + w + 1].im;
+            u32 reCount = cellSegments(reCodes[j], reCenter, reEdges);
+            u32 imCount = cellSegments(imCodes[j], imCenter, imEdges);
+            for (u32 a = 0; a < reCount; a++) {
+                f32 px, py, qx, qy;
+                edgePoint(row, w, j, 0, reEdges[a * 2], &px, &py);
+                edgePoint(row, w, j, 0, reEdges[a * 2 + 1], &qx, &qy);
+                for (u32 b = 0; b < imCount; b++) {
+                    f32 rx, ry, sx, sy;
+                    edgePoint(row, w, j, 1, imEdges[b * 2], &rx, &ry);
+                    edgePoint(row, w, j, 1, imEdges[b * 2 + 1], &sx, &sy);
+                    f32 dx = qx - px, dy = qy - py, ex = sx - rx, ey = sy - ry;
+                    f32 denom = dx * ey - dy * ex;
+                    if(denom == 0.0f) {
+                        continue;
+                    }
+                    f32 u = ((rx - px) * ey - (ry - py) * ex) / denom;
+                    f32 v = ((rx - px) * dy - (ry - py) * dx) / denom;
+                    if(u < 0.0f || u > 1.0f || v < 0.0f || v > 1.0f) {
+                        continue;
+                    }
+                    f32 x = px + u * dx;
+                    f32 y = py + u * dy;
+                    u32 slot = __atomic_fetch_add(&field->zeroCount, 1, __ATOMIC_RELAXED);
+                    if(slot >= field->zeroCapacity) {
+                        continue;
+                    }
+                    //bilinear in the cell corners so warped lattices map back correctly
+                    f32 s0 = row[j].sigma + x * (row[j + 1].sigma - row[j].sigma);
+                    f32 s1 = row[j + w].sigma + x * (row[j + w + 1].sigma - row[j + w].sigma);
+                    f32 t0 = row[j].t + x * (row[j + 1].t - row[j].t);
+                    f32 t1 = row[j + w].t + x * (row[j + w + 1].t - row[j + w].t);
+                    ContourZero* zero = &field->zeros[slot];
+                    zero->sigma = s0 + y * (s1 - s0);
+                    zero->t = t0 + y * (t1 - t0);
+                    zero->gx = (f32)j + x;
+                    zero->gy = (f32)i + y;
+                }
+            }
+        }
+    }
+}
+
+static int byHeight(const void* a, const void* b) {
+    const ContourZero* p = a;
+    const ContourZero* q = b;
+    if(p->t != q->t) {
+        return (p->t > q->t) - (p->t < q->t);
+    }
+    return (p->sigma > q->sigma) - (p->sigma < q->sigma);
+}
+
+static void pushIndex(ContourLines* lines, u32 index) {
+    if(lines->indexCount < lines->indexCapacity) {
+        lines->indices[lines->indexCount++] = index;
+    } else {
+        lines->overflow = 1;
+    }
+}
+
+static void walkStrip(ContourLines* lines, u32 start) {
+    if(lines->stripCount > 0) {
+        pushIndex(lines, CONTOUR_RESTART);
+    }
+    lines->stripCount++;
+    u32 prev = CONTOUR_NONE;
+    u32 cur = start;
+    for (;;) {
+        pushIndex(lines, cur);
+        lines->visited[cur] = 1;
+        u32 a = lines->neighbours[cur * 2];
+        u32 b = lines->neighbours[cur * 2 + 1];
+        u32 next = (a != CONTOUR_NONE && a != prev && !lines->visited[a]) ? a :
+                (b != CONTOUR_NONE && b != prev && !lines->visited[b]) ? b : CONTOUR_NONE;
+        if(next == CONTOUR_NONE) {
+            //close loops back onto their first vertex
+            if(cur != start && (a == start || b == start) && prev != start) {
+                pushIndex(lines, start);
+            }
+            return;
+        }
+        prev = cur;
+        cur = next;
+    }
+}
+
+static void buildStrips(void* ctx, u32 begin, u32 end) {
+    ContourJob* job = ctx;
+    for (u32 component = begin; component < end; component++) {
+        ContourLines* lines = component ? &job->field->imLines : &job->field->reLines;
+        u32 count = (lines->vertexCount < lines->vertexCapacity) ? lines->vertexCount : lines->vertexCapacity;
+        lines->indexCount = 0;
+        lines->stripCount = 0;
+        //open curves start at their loose ends, what is left over is closed loops
+        for (u32 v = 0; v < count; v++) {
+            u32 loose = (lines->neighbours[v * 2] == CONTOUR_NONE) + (lines->neighbours[v * 2 + 1] == CONTOUR_NONE);
+            if(!lines->visited[v] && loose >= 1) {
+                walkStrip(lines, v);
+            }
+        }
+        for (u32 v = 0; v < count; v++) {
+            if(!lines->visited[v]) {
+                walkStrip(lines, v);
+            }
+        }
+    }
+}
+
+static i32 initLines(ContourLines* lines, PageArena* arena, u32 w, u32 h, u32 vertexCapacity) {
+    lines->vertexCapacity = vertexCapacity;
+    lines->indexCapacity = vertexCapacity * 2;
+    lines->vertices = arenaPageAlloc(arena, (usize)vertexCapacity * sizeof(ZetaVertex), ALIGN_16);
+    lines->indices = arenaPageAlloc(arena, (usize)lines->indexCapacity * sizeof(u32), ALIGN_4);
+    lines->neighbours = arenaPageAlloc(arena, (usize)vertexCapacity * 2 * sizeof(u32), ALIGN_4);
+    lines->visited = arenaPageAlloc(arena, vertexCapacity, ALIGN_1);
+    lines->codes = arenaPageAlloc(arena, (usize)(w - 1) * (h - 1), ALIGN_16);
+    lines->vertexCount = 0;
+    lines->indexCount = 0;
+    lines->stripCount = 0;
+    lines->overflow = 0;
+    if(!lines->vertices || !lines->indices || !lines->neighbours || !lines->visited || !lines->codes) {
+        return -1;
+    }
+    return 0;
+}
+
+i32 contourInit(ContourField* field, PageArena* arena, u32 w, u32 h, u32 vertexCapacity, u32 zeroCapacity) {
+    if(w < 2 || h < 2 || vertexCapacity == 0) {
+        LOG_ERROR("Contour field needs a 2x2 grid and vertex capacity, got %ux%u, %u", w, h, vertexCapacity);
+        return -1;
+    }
+    field->w = w;
+    field->h = h;
+    field->edgeH = arenaPageAlloc(arena, 2 * (usize)h * (w - 1) * sizeof(u32), ALIGN_16);
+    field->edgeV = arenaPageAlloc(arena, 2 * (usize)(h - 1) * w * sizeof(u32), ALIGN_16);
+    field->rowCount = arenaPageAlloc(arena, 2 * (usize)h * sizeof(u32), ALIGN_16);
+    field->zeroCapacity = zeroCapacity;
+    field->zeroCount = 0;
+    field->zeros = zeroCapacity ? arenaPageAlloc(arena, (usize)zeroCapacity * sizeof(ContourZero), ALIGN_16) : NULL;
+    if(!field->edgeH || !field->edgeV || !field->rowCount || (zeroCapacity && !field->zeros) ||
+            initLines(&field->reLines, arena, w, h, vertexCapacity) != 0 ||
+            initLines(&field->imLines, arena, w, h, vertexCapacity) != 0) {
+        LOG_ERROR("Contour field allocation failed.");
+        return -1;
+    }
+    return 0;
+}
+
+void contourExtract(ContourField* field, const ZetaPoint* grid, const ZetaVertex* vertexGrid) {
+    ContourJob job = {
+        .field = field,
+        .grid = grid,
+        .vertexGrid = vertexGrid
+    };
+    parallelFor(field->h, 16, countRows, &job);
+
+    //row counts become first vertex ids
+    for (u32 component = 0; component < 2; component++) {
+        ContourLines* lines = component ? &field->imLines : &field->reLines;
+        u32* counts = &field->rowCount[component * field->h];
+        u32 total = 0;
+        for (u32 r = 0; r < field->h; r++) {
+            u32 c = counts[r];
+            counts[r] = total;
+            total += c;
+        }
+        lines->vertexCount = total;
+        lines->overflow = (total > lines->vertexCapacity);
+        if(lines->overflow) {
+            LOG_ERROR("Contour %s needs %u vertices, capacity %u", component ? "Im" : "Re", total, lines->vertexCapacity);
+        }
+    }
+
+    parallelFor(field->h, 16, writeVertices, &job);
+    parallelFor(field->h - 1, 16, linkCells, &job);
+    field->zeroCount = 0;
+    if(field->zeroCapacity) {
+        parallelFor(field->h - 1, 16, findZeros, &job);
+        if(field->zeroCount > field->zeroCapacity) {
+            field->zeroCount = field->zeroCapacity;
+        }
+        //slots are claimed in whatever order the rows finish, sort so every run reports the same list
+        qsort(field->zeros, field->zeroCount, sizeof(ContourZero), byHeight);
+    }
+    parallelFor(2, 1, buildStrips, &job);
+
+    for (u32 component = 0; component < 2; component++) {
+        ContourLines* lines = component ? &field->imLines : &field->reLines;
+        if(lines->vertexCount > lines->vertexCapacity) {
+            lines->vertexCount = lines->vertexCapacity;
+        }
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef zeta_CONTOUR_H
+#define zeta_CONTOUR_H
+
+#include "common_types.h"
+#include "page_arena.h"
+#include "zeta.h"
+
+#define CONTOUR_RESTART 0xFFFFFFFFu
+#define CONTOUR_NONE 0xFFFFFFFFu
+//default capacities: one vertex per CONTOUR_VERTEX_DIVISOR samples per family
+#define CONTOUR_VERTEX_DIVISOR 8
+#define CONTOUR_ZERO_CAPACITY 256
+
+//one level curve family as line strips split by CONTOUR_RESTART, vertices share the ZetaVertex layout
+typedef struct ContourLines {
+    ZetaVertex* vertices;
+    u32* indices;
+    u32* neighbours;
+    u8* visited;
+    u8* codes;
+    u32 vertexCount;
+    u32 indexCount;
+    u32 stripCount;
+    u32 vertexCapacity;
+    u32 indexCapacity;
+    u32 overflow;
+} ContourLines;
+
+typedef struct ContourZero {
+    f32 sigma;
+    f32 t;
+    f32 gx;
+    f32 gy;
+} ContourZero;
+
+typedef struct ContourField {
+    u32 w;
+    u32 h;
+    u32* edgeH;
+    u32* edgeV;
+    u32* rowCount;
+    ContourLines reLines;
+    ContourLines imLines;
+    ContourZero* zeros;
+    u32 zeroCount;
+    u32 zeroCapacity;
+} ContourField;
+
+i32 contourInit(ContourField* field, PageArena* arena, u32 w, u32 h, u32 vertexCapacity, u32 zeroCapacity);
+void contourExtract(ContourField* field, const ZetaPoint* grid, const ZetaVertex* vertexGrid);
+
+#endif
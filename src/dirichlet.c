@@ -0,0 +1,345 @@
+#include <math.h>
+#include <string.h>
+#include "dirichlet.h"
+#include "parallel.h"
+
+#define DIRICHLET_TAU 6.28318530717958647692f
+#define DIRICHLET_MAX_GENERATORS 8
+
+typedef struct CharacterGroup {
+    u32 genCount;
+    u32 modulus[DIRICHLET_MAX_GENERATORS];
+    u32 gen[DIRICHLET_MAX_GENERATORS];
+    u32 order[DIRICHLET_MAX_GENERATORS];
+    u32 component[DIRICHLET_MAX_GENERATORS];
+} CharacterGroup;
+
+static u32 gcdU32(u32 a, u32 b) {
+    while(b) {
+        u32 r = a % b;
+        a = b;
+        b = r;
+    }
+    return a;
+}
+
+static u32 multiplicativeOrder(u32 g, u32 m) {
+    u32 x = g % m;
+    for (u32 k = 1; k <= m; k++) {
+        if(x == 1 % m) {
+            return k;
+        }
+        x = (x * g) % m;
+    }
+    return 0;
+}
+
+//(Z/qZ)* split by CRT into prime power components: odd p^e is cyclic,
+//2^e for e >= 3 is generated by -1 and 5
+static void characterGroup(CharacterGroup* group, u32 q) {
+    group->genCount = 0;
+    u32 rest = q;
+    for (u32 p = 2; p <= rest; p++) {
+        if(rest % p != 0) {
+            continue;
+        }
+        u32 pe = 1;
+        u32 e = 0;
+        while(rest % p == 0) {
+            rest /= p;
+            pe *= p;
+            e++;
+        }
+        u32 idx = group->genCount;
+        if(p == 2) {
+            if(e == 2) {
+                group->modulus[idx] = pe; group->gen[idx] = 3; group->order[idx] = 2;
+                group->component[idx] = idx;
+                group->genCount++;
+            } else if(e >= 3) {
+                group->modulus[idx] = pe; group->gen[idx] = pe - 1; group->order[idx] = 2;
+                group->component[idx] = idx;
+                group->modulus[idx + 1] = pe; group->gen[idx + 1] = 5; group->order[idx + 1] = pe / 4;
+                group->component[idx + 1] = idx;
+                group->genCount += 2;
+            }
+        } else {
+            u32 phi = pe / p * (p - 1);
+            for (u32 g = 2; g < pe; g++) {
+                if(gcdU32(g, pe) == 1 && multiplicativeOrder(g, pe) == phi) {
+                    group->modulus[idx] = pe; group->gen[idx] = g; group->order[idx] = phi;
+                    group->component[idx] = idx;
+                    group->genCount++;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+u32 dirichletCharacterCount(u32 modulus) {
+    if(modulus == 0) {
+        return 0;
+    }
+    u32 count = 0;
+    for (u32 r = 1; r <= modulus; r++) {
+        count += (gcdU32(r, modulus) == 1);
+    }
+    return count;
+}
+
+void dirichletFamilyInit(DirichletFamily* family, u32 termCount) {
+    memset(family, 0, sizeof(DirichletFamily));
+    family->termCount = termCount;
+}
+
+i32 dirichletFamilyAdd(DirichletFamily* family, const DirichletSeries* series) {
+    if(family->seriesCount >= DIRICHLET_MAX_SERIES) {
+        LOG_ERROR("Dirichlet family full, max %d series", DIRICHLET_MAX_SERIES);
+        return -1;
+    }
+    if(series->modulus < 1 || series->modulus > DIRICHLET_MAX_MODULUS) {
+        LOG_ERROR("Dirichlet series modulus %u outside 1..%d", series->modulus, DIRICHLET_MAX_MODULUS);
+        return -1;
+    }
+    if(series->offset <= -1.0f) {
+        LOG_ERROR("Dirichlet series offset must be > -1, got %f", series->offset);
+        return -1;
+    }
+    u32 index = family->seriesCount++;
+    family->series[index] = *series;
+
+    //rebuild the offset groups so series with equal offsets sit next to each other
+    family->groupCount = 0;
+    u32 placed = 0;
+    u32 used[DIRICHLET_MAX_SERIES] = {0};
+    for (u32 k = 0; k < family->seriesCount; k++) {
+        if(used[k]) {
+            continue;
+        }
+        f32 offset = family->series[k].offset;
+        family->groupOffset[family->groupCount] = offset;
+        family->groupStart[family->groupCount] = placed;
+        for (u32 m = k; m < family->seriesCount; m++) {
+            if(!used[m] && family->series[m].offset == offset) {
+                used[m] = 1;
+                family->order[placed++] = m;
+            }
+        }
+        family->groupCount++;
+    }
+    family->groupStart[family->groupCount] = placed;
+    return (i32)index;
+}
+
+void dirichletSeriesZeta(DirichletSeries* out) {
+    memset(out, 0, sizeof(DirichletSeries));
+    out->modulus = 1;
+    out->coeffRe[0] = 1.0f;
+}
+
+i32 dirichletSeriesHurwitz(DirichletSeries* out, f32 a) {
+    if(!(a > 0.0f) || a > 1.0f) {
+        LOG_ERROR("Hurwitz parameter must be in (0, 1], got %f", a);
+        return -1;
+    }
+    dirichletSeriesZeta(out);
+    //zeta(s, a) = sum n >= 0 of (n + a)^-s, shifted to start at n = 1
+    out->offset = a - 1.0f;
+    return 0;
+}
+
+i32 dirichletSeriesCharacter(DirichletSeries* out, u32 modulus, u32 index) {
+    if(modulus < 1 || modulus > DIRICHLET_MAX_MODULUS) {
+        LOG_ERROR("Character modulus %u outside 1..%d", modulus, DIRICHLET_MAX_MODULUS);
+        return -1;
+    }
+    u32 count = dirichletCharacterCount(modulus);
+    if(index >= count) {
+        LOG_ERROR("Character index %u out of range, modulus %u has %u characters", index, modulus, count);
+        return -1;
+    }
+
+    CharacterGroup group;
+    characterGroup(&group, modulus);
+
+    //mixed radix digits of index select the exponent on each generator
+    u32 digit[DIRICHLET_MAX_GENERATORS];
+    u32 rest = index;
+    for (u32 g = 0; g < group.genCount; g++) {
+        digit[g] = rest % group.order[g];
+        rest /= group.order[g];
+    }
+
+    memset(out, 0, sizeof(DirichletSeries));
+    out->modulus = modulus;
+    for (u32 r = 0; r < modulus; r++) {
+        if(gcdU32(r, modulus) != 1) {
+            continue;
+        }
+        f32 phase = 0.0f;
+        u32 g = 0;
+        while(g < group.genCount) {
+            u32 m = group.modulus[g];
+            u32 target = r % m;
+            //component has one or two generators, discrete log by brute force
+            u32 pair = (g + 1 < group.genCount && group.component[g + 1] == group.component[g]);
+            u32 orderB = pair ? group.order[g + 1] : 1;
+            u32 found = 0;
+            u32 xa = 1 % m;
+            for (u32 ea = 0; ea < group.order[g] && !found; ea++) {
+                u32 x = xa;
+                for (u32 eb = 0; eb < orderB && !found; eb++) {
+                    if(x == target) {
+                        phase += (f32)(digit[g] * ea) / (f32)group.order[g];
+                        if(pair) {
+                            phase += (f32)(digit[g + 1] * eb) / (f32)group.order[g + 1];
+                        }
+                        found = 1;
+                    }
+                    if(pair) {
+                        x = (x * group.gen[g + 1]) % m;
+                    }
+                }
+                xa = (xa * group.gen[g]) % m;
+            }
+            g += pair ? 2 : 1;
+        }
+        out->coeffRe[r] = cosf(DIRICHLET_TAU * phase);
+        out->coeffIm[r] = sinf(DIRICHLET_TAU * phase);
+        //snap the real characters to exact values
+        if(fabsf(out->coeffRe[r]) < 1e-6f) out->coeffRe[r] = 0.0f;
+        if(fabsf(out->coeffIm[r]) < 1e-6f) out->coeffIm[r] = 0.0f;
+    }
+    return 0;
+}
+
+void dirichletFamilyRow(const DirichletFamily* family, const f32* sigma, f32 t, u32 count,
+        f32* re_out, f32* im_out) {
+    f32 accRe[DIRICHLET_MAX_SERIES][DIRICHLET_ROW_BLOCK];
+    f32 accIm[DIRICHLET_MAX_SERIES][DIRICHLET_ROW_BLOCK];
+    f32 amp[DIRICHLET_ROW_BLOCK];
+
+    for (u32 j0 = 0; j0 < count; j0 += DIRICHLET_ROW_BLOCK) {
+        u32 block = (count - j0 < DIRICHLET_ROW_BLOCK) ? count - j0 : DIRICHLET_ROW_BLOCK;
+        const f32* sig = sigma + j0;
+        memset(accRe, 0, sizeof(accRe));
+        memset(accIm, 0, sizeof(accIm));
+
+        for (u32 g = 0; g < family->groupCount; g++) {
+            u32 first = family->groupStart[g];
+            u32 last = family->groupStart[g + 1];
+            f32 offset = family->groupOffset[g];
+
+            for (u32 n = 1; n <= family->termCount; n++) {
+                u32 live = 0;
+                for (u32 k = first; k < last; k++) {
+                    const DirichletSeries* s = &family->series[family->order[k]];
+                    u32 r = n % s->modulus;
+                    live |= (s->coeffRe[r] != 0.0f || s->coeffIm[r] != 0.0f);
+                }
+                if(!live) {
+                    continue;
+                }
+
+                //shared across every column of the row and every series of the group
+                f32 logn = logf((f32)n + offset);
+                f32 theta = t * logn;
+                f32 c = cosf(theta);
+                f32 sn = sinf(theta);
+                for (u32 j = 0; j < block; j++) {
+                    amp[j] = expf(-sig[j] * logn);
+                }
+
+                for (u32 k = first; k < last; k++) {
+                    u32 slot = family->order[k];
+                    const DirichletSeries* s = &family->series[slot];
+                    u32 r = n % s->modulus;
+                    f32 ar = s->coeffRe[r];
+                    f32 ai = s->coeffIm[r];
+                    if(ar == 0.0f && ai == 0.0f) {
+                        continue;
+                    }
+                    //a(n) * e^(-i theta)
+                    f32 pr = ar * c + ai * sn;
+                    f32 pi = ai * c - ar * sn;
+                    f32* outRe = accRe[slot];
+                    f32* outIm = accIm[slot];
+                    for (u32 j = 0; j < block; j++) {
+                        outRe[j] += amp[j] * pr;
+                        outIm[j] += amp[j] * pi;
+                    }
+                }
+            }
+        }
+
+        for (u32 k = 0; k < family->seriesCount; k++) {
+            memcpy(re_out + k * count + j0, accRe[k], block * sizeof(f32));
+            memcpy(im_out + k * count + j0, accIm[k], block * sizeof(f32));
+        }
+    }
+}
+
+void dirichletRow(void* ctx, const f32* sigma, f32 t, u32 count, f32* re_out, f32* im_out) {
+    const DirichletFamily* family = ctx;
+    //ComplexRowFunc contract has room for one output row, so only single series families fit
+    if(family->seriesCount != 1) {
+        LOG_ERROR("dirichletRow expects a single series family, got %u", family->seriesCount);
+        memset(re_out, 0, count * sizeof(f32));
+        memset(im_out, 0, count * sizeof(f32));
+        return;
+    }
+    dirichletFamilyRow(family, sigma, t, count, re_out, im_out);
+}
+
+typedef struct FamilyJob {
+    const DirichletFamily* family;
+    ZetaPoint** grids;
+    ZetaVertex** vertexGrids;
+    u32 w;
+    u32 h;
+    f32 sigma_min;
+    f32 sigma_max;
+    f32 t_min;
+    f32 t_max;
+} FamilyJob;
+
+static void populateFamilyRows(void* ctx, u32 begin, u32 end) {
+    FamilyJob* job = ctx;
+    u32 K = job->family->seriesCount;
+    f32 sigma[DIRICHLET_ROW_BLOCK];
+    f32 re[DIRICHLET_MAX_SERIES * DIRICHLET_ROW_BLOCK];
+    f32 im[DIRICHLET_MAX_SERIES * DIRICHLET_ROW_BLOCK];
+
+    for (u32 i = begin; i < end; i++) {
+        f32 t = job->t_min + i * (job->t_max - job->t_min) / (job->h - 1);
+        for (u32 j0 = 0; j0 < job->w; j0 += DIRICHLET_ROW_BLOCK) {
+            u32 block = (job->w - j0 < DIRICHLET_ROW_BLOCK) ? job->w - j0 : DIRICHLET_ROW_BLOCK;
+            for (u32 j = 0; j < block; j++) {
+                sigma[j] = job->sigma_min + (j0 + j) * (job->sigma_max - job->sigma_min) / (job->w - 1);
+            }
+            dirichletFamilyRow(job->family, sigma, t, block, re, im);
+            for (u32 k = 0; k < K; k++) {
+                usize base = (usize)i * job->w + j0;
+                storeMeshRow(&job->grids[k][base], &job->vertexGrids[k][base], sigma, t, block,
+                        re + k * block, im + k * block);
+            }
+        }
+    }
+}
+
+void populateFamily(const DirichletFamily* family, ZetaPoint** grids, ZetaVertex** vertexGrids, u32 w, u32 h,
+        f32 sigma_min, f32 sigma_max, f32 t_min, f32 t_max) {
+    FamilyJob job = {
+        .family = family,
+        .grids = grids,
+        .vertexGrids = vertexGrids,
+        .w = w,
+        .h = h,
+        .sigma_min = sigma_min,
+        .sigma_max = sigma_max,
+        .t_min = t_min,
+        .t_max = t_max
+    };
+    parallelFor(h, 1, populateFamilyRows, &job);
+}
@@ -0,0 +1,44 @@
+#ifndef zeta_DIRICHLET_H
+#define zeta_DIRICHLET_H
+
+#include "common_types.h"
+#include "zeta.h"
+
+#define DIRICHLET_MAX_MODULUS 32
+#define DIRICHLET_MAX_SERIES 16
+#define DIRICHLET_ROW_BLOCK 128
+
+//sum over n >= 1 of a(n) * (n + offset)^-s, with a(n) = coeff[n % modulus]
+typedef struct DirichletSeries {
+    f32 offset;
+    u32 modulus;
+    f32 coeffRe[DIRICHLET_MAX_MODULUS];
+    f32 coeffIm[DIRICHLET_MAX_MODULUS];
+} DirichletSeries;
+
+//series sharing an offset share log(n + offset), the row phase and (n + offset)^-sigma
+typedef struct DirichletFamily {
+    u32 termCount;
+    u32 seriesCount;
+    u32 groupCount;
+    u32 order[DIRICHLET_MAX_SERIES];
+    u32 groupStart[DIRICHLET_MAX_SERIES + 1];
+    f32 groupOffset[DIRICHLET_MAX_SERIES];
+    DirichletSeries series[DIRICHLET_MAX_SERIES];
+} DirichletFamily;
+
+void dirichletFamilyInit(DirichletFamily* family, u32 termCount);
+i32 dirichletFamilyAdd(DirichletFamily* family, const DirichletSeries* series);
+
+void dirichletSeriesZeta(DirichletSeries* out);
+i32 dirichletSeriesHurwitz(DirichletSeries* out, f32 a);
+i32 dirichletSeriesCharacter(DirichletSeries* out, u32 modulus, u32 index);
+u32 dirichletCharacterCount(u32 modulus);
+
+void dirichletFamilyRow(const DirichletFamily* family, const f32* sigma, f32 t, u32 count,
+        f32* re_out, f32* im_out);
+void dirichletRow(void* ctx, const f32* sigma, f32 t, u32 count, f32* re_out, f32* im_out);
+void populateFamily(const DirichletFamily* family, ZetaPoint** grids, ZetaVertex** vertexGrids, u32 w, u32 h,
+        f32 sigma_min, f32 sigma_max, f32 t_min, f32 t_max);
+
+#endif
@@ -0,0 +1,590 @@
+#include <math.h>
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include "expr.h"
+#include "zeta.h"
+
+#define EXPR_MAX_NODES 256
+#define EXPR_NONE 0xFFFF
+#define EXPR_MAX_POW 16
+//every recursion in the parser passes through parseUnary, this caps the C stack it takes
+#define EXPR_MAX_DEPTH 128
+
+typedef struct ExprNode {
+    u8 op;
+    u16 a;
+    u16 b;
+    f32 re;
+    f32 im;
+} ExprNode;
+
+typedef struct ExprCompiler {
+    const char* src;
+    const char* cur;
+    u32 failed;
+    u32 depth;
+    u32 nodeCount;
+    ExprNode nodes[EXPR_MAX_NODES];
+} ExprCompiler;
+
+//scalar complex kernels, shared by constant folding and the lane loops
+static inline void cDiv(f32 ar, f32 ai, f32 br, f32 bi, f32* r, f32* i) {
+    f32 d = br * br + bi * bi;
+    *r = (ar * br + ai * bi) / d;
+    *i = (ai * br - ar * bi) / d;
+}
+
+static inline void cExp(f32 ar, f32 ai, f32* r, f32* i) {
+    f32 m = expf(ar);
+    *r = m * cosf(ai);
+    *i = m * sinf(ai);
+}
+
+static inline void cLog(f32 ar, f32 ai, f32* r, f32* i) {
+    *r = 0.5f * logf(ar * ar + ai * ai);
+    *i = atan2f(ai, ar);
+}
+
+static inline void cSqrt(f32 ar, f32 ai, f32* r, f32* i) {
+    f32 m = sqrtf(sqrtf(ar * ar + ai * ai));
+    f32 h = 0.5f * atan2f(ai, ar);
+    *r = m * cosf(h);
+    *i = m * sinf(h);
+}
+
+static inline void cSin(f32 ar, f32 ai, f32* r, f32* i) {
+    *r = sinf(ar) * coshf(ai);
+    *i = cosf(ar) * sinhf(ai);
+}
+
+static inline void cCos(f32 ar, f32 ai, f32* r, f32* i) {
+    *r = cosf(ar) * coshf(ai);
+    *i = -sinf(ar) * sinhf(ai);
+}
+
+static inline void cSinh(f32 ar, f32 ai, f32* r, f32* i) {
+    *r = sinhf(ar) * cosf(ai);
+    *i = coshf(ar) * sinf(ai);
+}
+
+static inline void cCosh(f32 ar, f32 ai, f32* r, f32* i) {
+    *r = coshf(ar) * cosf(ai);
+    *i = sinhf(ar) * sinf(ai);
+}
+
+static inline void cPow(f32 ar, f32 ai, f32 br, f32 bi, f32* r, f32* i) {
+    if(ar == 0.0f && ai == 0.0f) {
+        *r = 0.0f;
+        *i = 0.0f;
+        return;
+    }
+    f32 lr, li;
+    cLog(ar, ai, &lr, &li);
+    cExp(br * lr - bi * li, br * li + bi * lr, r, i);
+}
+
+static void foldScalar(u8 op, f32 ar, f32 ai, f32 br, f32 bi, f32* r, f32* i) {
+    switch(op) {
+        case EXPR_OP_ADD: *r = ar + br; *i = ai + bi; break;
+        case EXPR_OP_SUB: *r = ar - br; *i = ai - bi; break;
+        case EXPR_OP_MUL: *r = ar * br - ai * bi; *i = ar * bi + ai * br; break;
+        case EXPR_OP_DIV: cDiv(ar, ai, br, bi, r, i); break;
+        case EXPR_OP_NEG: *r = -ar; *i = -ai; break;
+        case EXPR_OP_EXP: cExp(ar, ai, r, i); break;
+        case EXPR_OP_LOG: cLog(ar, ai, r, i); break;
+        case EXPR_OP_SQRT: cSqrt(ar, ai, r, i); break;
+        case EXPR_OP_SIN: cSin(ar, ai, r, i); break;
+        case EXPR_OP_COS: cCos(ar, ai, r, i); break;
+        case EXPR_OP_SINH: cSinh(ar, ai, r, i); break;
+        case EXPR_OP_COSH: cCosh(ar, ai, r, i); break;
+        case EXPR_OP_POW: cPow(ar, ai, br, bi, r, i); break;
+        case EXPR_OP_ZETA: zetaApprox(ar, ai, r, i); break;
+        default: *r = 0.0f; *i = 0.0f; break;
+    }
+}
+
+static void compileError(ExprCompiler* c, const char* message) {
+    if(!c->failed) {
+        LOG_ERROR("expression error at column %d: %s", (int)(c->cur - c->src) + 1, message);
+    }
+    c->failed = 1;
+}
+
+static u16 findOrAdd(ExprCompiler* c, ExprNode node) {
+    for (u32 k = 0; k < c->nodeCount; k++) {
+        ExprNode* n = &c->nodes[k];
+        if(n->op == node.op && n->a == node.a && n->b == node.b && n->re == node.re && n->im == node.im) {
+            return (u16)k;
+        }
+    }
+    if(c->nodeCount >= EXPR_MAX_NODES) {
+        compileError(c, "expression too large");
+        return 0;
+    }
+    c->nodes[c->nodeCount] = node;
+    return (u16)c->nodeCount++;
+}
+
+static u16 constNode(ExprCompiler* c, f32 re, f32 im) {
+    ExprNode node = { .op = EXPR_OP_CONST, .a = EXPR_NONE, .b = EXPR_NONE, .re = re, .im = im };
+    return findOrAdd(c, node);
+}
+
+static u32 isConst(ExprCompiler* c, u16 n, f32 re, f32 im) {
+    return c->nodes[n].op == EXPR_OP_CONST && c->nodes[n].re == re && c->nodes[n].im == im;
+}
+
+static u16 makeNode(ExprCompiler* c, u8 op, u16 a, u16 b);
+
+//x^k for small integer k as a square and multiply chain, CSE merges the repeats
+static u16 powInteger(ExprCompiler* c, u16 base, i32 k) {
+    u32 m = (k < 0) ? (u32)-k : (u32)k;
+    u16 result = constNode(c, 1.0f, 0.0f);
+    u16 square = base;
+    while(m) {
+        if(m & 1) {
+            result = makeNode(c, EXPR_OP_MUL, result, square);
+        }
+        m >>= 1;
+        if(m) {
+            square = makeNode(c, EXPR_OP_MUL, square, square);
+        }
+    }
+    if(k < 0) {
+        result = makeNode(c, EXPR_OP_DIV, constNode(c, 1.0f, 0.0f), result);
+    }
+    return result;
+}
+
+static u16 makeNode(ExprCompiler* c, u8 op, u16 a, u16 b) {
+    if(c->failed) {
+        return 0;
+    }
+    u32 unary = (b == EXPR_NONE);
+    ExprNode* na = &c->nodes[a];
+    ExprNode* nb = unary ? NULL : &c->nodes[b];
+
+    if(na->op == EXPR_OP_CONST && (unary || nb->op == EXPR_OP_CONST)) {
+        f32 r, i;
+        foldScalar(op, na->re, na->im, unary ? 0.0f : nb->re, unary ? 0.0f : nb->im, &r, &i);
+        return constNode(c, r, i);
+    }
+
+    switch(op) {
+        case EXPR_OP_ADD:
+            if(isConst(c, a, 0.0f, 0.0f)) return b;
+            if(isConst(c, b, 0.0f, 0.0f)) return a;
+            break;
+        case EXPR_OP_SUB:
+            if(isConst(c, b, 0.0f, 0.0f)) return a;
+            if(isConst(c, a, 0.0f, 0.0f)) return makeNode(c, EXPR_OP_NEG, b, EXPR_NONE);
+            break;
+        case EXPR_OP_MUL:
+            if(isConst(c, a, 1.0f, 0.0f)) return b;
+            if(isConst(c, b, 1.0f, 0.0f)) return a;
+            break;
+        case EXPR_OP_DIV:
+            if(isConst(c, b, 1.0f, 0.0f)) return a;
+            break;
+        case EXPR_OP_NEG:
+            if(na->op == EXPR_OP_NEG) return na->a;
+            break;
+        case EXPR_OP_POW:
+            if(nb->op == EXPR_OP_CONST && nb->im == 0.0f) {
+                f32 k = nb->re;
+                if(k == floorf(k) && fabsf(k) <= EXPR_MAX_POW) {
+                    return powInteger(c, a, (i32)k);
+                }
+                if(k == 0.5f) {
+                    return makeNode(c, EXPR_OP_SQRT, a, EXPR_NONE);
+                }
+            }
+            break;
+        case EXPR_OP_ZETA:
+            //zeta(s) itself runs on the batched row kernel
+            if(na->op == EXPR_OP_VAR) {
+                op = EXPR_OP_ZETA_S;
+            }
+            break;
+    }
+
+    if((op == EXPR_OP_ADD || op == EXPR_OP_MUL) && a > b) {
+        u16 tmp = a;
+        a = b;
+        b = tmp;
+    }
+    ExprNode node = { .op = op, .a = a, .b = b, .re = 0.0f, .im = 0.0f };
+    return findOrAdd(c, node);
+}
+
+static void skipSpace(ExprCompiler* c) {
+    while(*c->cur && isspace((unsigned char)*c->cur)) {
+        c->cur++;
+    }
+}
+
+static u32 accept(ExprCompiler* c, char ch) {
+    skipSpace(c);
+    if(*c->cur == ch) {
+        c->cur++;
+        return 1;
+    }
+    return 0;
+}
+
+static u16 parseExpr(ExprCompiler* c);
+static u16 parseUnary(ExprCompiler* c);
+
+typedef struct ExprFunc {
+    const char* name;
+    u8 op;
+    u8 args;
+} ExprFunc;
+
+static const ExprFunc exprFuncs[] = {
+    { "exp", EXPR_OP_EXP, 1 },
+    { "log", EXPR_OP_LOG, 1 },
+    { "sqrt", EXPR_OP_SQRT, 1 },
+    { "sin", EXPR_OP_SIN, 1 },
+    { "cos", EXPR_OP_COS, 1 },
+    { "sinh", EXPR_OP_SINH, 1 },
+    { "cosh", EXPR_OP_COSH, 1 },
+    { "zeta", EXPR_OP_ZETA, 1 },
+    { "pow", EXPR_OP_POW, 2 },
+};
+
+static u16 parsePrimary(ExprCompiler* c) {
+    skipSpace(c);
+    if(c->failed) {
+        return 0;
+    }
+    if(accept(c, '(')) {
+        u16 inner = parseExpr(c);
+        if(!accept(c, ')')) {
+            compileError(c, "expected ')'");
+        }
+        return inner;
+    }
+    if(isdigit((unsigned char)*c->cur) || *c->cur == '.') {
+        char* end;
+        f64 value = strtod(c->cur, &end);
+        if(end == c->cur) {
+            compileError(c, "bad number");
+            return 0;
+        }
+        c->cur = end;
+        return constNode(c, (f32)value, 0.0f);
+    }
+    if(isalpha((unsigned char)*c->cur)) {
+        char name[16];
+        u32 len = 0;
+        while(isalnum((unsigned char)*c->cur) || *c->cur == '_') {
+            if(len < sizeof(name) - 1) {
+                name[len++] = *c->cur;
+            }
+            c->cur++;
+        }
+        name[len] = '\0';
+
+        if(strcmp(name, "s") == 0) {
+            ExprNode node = { .op = EXPR_OP_VAR, .a = EXPR_NONE, .b = EXPR_NONE };
+            return findOrAdd(c, node);
+        }
+        if(strcmp(name, "i") == 0) return constNode(c, 0.0f, 1.0f);
+        if(strcmp(name, "pi") == 0) return constNode(c, (f32)M_PI, 0.0f);
+        if(strcmp(name, "e") == 0) return constNode(c, (f32)M_E, 0.0f);
+
+        for (u32 f = 0; f < sizeof(exprFuncs) / sizeof(exprFuncs[0]); f++) {
+            if(strcmp(name, exprFuncs[f].name) != 0) {
+                continue;
+            }
+            if(!accept(c, '(')) {
+                compileError(c, "expected '(' after function name");
+                return 0;
+            }
+            u16 a = parseExpr(c);
+            u16 b = EXPR_NONE;
+            if(exprFuncs[f].args == 2) {
+                if(!accept(c, ',')) {
+                    compileError(c, "expected ',' in two argument function");
+                    return 0;
+                }
+                b = parseExpr(c);
+            }
+            if(!accept(c, ')')) {
+                compileError(c, "expected ')' after function arguments");
+                return 0;
+            }
+            return makeNode(c, exprFuncs[f].op, a, b);
+        }
+        compileError(c, "unknown identifier");
+        return 0;
+    }
+    compileError(c, "unexpected character");
+    return 0;
+}
+
+static u16 parsePower(ExprCompiler* c) {
+    u16 base = parsePrimary(c);
+    if(accept(c, '^')) {
+        //right associative, binds tighter than unary minus on the left
+        u16 exponent = parseUnary(c);
+        return makeNode(c, EXPR_OP_POW, base, exponent);
+    }
+    return base;
+}
+
+static u16 parseUnary(ExprCompiler* c) {
+    if(c->depth >= EXPR_MAX_DEPTH) {
+        compileError(c, "expression nested too deeply");
+        return 0;
+    }
+    c->depth++;
+    u16 result;
+    if(accept(c, '-')) {
+        result = makeNode(c, EXPR_OP_NEG, parseUnary(c), EXPR_NONE);
+    } else if(accept(c, '+')) {
+        result = parseUnary(c);
+    } else {
+        result = parsePower(c);
+    }
+    c->depth--;
+    return result;
+}
+
+static u16 parseTerm(ExprCompiler* c) {
+    u16 left = parseUnary(c);
+    for (;;) {
+        if(accept(c, '*')) {
+            left = makeNode(c, EXPR_OP_MUL, left, parseUnary(c));
+        } else if(accept(c, '/')) {
+            left = makeNode(c, EXPR_OP_DIV, left, parseUnary(c));
+        } else {
+            return left;
+        }
+    }
+}
+
+static u16 parseExpr(ExprCompiler* c) {
+    u16 left = parseTerm(c);
+    for (;;) {
+        if(accept(c, '+')) {
+            left = makeNode(c, EXPR_OP_ADD, left, parseTerm(c));
+        } else if(accept(c, '-')) {
+            left = makeNode(c, EXPR_OP_SUB, left, parseTerm(c));
+        } else {
+            return left;
+        }
+    }
+}
+
+i32 exprCompile(ExprProgram* program, const char* source) {
+    ExprCompiler c;
+    memset(&c, 0, sizeof(ExprCompiler));
+    c.src = source;
+    c.cur = source;
+
+    u16 root = parseExpr(&c);
+    skipSpace(&c);
+    if(!c.failed && *c.cur != '\0') {
+        compileError(&c, "trailing characters");
+    }
+    if(c.failed) {
+        return -1;
+    }
+
+    //children always precede parents, so one backward sweep marks the live DAG
+    u8 live[EXPR_MAX_NODES] = {0};
+    u16 lastUse[EXPR_MAX_NODES];
+    live[root] = 1;
+    for (i32 k = (i32)root; k >= 0; k--) {
+        if(!live[k]) continue;
+        if(c.nodes[k].a != EXPR_NONE && c.nodes[k].op != EXPR_OP_CONST) live[c.nodes[k].a] = 1;
+        if(c.nodes[k].b != EXPR_NONE) live[c.nodes[k].b] = 1;
+    }
+    for (u32 k = 0; k <= root; k++) {
+        lastUse[k] = (u16)k;
+    }
+    for (u32 k = 0; k <= root; k++) {
+        if(!live[k]) continue;
+        if(c.nodes[k].a != EXPR_NONE) lastUse[c.nodes[k].a] = (u16)k;
+        if(c.nodes[k].b != EXPR_NONE) lastUse[c.nodes[k].b] = (u16)k;
+    }
+
+    memset(program, 0, sizeof(ExprProgram));
+    u8 regOf[EXPR_MAX_NODES];
+    u8 regFree[EXPR_MAX_REGS];
+    u32 freeCount = 0;
+
+    for (u32 k = 0; k <= root; k++) {
+        if(!live[k]) continue;
+        ExprNode* n = &c.nodes[k];
+        ExprInstr instr = { .op = n->op, .a = 0, .b = 0 };
+
+        if(n->op == EXPR_OP_CONST) {
+            if(program->constCount >= EXPR_MAX_CONSTS) {
+                LOG_ERROR("expression uses more than %d constants", EXPR_MAX_CONSTS);
+                return -1;
+            }
+            instr.a = (u8)program->constCount;
+            program->constRe[program->constCount] = n->re;
+            program->constIm[program->constCount] = n->im;
+            program->constCount++;
+        } else if(n->op != EXPR_OP_VAR) {
+            instr.a = regOf[n->a];
+            if(n->b != EXPR_NONE) instr.b = regOf[n->b];
+            //operands that die here hand their registers straight to the result
+            if(lastUse[n->a] == k) regFree[freeCount++] = regOf[n->a];
+            if(n->b != EXPR_NONE && n->b != n->a && lastUse[n->b] == k) regFree[freeCount++] = regOf[n->b];
+        }
+
+        if(freeCount > 0) {
+            regOf[k] = regFree[--freeCount];
+        } else {
+            if(program->regCount >= EXPR_MAX_REGS) {
+                LOG_ERROR("expression needs more than %d registers", EXPR_MAX_REGS);
+                return -1;
+            }
+            regOf[k] = (u8)program->regCount++;
+        }
+        instr.dst = regOf[k];
+
+        if(program->codeCount >= EXPR_MAX_CODE) {
+            LOG_ERROR("expression longer than %d instructions", EXPR_MAX_CODE);
+            return -1;
+        }
+        program->code[program->codeCount++] = instr;
+    }
+    program->result = regOf[root];
+    return 0;
+}
+
+void exprDump(const ExprProgram* program, FILE* out) {
+    static const char* names[] = {
+        "const", "var", "add", "sub", "mul", "div", "neg", "exp", "log", "sqrt",
+        "sin", "cos", "sinh", "cosh", "pow", "zeta", "zeta_s"
+    };
+    for (u32 k = 0; k < program->codeCount; k++) {
+        const ExprInstr* in = &program->code[k];
+        if(in->op == EXPR_OP_CONST) {
+            fprintf(out, "r%u = %g%+gi\n", in->dst, program->constRe[in->a], program->constIm[in->a]);
+        } else if(in->op == EXPR_OP_VAR) {
+            fprintf(out, "r%u = s\n", in->dst);
+        } else {
+            fprintf(out, "r%u = %s r%u r%u\n", in->dst, names[in->op], in->a, in->b);
+        }
+    }
+    fprintf(out, "result r%u, %u registers\n", program->result, program->regCount);
+}
+
+#define LANE_UNARY(fn) \
+    for (u32 l = 0; l < n; l++) { \
+        f32 r, i; \
+        fn(ar[l], ai[l], &r, &i); \
+        dr[l] = r; \
+        di[l] = i; \
+    }
+
+//uniformT marks a grid row, where zeta(s) can use the row kernel
+static void exprRun(const ExprProgram* program, const f32* sre, const f32* sim, u32 uniformT,
+        u32 count, f32* re_out, f32* im_out) {
+    f32 regRe[EXPR_MAX_REGS][EXPR_LANES];
+    f32 regIm[EXPR_MAX_REGS][EXPR_LANES];
+
+    for (u32 base = 0; base < count; base += EXPR_LANES) {
+        u32 n = (count - base < EXPR_LANES) ? count - base : EXPR_LANES;
+        const f32* vr = sre + base;
+        const f32* vi = sim + base;
+
+        for (u32 k = 0; k < program->codeCount; k++) {
+            const ExprInstr* in = &program->code[k];
+            f32* dr = regRe[in->dst];
+            f32* di = regIm[in->dst];
+            const f32* ar = regRe[in->a];
+            const f32* ai = regIm[in->a];
+            const f32* br = regRe[in->b];
+            const f32* bi = regIm[in->b];
+
+            switch(in->op) {
+                case EXPR_OP_CONST: {
+                    f32 cr = program->constRe[in->a];
+                    f32 ci = program->constIm[in->a];
+                    for (u32 l = 0; l < n; l++) { dr[l] = cr; di[l] = ci; }
+                } break;
+                case EXPR_OP_VAR:
+                    memcpy(dr, vr, n * sizeof(f32));
+                    memcpy(di, vi, n * sizeof(f32));
+                    break;
+                case EXPR_OP_ADD:
+                    for (u32 l = 0; l < n; l++) { dr[l] = ar[l] + br[l]; di[l] = ai[l] + bi[l]; }
+                    break;
+                case EXPR_OP_SUB:
+                    for (u32 l = 0; l < n; l++) { dr[l] = ar[l] - br[l]; di[l] = ai[l] - bi[l]; }
+                    break;
+                case EXPR_OP_MUL:
+                    for (u32 l = 0; l < n; l++) {
+                        f32 r = ar[l] * br[l] - ai[l] * bi[l];
+                        f32 i = ar[l] * bi[l] + ai[l] * br[l];
+                        dr[l] = r;
+                        di[l] = i;
+                    }
+                    break;
+                case EXPR_OP_DIV:
+                    for (u32 l = 0; l < n; l++) {
+                        f32 r, i;
+                        cDiv(ar[l], ai[l], br[l], bi[l], &r, &i);
+                        dr[l] = r;
+                        di[l] = i;
+                    }
+                    break;
+                case EXPR_OP_NEG:
+                    for (u32 l = 0; l < n; l++) { dr[l] = -ar[l]; di[l] = -ai[l]; }
+                    break;
+                case EXPR_OP_EXP: LANE_UNARY(cExp); break;
+                case EXPR_OP_LOG: LANE_UNARY(cLog); break;
+                case EXPR_OP_SQRT: LANE_UNARY(cSqrt); break;
+                case EXPR_OP_SIN: LANE_UNARY(cSin); break;
+                case EXPR_OP_COS: LANE_UNARY(cCos); break;
+                case EXPR_OP_SINH: LANE_UNARY(cSinh); break;
+                case EXPR_OP_COSH: LANE_UNARY(cCosh); break;
+                case EXPR_OP_ZETA: LANE_UNARY(zetaApprox); break;
+                case EXPR_OP_POW:
+                    for (u32 l = 0; l < n; l++) {
+                        f32 r, i;
+                        cPow(ar[l], ai[l], br[l], bi[l], &r, &i);
+                        dr[l] = r;
+                        di[l] = i;
+                    }
+                    break;
+                case EXPR_OP_ZETA_S:
+                    if(uniformT) {
+                        zetaApproxRow(NULL, vr, vi[0], n, dr, di);
+                    } else {
+                        for (u32 l = 0; l < n; l++) {
+                            zetaApprox(vr[l], vi[l], &dr[l], &di[l]);
+                        }
+                    }
+                    break;
+            }
+        }
+        memcpy(re_out + base, regRe[program->result], n * sizeof(f32));
+        memcpy(im_out + base, regIm[program->result], n * sizeof(f32));
+    }
+}
+
+void exprEval(const ExprProgram* program, const f32* sre, const f32* sim, u32 count, f32* re_out, f32* im_out) {
+    exprRun(program, sre, sim, 0, count, re_out, im_out);
+}
+
+void exprRow(void* ctx, const f32* sigma, f32 t, u32 count, f32* re_out, f32* im_out) {
+    const ExprProgram* program = ctx;
+    f32 tLane[EXPR_LANES];
+    for (u32 l = 0; l < EXPR_LANES; l++) {
+        tLane[l] = t;
+    }
+    for (u32 base = 0; base < count; base += EXPR_LANES) {
+        u32 n = (count - base < EXPR_LANES) ? count - base : EXPR_LANES;
+        exprRun(program, sigma + base, tLane, 1, n, re_out + base, im_out + base);
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef zeta_EXPR_H
+#define zeta_EXPR_H
+
+#include "common_types.h"
+
+#define EXPR_LANES 64
+#define EXPR_MAX_REGS 32
+#define EXPR_MAX_CODE 256
+#define EXPR_MAX_CONSTS 64
+
+typedef enum ExprOp {
+    EXPR_OP_CONST,
+    EXPR_OP_VAR,
+    EXPR_OP_ADD,
+    EXPR_OP_SUB,
+    EXPR_OP_MUL,
+    EXPR_OP_DIV,
+    EXPR_OP_NEG,
+    EXPR_OP_EXP,
+    EXPR_OP_LOG,
+    EXPR_OP_SQRT,
+    EXPR_OP_SIN,
+    EXPR_OP_COS,
+    EXPR_OP_SINH,
+    EXPR_OP_COSH,
+    EXPR_OP_POW,
+    EXPR_OP_ZETA,
+    EXPR_OP_ZETA_S
+} ExprOp;
+
+//register machine, every register holds EXPR_LANES complex values
+typedef struct ExprInstr {
+    u8 op;
+    u8 dst;
+    u8 a;
+    u8 b;
+} ExprInstr;
+
+typedef struct ExprProgram {
+    u32 codeCount;
+    u32 constCount;
+    u32 regCount;
+    u32 result;
+    ExprInstr code[EXPR_MAX_CODE];
+    f32 constRe[EXPR_MAX_CONSTS];
+    f32 constIm[EXPR_MAX_CONSTS];
+} ExprProgram;
+
+i32 exprCompile(ExprProgram* program, const char* source);
+void exprDump(const ExprProgram* program, FILE* out);
+void exprEval(const ExprProgram* program, const f32* sre, const f32* sim, u32 count, f32* re_out, f32* im_out);
+void exprRow(void* ctx, const f32* sigma, f32 t, u32 count, f32* re_out, f32* im_out);
+
+#endif
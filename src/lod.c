@@ -0,0 +1,470 @@
+#include <math.h>
+#include <float.h>
+#include <string.h>
+#include "arena_base.h"
+#include "lod.h"
+#include "parallel.h"
+#include "vcache.h"
+
+typedef struct LodJob {
+    ZetaLod* lod;
+    const ZetaVertex* grid;
+    void* packed;
+} LodJob;
+
+//largest grid size not above n that splits into whole chunks
+u32 lodGridSize(u32 n) {
+    if(n < LOD_CHUNK + 1) {
+        return n;
+    }
+    return (n - 1) / LOD_CHUNK * LOD_CHUNK + 1;
+}
+
+//room for either form, n rows of 2 * (n + 1) strip indices with a restart between rows or six list indices per quad
+usize lodTemplateCapacity(void) {
+    usize strips = 0;
+    usize lists = 0;
+    for (u32 l = 0; l < LOD_LEVELS; l++) {
+        usize n = LOD_CHUNK >> l;
+        strips += n * 2 * (n + 1) + n - 1;
+        lists += n * n * 6;
+    }
+    return ((strips > lists) ? strips : lists) * LOD_EDGE_VARIANTS;
+}
+
+usize lodVertexCount(u32 w, u32 h) {
+    if(w < LOD_CHUNK + 1 || h < LOD_CHUNK + 1 || (w - 1) % LOD_CHUNK != 0 || (h - 1) % LOD_CHUNK != 0) {
+        return (usize)w * h;
+    }
+    return (usize)((w - 1) / LOD_CHUNK) * ((h - 1) / LOD_CHUNK) * LOD_CHUNK_VERTICES;
+}
+
+usize lodVertexSize(u32 format) {
+    return (format == LOD_FORMAT_UNORM16) ? sizeof(LodVertex) : sizeof(ZetaVertex);
+}
+
+//edge samples a coarser neighbour doesn't have collapse onto the previous one it does have
+static u16 templateIndex(u32 x, u32 y, u32 step, u32 edges) {
+    u32 coarse = step * 2;
+    if(coarse <= LOD_CHUNK) {
+        if((y == 0 && (edges & LOD_EDGE_TOP)) || (y == LOD_CHUNK && (edges & LOD_EDGE_BOTTOM))) {
+            x -= x % coarse;
+        }
+        if((x == 0 && (edges & LOD_EDGE_LEFT)) || (x == LOD_CHUNK && (edges & LOD_EDGE_RIGHT))) {
+            y -= y % coarse;
+        }
+    }
+    return (u16)(y * LOD_CHUNK_SIDE + x);
+}
+
+//a row strip top, bottom, top, ... gives the same diagonal as generateMesh so level 0 matches the full mesh,
+//snapped edges leave degenerate triangles in the strip which the rasterizer drops
+static u32 buildTemplate(u16* out, u32 level, u32 edges, u32* triangles) {
+    u32 step = 1u << level;
+    u32 count = 0;
+    *triangles = 0;
+    for (u32 y = 0; y < LOD_CHUNK; y += step) {
+        if(y > 0) {
+            out[count++] = LOD_RESTART;
+        }
+        u32 row = count;
+        for (u32 x = 0; x <= LOD_CHUNK; x += step) {
+            out[count++] = templateIndex(x, y, step, edges);
+            out[count++] = templateIndex(x, y + step, step, edges);
+        }
+        for (u32 i = row + 2; i < count; i++) {
+            *triangles += (out[i - 2] != out[i - 1] && out[i - 1] != out[i] && out[i - 2] != out[i]);
+        }
+    }
+    return count;
+}
+
+//the same triangles as the strip with the same winding, degenerate ones left out,
+//a strip's odd triangles swap their first two vertices so the second of each quad is (TR, BL, BR)
+static u32 buildTemplateList(u32* out, u32 level, u32 edges) {
+    u32 step = 1u << level;
+    u32 count = 0;
+    for (u32 y = 0; y < LOD_CHUNK; y += step) {
+        for (u32 x = 0; x < LOD_CHUNK; x += step) {
+            u32 quad[4] = {
+                templateIndex(x, y, step, edges),
+                templateIndex(x, y + step, step, edges),
+                templateIndex(x + step, y, step, edges),
+                templateIndex(x + step, y + step, step, edges)
+            };
+            for (u32 t = 0; t < 2; t++) {
+                u32 a = t ? quad[2] : quad[0];
+                u32 b = quad[1];
+                u32 c = t ? quad[3] : quad[2];
+                if(a != b && b != c && a != c) {
+                    out[count++] = a;
+                    out[count++] = b;
+                    out[count++] = c;
+                }
+            }
+        }
+    }
+    return count;
+}
+
+i32 lodInit(ZetaLod* lod, PageArena* arena, u32 w, u32 h) {
+    if(w < LOD_CHUNK + 1 || h < LOD_CHUNK + 1 || (w - 1) % LOD_CHUNK != 0 || (h - 1) % LOD_CHUNK != 0) {
+        LOG_ERROR("LOD needs a grid of whole %u cell chunks, got %ux%u", LOD_CHUNK, w, h);
+        return -1;
+    }
+    lod->w = w;
+    lod->h = h;
+    lod->chunksX = (w - 1) / LOD_CHUNK;
+    lod->chunksY = (h - 1) / LOD_CHUNK;
+    lod->chunkCount = lod->chunksX * lod->chunksY;
+    lod->drawCount = 0;
+    lod->drawnIndices = 0;
+    lod->stats = (LodStats){0};
+    lod->chunks = arenaPageAlloc(arena, lod->chunkCount * sizeof(LodChunk), ALIGN_16);
+    lod->draws = arenaPageAlloc(arena, lod->chunkCount * sizeof(LodDraw), ALIGN_16);
+    lod->vertexCount = lod->chunkCount * LOD_CHUNK_VERTICES;
+    lod->order = LOD_ORDER_STRIPS;
+    lod->format = LOD_FORMAT_FLOAT;
+    for (u32 i = 0; i < LOD_CHUNK_VERTICES; i++) {
+        lod->vertexOrder[i] = (u16)i;
+    }
+    lod->indices = arenaPageAlloc(arena, lodTemplateCapacity() * sizeof(u16), ALIGN_16);
+    if(!lod->chunks || !lod->draws || !lod->indices) {
+        LOG_ERROR("LOD allocation failed for %u chunks.", lod->chunkCount);
+        return -1;
+    }
+
+    u32 offset = 0;
+    for (u32 l = 0; l < LOD_LEVELS; l++) {
+        for (u32 e = 0; e < LOD_EDGE_VARIANTS; e++) {
+            u32 count = buildTemplate(&lod->indices[offset], l, e, &lod->ranges[l][e].triangles);
+            lod->ranges[l][e].offset = offset;
+            lod->ranges[l][e].count = count;
+            offset += count;
+        }
+    }
+    lod->indexCount = offset;
+
+    for (u32 c = 0; c < lod->chunkCount; c++) {
+        lod->chunks[c].baseVertex = c * LOD_CHUNK_VERTICES;
+        lod->chunks[c].level = 0;
+    }
+    return 0;
+}
+
+//vertices are renumbered once from the full-detail template, every template then gets its own triangle order
+i32 lodCacheOptimize(ZetaLod* lod, PageArena* scratch) {
+    ArenaMark mark = arenaPageSave(scratch);
+    u32* list = arenaPageAlloc(scratch, LOD_CHUNK * LOD_CHUNK * 6 * sizeof(u32), ALIGN_16);
+    u32* order = arenaPageAlloc(scratch, LOD_CHUNK_VERTICES * sizeof(u32), ALIGN_16);
+    u32* remap = arenaPageAlloc(scratch, LOD_CHUNK_VERTICES * sizeof(u32), ALIGN_16);
+    if(!list || !order || !remap) {
+        LOG_ERROR("No scratch to reorder LOD templates.");
+        arenaPageRestore(scratch, mark);
+        return -1;
+    }
+    u32 count = buildTemplateList(list, 0, 0);
+    if(vcacheOptimize(list, count, LOD_CHUNK_VERTICES, scratch) != 0 ||
+            vcacheVertexOrder(list, count, LOD_CHUNK_VERTICES, order, scratch) != 0) {
+        arenaPageRestore(scratch, mark);
+        return -1;
+    }
+    for (u32 i = 0; i < LOD_CHUNK_VERTICES; i++) {
+        remap[order[i]] = i;
+    }
+
+    u32 offset = 0;
+    for (u32 l = 0; l < LOD_LEVELS; l++) {
+        for (u32 e = 0; e < LOD_EDGE_VARIANTS; e++) {
+            count = buildTemplateList(list, l, e);
+            for (u32 i = 0; i < count; i++) {
+                list[i] = remap[list[i]];
+            }
+            if(vcacheOptimize(list, count, LOD_CHUNK_VERTICES, scratch) != 0) {
+                arenaPageRestore(scratch, mark);
+                return -1;
+            }
+            for (u32 i = 0; i < count; i++) {
+                lod->indices[offset + i] = (u16)list[i];
+            }
+            lod->ranges[l][e].offset = offset;
+            lod->ranges[l][e].count = count;
+            lod->ranges[l][e].triangles = count / 3;
+            offset += count;
+        }
+    }
+    lod->indexCount = offset;
+    for (u32 i = 0; i < LOD_CHUNK_VERTICES; i++) {
+        lod->vertexOrder[i] = (u16)order[i];
+    }
+    lod->order = LOD_ORDER_CACHE;
+    arenaPageRestore(scratch, mark);
+    return 0;
+}
+
+static f32 vertexDistance(const ZetaVertex* v, f32 re, f32 im, f32 mag) {
+    f32 dx = v->re - re;
+    f32 dy = v->im - im;
+    f32 dz = v->mag - mag;
+    f32 d = sqrtf(dx * dx + dy * dy + dz * dz);
+    return isfinite(d) ? d : FLT_MAX;
+}
+
+//every sample against the bilinear blend of the level's cell around it
+static f32 levelError(const ZetaVertex* grid, u32 pitch, u32 level) {
+    u32 step = 1u << level;
+    f32 error = 0.0f;
+    for (u32 y = 0; y <= LOD_CHUNK; y++) {
+        u32 y0 = (y == LOD_CHUNK) ? LOD_CHUNK - step : y - y % step;
+        f32 fy = (f32)(y - y0) / step;
+        for (u32 x = 0; x <= LOD_CHUNK; x++) {
+            u32 x0 = (x == LOD_CHUNK) ? LOD_CHUNK - step : x - x % step;
+            f32 fx = (f32)(x - x0) / step;
+            const ZetaVertex* a = &grid[y0 * pitch + x0];
+            const ZetaVertex* b = &grid[y0 * pitch + x0 + step];
+            const ZetaVertex* c = &grid[(y0 + step) * pitch + x0];
+            const ZetaVertex* d = &grid[(y0 + step) * pitch + x0 + step];
+            f32 wa = (1.0f - fx) * (1.0f - fy);
+            f32 wb = fx * (1.0f - fy);
+            f32 wc = (1.0f - fx) * fy;
+            f32 wd = fx * fy;
+            f32 re = wa * a->re + wb * b->re + wc * c->re + wd * d->re;
+            f32 im = wa * a->im + wb * b->im + wc * c->im + wd * d->im;
+            f32 mag = wa * a->mag + wb * b->mag + wc * c->mag + wd * d->mag;
+            f32 e = vertexDistance(&grid[y * pitch + x], re, im, mag);
+            error = (e > error) ? e : error;
+        }
+    }
+    return error;
+}
+
+//rounded to the nearest step, NaN lands on 0 and anything outside the box on its faces
+static u16 quantize(f32 value, f32 origin, f32 extent) {
+    f32 q = (extent > 0.0f) ? (value - origin) / extent * LOD_UNORM16_MAX + 0.5f : 0.0f;
+    return (q > 0.0f) ? ((q < LOD_UNORM16_MAX) ? (u16)q : (u16)LOD_UNORM16_MAX) : 0;
+}
+
+static void buildChunks(void* ctx, u32 begin, u32 end) {
+    LodJob* job = ctx;
+    ZetaLod* lod = job->lod;
+    for (u32 c = begin; c < end; c++) {
+        LodChunk* chunk = &lod->chunks[c];
+        const ZetaVertex* base = &job->grid[(c / lod->chunksX) * LOD_CHUNK * lod->w + (c % lod->chunksX) * LOD_CHUNK];
+        u32 pitch = lod->w;
+        //copy the chunk out with its shared edges, then read the compact copy unless it was renumbered
+        if(job->packed && lod->format == LOD_FORMAT_FLOAT && lod->order == LOD_ORDER_CACHE) {
+            ZetaVertex* packed = (ZetaVertex*)job->packed + chunk->baseVertex;
+            for (u32 i = 0; i < LOD_CHUNK_VERTICES; i++) {
+                u32 v = lod->vertexOrder[i];
+                packed[i] = base[(v / LOD_CHUNK_SIDE) * pitch + v % LOD_CHUNK_SIDE];
+            }
+        } else if(job->packed && lod->format == LOD_FORMAT_FLOAT) {
+            ZetaVertex* packed = (ZetaVertex*)job->packed + chunk->baseVertex;
+            for (u32 y = 0; y <= LOD_CHUNK; y++) {
+                memcpy(&packed[y * LOD_CHUNK_SIDE], &base[y * pitch], LOD_CHUNK_SIDE * sizeof(ZetaVertex));
+            }
+            base = packed;
+            pitch = LOD_CHUNK_SIDE;
+        }
+        for (u32 k = 0; k < 3; k++) {
+            chunk->min[k] = FLT_MAX;
+            chunk->max[k] = -FLT_MAX;
+        }
+        for (u32 y = 0; y <= LOD_CHUNK; y++) {
+            for (u32 x = 0; x <= LOD_CHUNK; x++) {
+                const ZetaVertex* v = &base[y * pitch + x];
+                f32 p[3] = { v->re, v->im, v->mag };
+                for (u32 k = 0; k < 3; k++) {
+                    chunk->min[k] = (p[k] < chunk->min[k]) ? p[k] : chunk->min[k];
+                    chunk->max[k] = (p[k] > chunk->max[k]) ? p[k] : chunk->max[k];
+                }
+            }
+        }
+        //an infinite bound can't be decoded, that axis collapses onto a finite origin instead
+        for (u32 k = 0; k < 3; k++) {
+            f32 extent = chunk->max[k] - chunk->min[k];
+            chunk->origin[k] = isfinite(chunk->min[k]) ? chunk->min[k] : 0.0f;
+            chunk->extent[k] = (isfinite(chunk->min[k]) && isfinite(extent)) ? extent : 0.0f;
+        }
+        if(job->packed && lod->format == LOD_FORMAT_UNORM16) {
+            LodVertex* packed = (LodVertex*)job->packed + chunk->baseVertex;
+            for (u32 i = 0; i < LOD_CHUNK_VERTICES; i++) {
+                u32 v = lod->vertexOrder[i];
+                const ZetaVertex* source = &base[(v / LOD_CHUNK_SIDE) * pitch + v % LOD_CHUNK_SIDE];
+                packed[i].pos[0] = quantize(source->re, chunk->origin[0], chunk->extent[0]);
+                packed[i].pos[1] = quantize(source->im, chunk->origin[1], chunk->extent[1]);
+                packed[i].pos[2] = quantize(source->mag, chunk->origin[2], chunk->extent[2]);
+                packed[i].arg = quantize(source->arg, -LOD_ARG_RANGE, 2.0f * LOD_ARG_RANGE);
+            }
+        }
+        //coarser levels never report less error than finer ones
+        chunk->error[0] = 0.0f;
+        for (u32 l = 1; l < LOD_LEVELS; l++) {
+            f32 e = levelError(base, pitch, l);
+            chunk->error[l] = (e > chunk->error[l - 1]) ? e : chunk->error[l - 1];
+        }
+    }
+}
+
+void lodBuild(ZetaLod* lod, const ZetaVertex* vertexGrid, void* packed) {
+    LodJob job = {
+        .lod = lod,
+        .grid = vertexGrid,
+        .packed = packed
+    };
+    parallelFor(lod->chunkCount, 4, buildChunks, &job);
+}
+
+//half a step on every axis, samples outside a finite box are not bounded
+f32 lodQuantizationError(const ZetaLod* lod) {
+    f32 error = 0.0f;
+    for (u32 c = 0; c < lod->chunkCount; c++) {
+        const LodChunk* chunk = &lod->chunks[c];
+        f32 d2 = 0.0f;
+        for (u32 k = 0; k < 3; k++) {
+            f32 half = chunk->extent[k] / (2.0f * LOD_UNORM16_MAX);
+            d2 += half * half;
+        }
+        error = (sqrtf(d2) > error) ? sqrtf(d2) : error;
+    }
+    return error;
+}
+
+static f32 boxDistance(const LodChunk* chunk, const f32* eye) {
+    f32 d2 = 0.0f;
+    for (u32 k = 0; k < 3; k++) {
+        f32 d = (eye[k] < chunk->min[k]) ? chunk->min[k] - eye[k] : (eye[k] > chunk->max[k]) ? eye[k] - chunk->max[k] : 0.0f;
+        d2 += d * d;
+    }
+    return sqrtf(d2);
+}
+
+static u32 chunkLevel(const ZetaLod* lod, u32 cx, u32 cy) {
+    return lod->chunks[cy * lod->chunksX + cx].level;
+}
+
+//lower any chunk more than one level coarser than a neighbour, stitching only covers one step
+static void limitNeighbours(ZetaLod* lod) {
+    u32 changed = 1;
+    while(changed) {
+        changed = 0;
+        for (u32 cy = 0; cy < lod->chunksY; cy++) {
+            for (u32 cx = 0; cx < lod->chunksX; cx++) {
+                LodChunk* chunk = &lod->chunks[cy * lod->chunksX + cx];
+                u32 limit = chunk->level;
+                if(cy > 0 && chunkLevel(lod, cx, cy - 1) + 1 < limit) {
+                    limit = chunkLevel(lod, cx, cy - 1) + 1;
+                }
+                if(cy + 1 < lod->chunksY && chunkLevel(lod, cx, cy + 1) + 1 < limit) {
+                    limit = chunkLevel(lod, cx, cy + 1) + 1;
+                }
+                if(cx > 0 && chunkLevel(lod, cx - 1, cy) + 1 < limit) {
+                    limit = chunkLevel(lod, cx - 1, cy) + 1;
+                }
+                if(cx + 1 < lod->chunksX && chunkLevel(lod, cx + 1, cy) + 1 < limit) {
+                    limit = chunkLevel(lod, cx + 1, cy) + 1;
+                }
+                if(limit != chunk->level) {
+                    chunk->level = limit;
+                    changed = 1;
+                }
+            }
+        }
+    }
+}
+
+//Gribb-Hartmann: each plane is the last row of clip plus or minus one of the others
+void lodFrustumFromMatrix(LodFrustum* frustum, const f32* clip) {
+    for (u32 p = 0; p < 6; p++) {
+        u32 row = p / 2;
+        f32 sign = (p % 2 == 0) ? 1.0f : -1.0f;
+        f32 len2 = 0.0f;
+        for (u32 k = 0; k < 4; k++) {
+            frustum->planes[p][k] = clip[k * 4 + 3] + sign * clip[k * 4 + row];
+            len2 += (k < 3) ? frustum->planes[p][k] * frustum->planes[p][k] : 0.0f;
+        }
+        f32 inv = (len2 > 0.0f) ? 1.0f / sqrtf(len2) : 0.0f;
+        for (u32 k = 0; k < 4; k++) {
+            frustum->planes[p][k] *= inv;
+        }
+    }
+}
+
+//outside when the box corner furthest along a plane's normal is still behind it
+static u32 boxOutside(const LodFrustum* frustum, const LodChunk* chunk) {
+    for (u32 p = 0; p < 6; p++) {
+        const f32* plane = frustum->planes[p];
+        f32 d = plane[3];
+        for (u32 k = 0; k < 3; k++) {
+            d += plane[k] * ((plane[k] >= 0.0f) ? chunk->max[k] : chunk->min[k]);
+        }
+        if(d < 0.0f) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+//coarsest level whose error projects to at most pixelError, returns the index count of the draw list
+u32 lodSelect(ZetaLod* lod, const f32* eye, const LodFrustum* frustum, f32 fovY, f32 viewportHeight, f32 pixelError) {
+    f32 pixelsPerUnit = viewportHeight / (2.0f * tanf(fovY * 0.5f));
+    for (u32 c = 0; c < lod->chunkCount; c++) {
+        LodChunk* chunk = &lod->chunks[c];
+        f32 allowed = pixelError * boxDistance(chunk, eye) / pixelsPerUnit;
+        chunk->level = 0;
+        for (u32 l = LOD_LEVELS - 1; l > 0; l--) {
+            if(chunk->error[l] <= allowed) {
+                chunk->level = l;
+                break;
+            }
+        }
+    }
+    limitNeighbours(lod);
+
+    //culled chunks keep their level so visible neighbours still stitch against it
+    LodStats* stats = &lod->stats;
+    stats->chunks = lod->chunkCount;
+    stats->culled = 0;
+    stats->fullTriangles = (u64)lod->chunkCount * lod->ranges[0][0].triangles;
+    stats->lodTriangles = 0;
+    stats->drawnTriangles = 0;
+    lod->drawCount = 0;
+    lod->drawnIndices = 0;
+    for (u32 cy = 0; cy < lod->chunksY; cy++) {
+        for (u32 cx = 0; cx < lod->chunksX; cx++) {
+            const LodChunk* chunk = &lod->chunks[cy * lod->chunksX + cx];
+            u32 coarser = chunk->level + 1;
+            u32 edges = 0;
+            edges |= (cy > 0 && chunkLevel(lod, cx, cy - 1) == coarser) ? LOD_EDGE_TOP : 0;
+            edges |= (cx + 1 < lod->chunksX && chunkLevel(lod, cx + 1, cy) == coarser) ? LOD_EDGE_RIGHT : 0;
+            edges |= (cy + 1 < lod->chunksY && chunkLevel(lod, cx, cy + 1) == coarser) ? LOD_EDGE_BOTTOM : 0;
+            edges |= (cx > 0 && chunkLevel(lod, cx - 1, cy) == coarser) ? LOD_EDGE_LEFT : 0;
+            const LodRange* range = &lod->ranges[chunk->level][edges];
+            stats->lodTriangles += range->triangles;
+            if(frustum && boxOutside(frustum, chunk)) {
+                stats->culled++;
+                continue;
+            }
+            LodDraw* draw = &lod->draws[lod->drawCount++];
+            draw->offset = range->offset;
+            draw->count = range->count;
+            draw->baseVertex = chunk->baseVertex;
+            draw->chunk = cy * lod->chunksX + cx;
+            lod->drawnIndices += range->count;
+            stats->drawnTriangles += range->triangles;
+        }
+    }
+    stats->drawCalls = lod->drawCount;
+    return lod->drawnIndices;
+}
+
+void lodReport(const ZetaLod* lod, FILE* out) {
+    const LodStats* stats = &lod->stats;
+    f64 full = (stats->fullTriangles > 0) ? (f64)stats->fullTriangles : 1.0;
+    fprintf(out, "INFO: LOD %u/%u chunks drawn, %u culled\n", stats->drawCalls, stats->chunks, stats->culled);
+    fprintf(out, "  %-16s %12llu %8.2f%%\n", "full triangles", (unsigned long long)stats->fullTriangles, 100.0);
+    fprintf(out, "  %-16s %12llu %8.2f%%\n", "after LOD", (unsigned long long)stats->lodTriangles,
+            100.0 * stats->lodTriangles / full);
+    fprintf(out, "  %-16s %12llu %8.2f%%\n", "after culling", (unsigned long long)stats->drawnTriangles,
+            100.0 * stats->drawnTriangles / full);
+}
@@ -0,0 +1,132 @@
+#ifndef zeta_LOD_H
+#define zeta_LOD_H
+
+#include <stdio.h>
+#include "common_types.h"
+#include "page_arena.h"
+#include "zeta.h"
+
+//cells per chunk side, LOD_LEVELS = log2(LOD_CHUNK) + 1 so the coarsest level is one quad
+#define LOD_CHUNK 32
+#define LOD_LEVELS 6
+#define LOD_EDGE_VARIANTS 16
+//each chunk owns its own (LOD_CHUNK + 1)^2 vertices so template indices fit in 16 bits
+#define LOD_CHUNK_SIDE (LOD_CHUNK + 1)
+#define LOD_CHUNK_VERTICES (LOD_CHUNK_SIDE * LOD_CHUNK_SIDE)
+//templates are one triangle strip per row of quads, rows split by the restart index
+#define LOD_RESTART 0xFFFF
+//quantized arg covers [-LOD_ARG_RANGE, LOD_ARG_RANGE], atan2f's output
+#define LOD_ARG_RANGE 3.14159265f
+#define LOD_UNORM16_MAX 65535.0f
+//largest screen-space error in pixels a chunk may show before it drops to a finer level
+#define LOD_PIXEL_ERROR 2.0f
+
+//set when the neighbour on that side is one level coarser, the edge then snaps to its vertices
+typedef enum LodEdge {
+    LOD_EDGE_TOP    = 1 << 0,
+    LOD_EDGE_RIGHT  = 1 << 1,
+    LOD_EDGE_BOTTOM = 1 << 2,
+    LOD_EDGE_LEFT   = 1 << 3
+} LodEdge;
+
+//strips are the fewest indices, cache order is Forsyth-ordered lists over a chunk renumbered for fetch locality
+typedef enum LodOrder {
+    LOD_ORDER_STRIPS,
+    LOD_ORDER_CACHE
+} LodOrder;
+
+//float uploads ZetaVertex as is, unorm16 uploads LodVertex at half the size
+typedef enum LodFormat {
+    LOD_FORMAT_FLOAT,
+    LOD_FORMAT_UNORM16
+} LodFormat;
+
+//re, im, mag as fractions of the chunk's origin + extent box, arg as a fraction of the arg range,
+//decoded by the vertex shader from normalized attributes
+typedef struct LodVertex {
+    u16 pos[3];
+    u16 arg;
+} LodVertex;
+
+typedef struct LodRange {
+    u32 offset;
+    u32 count;
+    u32 triangles;
+} LodRange;
+
+//bounds in vertex space (re, im, mag), error[l] is the largest distance any sample moves at level l,
+//origin and extent are the finite box unorm16 positions are relative to
+typedef struct LodChunk {
+    f32 min[3];
+    f32 max[3];
+    f32 origin[3];
+    f32 extent[3];
+    f32 error[LOD_LEVELS];
+    u32 baseVertex;
+    u32 level;
+} LodChunk;
+
+//planes as (a, b, c, d) with a*x + b*y + c*z + d >= 0 inside
+typedef struct LodFrustum {
+    f32 planes[6][4];
+} LodFrustum;
+
+//what the last lodSelect drew against what the full mesh and the unculled LOD mesh would have cost
+typedef struct LodStats {
+    u32 chunks;
+    u32 culled;
+    u32 drawCalls;
+    u64 fullTriangles;
+    u64 lodTriangles;
+    u64 drawnTriangles;
+} LodStats;
+
+typedef struct LodDraw {
+    u32 offset;
+    u32 count;
+    u32 baseVertex;
+    u32 chunk;
+} LodDraw;
+
+//one shared set of strip templates over a chunk's own vertices, each chunk drawn with its base vertex
+typedef struct ZetaLod {
+    u32 w;
+    u32 h;
+    u32 chunksX;
+    u32 chunksY;
+    u32 chunkCount;
+    u32 drawCount;
+    u32 drawnIndices;
+    u32 indexCount;
+    u32 vertexCount;
+    u32 order;
+    u32 format;
+    LodChunk* chunks;
+    LodDraw* draws;
+    u16* indices;
+    LodStats stats;
+    LodRange ranges[LOD_LEVELS][LOD_EDGE_VARIANTS];
+    //packed vertex i of a chunk is grid sample vertexOrder[i] = y * LOD_CHUNK_SIDE + x
+    u16 vertexOrder[LOD_CHUNK_VERTICES];
+} ZetaLod;
+
+u32 lodGridSize(u32 n);
+usize lodTemplateCapacity(void);
+//vertices the surface buffer holds for a w x h grid, chunk-major with shared edges repeated when LOD applies
+usize lodVertexCount(u32 w, u32 h);
+i32 lodInit(ZetaLod* lod, PageArena* arena, u32 w, u32 h);
+//switch the templates to LOD_ORDER_CACHE before lodBuild packs anything, scratch only holds temporaries
+i32 lodCacheOptimize(ZetaLod* lod, PageArena* scratch);
+usize lodVertexSize(u32 format);
+//packed receives lod->vertexCount chunk-major vertices in lod->format for upload, NULL to only compute bounds and errors,
+//set format before building
+void lodBuild(ZetaLod* lod, const ZetaVertex* vertexGrid, void* packed);
+//largest distance a unorm16 vertex lands from its float position, over every chunk
+f32 lodQuantizationError(const ZetaLod* lod);
+//clip is projection * view, column major as linmath stores it
+void lodFrustumFromMatrix(LodFrustum* frustum, const f32* clip);
+//frustum may be NULL to draw every chunk
+u32 lodSelect(ZetaLod* lod, const f32* eye, const LodFrustum* frustum, f32 fovY, f32 viewportHeight, f32 pixelError);
+void lodReport(const ZetaLod* lod, FILE* out);
+
+#endif
@@ -5,10 +5,22 @@
 #include "arena_base.h"
 #include "page_arena.h"
 #include "scratch_arena.h"
+#include "arena_stats.h"
 #include "zeta.h"
+#include "parallel.h"
+#include "expr.h"
+#include "plugin.h"
+#include "sampling.h"
+#include "pyramid.h"
+#include "contour.h"
+#include "plan.h"
+#include "lod.h"
+#include "colormap.h"
 #include <stdio.h>
 #include <stddef.h>
+#include <string.h>
 #include "shaders.h"
+#include "render_state.h"
 #include "linmath.h"
 #include "camera.h"
 
@@ -17,13 +29,19 @@
 //#endif
 
 #define PAGE_SPACE_SIZE MiB(10)
+#define PAGE_RESERVE_SIZE ((usize)64 * MiB(1024))
 #define SCRATCH_SIZE 1024 * 128
-#define ARENA_SIZE MiB(1)
+#define ARENA_SIZE MiB(4)
+#define WORKER_SCRATCH_SIZE 1024 * 32
 #define SCREEN_WIDTH 1280
 #define SCREEN_HEIGHT 960
 #define TRUE 1
 #define FALSE 0
 
+//GL_TIME_ELAPSED queries in flight, results are read this many frames later so nothing stalls
+#define FRAME_QUERIES 4
+#define WIRE_WIDTH 1.5f
+#define NO_CHUNK 0xFFFFFFFFu
 #define ZETA_INDEX_COUNT(w, h) (((h) - 1) * ((w) - 1) * 6)
 
 f32 deltaTime;
@@ -31,27 +49,311 @@ f32 lastFrame;
 f32 currentFrame;
 f32 lastPress;
 f32 lastPressWire;
+f32 lastPressContour;
+f32 lastPressStats;
+f32 lastPressPalette;
 u32 mouseFirst;
 Camera *cam;
-u8 isLine;
 u8 isPoints;
+u8 showContours;
 u32 grid_w;
 u32 grid_h;
 u32 indexCount;
+u32 vertexCount;
+ZetaLod* surfaceLod;
+f32 lodPixelError;
+int windowWidth;
+int windowHeight;
+RenderState renderState;
+
+//K cycles through these, the shader wireframe is the startup default and polygon lines are kept to compare against
+typedef enum WireMode {
+    WIRE_SHADER,
+    WIRE_OVERLAY,
+    WIRE_FILL,
+    WIRE_POLYGON,
+    WIRE_MODES
+} WireMode;
+
+static const char* wireModeNames[WIRE_MODES] = { "shader wire", "wire overlay", "filled", "polygon lines" };
+u32 wireMode;
+f32 wireWidth;
+u32 palette;
+
+//the fill and wireframe programs share the vertex shader, so both carry the decode uniforms,
+//boxChunk is the chunk whose box is loaded so a repeat is skipped
+typedef struct SurfaceProgram {
+    GLuint id;
+    GLint posOrigin;
+    GLint posExtent;
+    GLint argRange;
+    u32 boxChunk;
+} SurfaceProgram;
+
+SurfaceProgram* activeSurface;
+
+//cpu time is the whole frame and capped by vsync, gpu time covers only the surface draws
+typedef struct FrameStats {
+    u32 frames[WIRE_MODES];
+    f64 cpuSeconds[WIRE_MODES];
+    u32 gpuFrames[WIRE_MODES];
+    f64 gpuSeconds[WIRE_MODES];
+    GLuint queries[FRAME_QUERIES];
+    u32 queryMode[FRAME_QUERIES];
+    u32 frame;
+} FrameStats;
+
+FrameStats frameStats;
 
 typedef void (*RenderFunc)(void);
 RenderFunc renderFunc;
 
+void initSurfaceProgram(SurfaceProgram* program, GLuint id, u32 quantized) {
+    program->id = id;
+    program->boxChunk = NO_CHUNK;
+    program->posOrigin = glGetUniformLocation(id, "posOrigin");
+    program->posExtent = glGetUniformLocation(id, "posExtent");
+    program->argRange = glGetUniformLocation(id, "argRange");
+    renderBindFrameBlock(id);
+    //float vertices decode as they are, the box only changes per chunk for unorm16
+    glUseProgram(id);
+    glUniform3f(program->posOrigin, 0.f, 0.f, 0.f);
+    glUniform3f(program->posExtent, 1.f, 1.f, 1.f);
+    if(quantized) {
+        glUniform2f(program->argRange, -LOD_ARG_RANGE, 2.f * LOD_ARG_RANGE);
+    } else {
+        glUniform2f(program->argRange, 0.f, 1.f);
+    }
+    //the colormap array stays bound to unit 0, switching palettes only changes the layer
+    glUniform1i(glGetUniformLocation(id, "colormap"), 0);
+    glUniform2f(glGetUniformLocation(id, "colormapRange"), COLORMAP_LOG2_MIN, 1.f / (COLORMAP_LOG2_MAX - COLORMAP_LOG2_MIN));
+}
+
+//collects the query issued FRAME_QUERIES frames ago before reusing its slot
+void frameStatsBegin(FrameStats* stats, u32 mode) {
+    u32 slot = stats->frame % FRAME_QUERIES;
+    if(stats->frame >= FRAME_QUERIES) {
+        GLuint64 nanoseconds = 0;
+        glGetQueryObjectui64v(stats->queries[slot], GL_QUERY_RESULT, &nanoseconds);
+        RENDER_COUNT(&renderState, RENDER_CALL_QUERY);
+        stats->gpuFrames[stats->queryMode[slot]]++;
+        stats->gpuSeconds[stats->queryMode[slot]] += nanoseconds * 1e-9;
+    }
+    stats->queryMode[slot] = mode;
+    glBeginQuery(GL_TIME_ELAPSED, stats->queries[slot]);
+    RENDER_COUNT(&renderState, RENDER_CALL_QUERY);
+}
+
+void frameStatsEnd(FrameStats* stats, u32 mode, f32 frameSeconds) {
+    glEndQuery(GL_TIME_ELAPSED);
+    RENDER_COUNT(&renderState, RENDER_CALL_QUERY);
+    stats->frames[mode]++;
+    stats->cpuSeconds[mode] += frameSeconds;
+    stats->frame++;
+}
+
+void frameStatsReport(const FrameStats* stats, FILE* out) {
+    fprintf(out, "INFO: surface frame times, %.1f px lines\n", wireWidth);
+    fprintf(out, "  %-16s %8s %12s %12s\n", "mode", "frames", "frame ms", "surface ms");
+    for (u32 m = 0; m < WIRE_MODES; m++) {
+        if(stats->frames[m] == 0) {
+            continue;
+        }
+        f64 gpu = stats->gpuFrames[m] ? stats->gpuSeconds[m] * 1e3 / stats->gpuFrames[m] : 0.0;
+        fprintf(out, "  %-16s %8u %12.3f %12.3f\n", wireModeNames[m], stats->frames[m], 
+                stats->cpuSeconds[m] * 1e3 / stats->frames[m], gpu);
+    }
+}
+
+//unorm16 positions are relative to their chunk's box
+static void setChunkBox(u32 c) {
+    if(activeSurface->boxChunk == c) {
+        renderState.skipped++;
+        return;
+    }
+    glUniform3fv(activeSurface->posOrigin, 1, surfaceLod->chunks[c].origin);
+    glUniform3fv(activeSurface->posExtent, 1, surfaceLod->chunks[c].extent);
+    renderState.calls[RENDER_CALL_UNIFORM] += 2;
+    activeSurface->boxChunk = c;
+}
+
 void drawAsPoints(void) {
-    glDrawArrays(GL_POINTS, 0, grid_w * grid_h);
+    if(!surfaceLod || surfaceLod->format != LOD_FORMAT_UNORM16) {
+        glDrawArrays(GL_POINTS, 0, vertexCount);
+        RENDER_COUNT(&renderState, RENDER_CALL_DRAW);
+        return;
+    }
+    for (u32 c = 0; c < surfaceLod->chunkCount; c++) {
+        setChunkBox(c);
+        glDrawArrays(GL_POINTS, surfaceLod->chunks[c].baseVertex, LOD_CHUNK_VERTICES);
+        RENDER_COUNT(&renderState, RENDER_CALL_DRAW);
+    }
 }
 
+//one draw per chunk at the level lodSelect picked this frame, the full index buffer only without LOD
 void drawAsSurface(void) {
-    glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
+    if(!surfaceLod) {
+        glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
+        RENDER_COUNT(&renderState, RENDER_CALL_DRAW);
+        return;
+    }
+    u32 strips = (surfaceLod->order == LOD_ORDER_STRIPS);
+    u32 quantized = (surfaceLod->format == LOD_FORMAT_UNORM16);
+    renderPrimitiveRestart(&renderState, strips, LOD_RESTART);
+    for (u32 i = 0; i < surfaceLod->drawCount; i++) {
+        const LodDraw* draw = &surfaceLod->draws[i];
+        if(quantized) {
+            setChunkBox(draw->chunk);
+        }
+        glDrawElementsBaseVertex(strips ? GL_TRIANGLE_STRIP : GL_TRIANGLES, draw->count, GL_UNSIGNED_SHORT, 
+                (void*)((usize)draw->offset * sizeof(u16)), draw->baseVertex);
+        RENDER_COUNT(&renderState, RENDER_CALL_DRAW);
+    }
+}
+
+void uploadContour(const ContourLines* lines, GLuint* vao, GLuint* vbo, GLuint* ebo) {
+    glGenVertexArrays(1, vao);
+    glGenBuffers(1, vbo);
+    glGenBuffers(1, ebo);
+    glBindVertexArray(*vao);
+    glBindBuffer(GL_ARRAY_BUFFER, *vbo);
+    glBufferData(GL_ARRAY_BUFFER, lines->vertexCount * sizeof(ZetaVertex), lines->vertices, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(ZetaVertex), (void*)0);
+    glEnableVertexAttribArray(0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, *ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, lines->indexCount * sizeof(u32), lines->indices, GL_STATIC_DRAW);
+}
+
+//bakes one layer at a time through scratch, arg wraps around and the length clamps at both ends
+GLuint uploadColormap(PageArena* scratch) {
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, COLORMAP_WIDTH, COLORMAP_HEIGHT, COLORMAP_PALETTES, 0, 
+            GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    ArenaMark mark = arenaPageSave(scratch);
+    u8* layer = arenaPageAlloc(scratch, COLORMAP_LAYER_BYTES, ALIGN_16);
+    for (u32 p = 0; layer && p < COLORMAP_PALETTES; p++) {
+        if(colormapBake(layer, p) == 0) {
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, p, COLORMAP_WIDTH, COLORMAP_HEIGHT, 1, 
+                    GL_RGBA, GL_UNSIGNED_BYTE, layer);
+        }
+    }
+    if(!layer) {
+        LOG_ERROR("No room to bake the colormaps, surface will be black");
+    }
+    arenaPageRestore(scratch, mark);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    return texture;
+}
+
+typedef struct ComputeStages {
+    ZetaPoint* points;
+    ZetaVertex* vertices;
+    void* packed;
+    u32* indices;
+    ZetaLod* lod;
+    const SampleLattice* lattice;
+    ComplexRowFunc rowFunc;
+    void* rowCtx;
+    f32 sigmaMin;
+    f32 sigmaMax;
+    f32 tMin;
+    f32 tMax;
+    ZetaPyramid* pyramid;
+    ContourField* contours;
+} ComputeStages;
+
+void evaluateStage(Job* job, void* ctx, u32 begin, u32 end) {
+    ComputeStages* stages = ctx;
+    if(stages->lattice) {
+        populateMeshLattice(stages->points, stages->vertices, stages->lattice, stages->rowFunc, stages->rowCtx);
+    } else {
+        populateMeshRows(stages->points, stages->vertices, grid_w, grid_h, stages->sigmaMin, stages->sigmaMax, 
+                stages->tMin, stages->tMax, stages->rowFunc, stages->rowCtx);
+    }
+}
+
+void meshStage(Job* job, void* ctx, u32 begin, u32 end) {
+    ComputeStages* stages = ctx;
+    if(stages->lod) {
+        lodBuild(stages->lod, stages->vertices, stages->packed);
+    } else if(stages->lattice) {
+        generateMeshLattice(stages->indices, stages->vertices, grid_w, grid_h);
+    } else {
+        generateMesh(stages->indices, grid_w, grid_h);
+    }
+}
+
+void pyramidStage(Job* job, void* ctx, u32 begin, u32 end) {
+    ComputeStages* stages = ctx;
+    if(stages->pyramid) {
+        pyramidBuild(stages->pyramid, stages->points);
+    }
+}
+
+void contourStage(Job* job, void* ctx, u32 begin, u32 end) {
+    ComputeStages* stages = ctx;
+    if(stages->contours) {
+        contourExtract(stages->contours, stages->points, stages->vertices);
+    }
+}
+
+void zeroStage(Job* job, void* ctx, u32 begin, u32 end) {
+    ComputeStages* stages = ctx;
+    if(stages->pyramid) {
+        u32 candidates = pyramidZeroCandidates(stages->pyramid, stages->points, 0.1f, NULL, 0);
+        fprintf(stdout, "INFO: %u zero candidate cells with |f| < 0.1\n", candidates);
+    }
+    if(stages->contours) {
+        for (u32 k = 0; k < stages->contours->zeroCount; k++) {
+            fprintf(stdout, "INFO: Re = Im = 0 crossing near s = %f + %fi\n", 
+                    stages->contours->zeros[k].sigma, stages->contours->zeros[k].t);
+        }
+    }
+}
+
+//evaluate, then LOD or indices, pyramid and contours side by side, then the zero report; uploads stay on this thread
+void runComputeGraph(ComputeStages* stages) {
+    Job* evaluate = jobCreate(NULL, evaluateStage, stages, 0, 0);
+    Job* mesh = jobCreate(NULL, meshStage, stages, 0, 0);
+    Job* pyramid = jobCreate(NULL, pyramidStage, stages, 0, 0);
+    Job* contours = jobCreate(NULL, contourStage, stages, 0, 0);
+    Job* zeros = jobCreate(NULL, zeroStage, stages, 0, 0);
+    if(!evaluate || !mesh || !pyramid || !contours || !zeros) {
+        Job* created[] = { evaluate, mesh, pyramid, contours, zeros };
+        for (u32 k = 0; k < 5; k++) {
+            if(created[k]) {
+                jobDiscard(created[k]);
+            }
+        }
+        evaluateStage(NULL, stages, 0, 0);
+        meshStage(NULL, stages, 0, 0);
+        pyramidStage(NULL, stages, 0, 0);
+        contourStage(NULL, stages, 0, 0);
+        zeroStage(NULL, stages, 0, 0);
+        return;
+    }
+    jobDepend(mesh, evaluate);
+    jobDepend(pyramid, evaluate);
+    jobDepend(contours, evaluate);
+    jobDepend(zeros, mesh);
+    jobDepend(zeros, pyramid);
+    jobDepend(zeros, contours);
+    jobSubmit(zeros);
+    jobSubmit(contours);
+    jobSubmit(pyramid);
+    jobSubmit(mesh);
+    jobSubmit(evaluate);
+    jobWait(zeros);
 }
 
 void scroll_callback(GLFWwindow *window, f64 xOffset, f64 yOffset) {
     ProcessMouseScroll(cam, yOffset);
+    renderState.dirty |= RENDER_DIRTY_PROJECTION;
 }
 
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode) {
@@ -63,28 +365,61 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 void processInput(GLFWwindow *window) {
     if(glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) {
         ProcessKeyboard(cam, FORWARD, deltaTime);
+        renderState.dirty |= RENDER_DIRTY_VIEW;
     }
     if(glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) {
         ProcessKeyboard(cam, BACKWARD, deltaTime);
+        renderState.dirty |= RENDER_DIRTY_VIEW;
     }
     if(glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) {
         ProcessKeyboard(cam, LEFT, deltaTime);
+        renderState.dirty |= RENDER_DIRTY_VIEW;
     }
     if(glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) {
         ProcessKeyboard(cam, RIGHT, deltaTime);
+        renderState.dirty |= RENDER_DIRTY_VIEW;
+    }
+    //[ and ] thin and widen the shader wireframe's lines
+    if(glfwGetKey(window, GLFW_KEY_LEFT_BRACKET) == GLFW_PRESS) {
+        wireWidth = (wireWidth - 4.0f * deltaTime > 0.5f) ? wireWidth - 4.0f * deltaTime : 0.5f;
+    }
+    if(glfwGetKey(window, GLFW_KEY_RIGHT_BRACKET) == GLFW_PRESS) {
+        wireWidth = (wireWidth + 4.0f * deltaTime < 8.0f) ? wireWidth + 4.0f * deltaTime : 8.0f;
     }
     if(glfwGetKey(window, GLFW_KEY_K) == GLFW_PRESS) {
         if (lastPressWire < 1) {
             return;
         }
         lastPressWire = 0.0f;
-        if(isLine) {
-            glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-            isLine = !isLine;
-        } else {
-            glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-            isLine = !isLine;
+        wireMode = (wireMode + 1) % WIRE_MODES;
+        renderPolygonMode(&renderState, (wireMode == WIRE_POLYGON) ? GL_LINE : GL_FILL);
+        fprintf(stdout, "INFO: surface drawn as %s\n", wireModeNames[wireMode]);
+    }
+    if(glfwGetKey(window, GLFW_KEY_L) == GLFW_PRESS) {
+        if (lastPressContour < 1) {
+            return;
         }
+        lastPressContour = 0.0f;
+        showContours = !showContours;
+    }
+    if(glfwGetKey(window, GLFW_KEY_I) == GLFW_PRESS) {
+        if (lastPressStats < 1) {
+            return;
+        }
+        lastPressStats = 0.0f;
+        if(surfaceLod) {
+            lodReport(surfaceLod, stdout);
+        }
+        frameStatsReport(&frameStats, stdout);
+        renderStatsReport(&renderState, stdout);
+    }
+    if(glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS) {
+        if (lastPressPalette < 1) {
+            return;
+        }
+        lastPressPalette = 0.0f;
+        palette = (palette + 1) % COLORMAP_PALETTES;
+        fprintf(stdout, "INFO: %s palette\n", colormapName(palette));
     }
     if(glfwGetKey(window, GLFW_KEY_M) == GLFW_PRESS) {
         if (lastPress < 1) {
@@ -113,6 +448,7 @@ void mouse_callback(GLFWwindow* window, f64 xpos, f64 ypos) {
     cam->lastX = xpos;
     cam->lastY = ypos;
     ProcessMouseMovement(cam, xOffset, yOffset, TRUE);
+    renderState.dirty |= RENDER_DIRTY_VIEW;
 }
 
 void error_callback(int error, const char *description) {
@@ -121,18 +457,68 @@ void error_callback(int error, const char *description) {
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
     glViewport(0, 0, width, height);
+    windowWidth = width;
+    windowHeight = height;
+    renderState.dirty |= RENDER_DIRTY_PROJECTION;
 }
 
 int main() {
-    int width = SCREEN_WIDTH;
-    int height = SCREEN_HEIGHT;
+    windowWidth = SCREEN_WIDTH;
+    windowHeight = SCREEN_HEIGHT;
     mouseFirst = TRUE;
-    isLine = TRUE;
+    wireMode = WIRE_SHADER;
     isPoints = TRUE;
 
-    memMap *map = initMemMap(PAGE_SPACE_SIZE);
+    parallelInit(0);
+
+    //ZETA_VERTEX_FORMAT=unorm16 uploads the surface at 8 bytes a vertex, quantized to each chunk's bounds
+    const char* formatName = getenv("ZETA_VERTEX_FORMAT");
+    u32 vertexFormat = (formatName && strcmp(formatName, "unorm16") == 0) ? LOD_FORMAT_UNORM16 : LOD_FORMAT_FLOAT;
+
+    //ZETA_BUDGET_MIB=n picks the densest grid whose buffers fit in n MiB, before anything is allocated
+    grid_w = 100;
+    grid_h = 100;
+    usize meshArenaSize = ARENA_SIZE;
+    const char* budget = getenv("ZETA_BUDGET_MIB");
+    if(budget) {
+        const char* planSampling = getenv("ZETA_SAMPLING");
+        PlanRequest request = {
+            .budget = (usize)strtoul(budget, NULL, 10) * MiB(1),
+            .aspect = 1.0f,
+            .evaluator = getenv("ZETA_PLUGIN") ? PLAN_EVAL_PLUGIN : getenv("ZETA_EXPR") ? PLAN_EVAL_EXPR : PLAN_EVAL_ZETA,
+            .warped = planSampling && strcmp(planSampling, "warped") == 0,
+            .vertexFormat = vertexFormat,
+            .workers = parallelWorkerCount(),
+            .workerScratch = WORKER_SCRATCH_SIZE
+        };
+        GridPlan plan;
+        if(planGrid(&plan, &request) == 0) {
+            planReport(&plan, stdout);
+            grid_w = plan.w;
+            grid_h = plan.h;
+            meshArenaSize = plan.meshArenaSize;
+        }
+    }
+    //the surface is drawn in chunks of LOD_CHUNK cells, trim the grid to whole chunks
+    grid_w = lodGridSize(grid_w);
+    grid_h = lodGridSize(grid_h);
+
+    //reserve address space up front and only pay for the pages the grid touches
+    memMap *map = initMemMapReserve(PAGE_RESERVE_SIZE);
+    if(!map) {
+        map = initMemMap(meshArenaSize + MiB(4) > PAGE_SPACE_SIZE ? meshArenaSize + MiB(4) : PAGE_SPACE_SIZE);
+    }
     PageArena *scratch = createPageArena(map, SCRATCH_SIZE);
-    PageArena *arena = createPageArena(map, ARENA_SIZE);
+    ARENA_NAME(scratch, "camera");
+    PageArena *arena = createPageArenaHuge(map, meshArenaSize);
+    if(arena) {
+        fprintf(stdout, "INFO: mesh arena backed by %s\n", pageBackingName(arena->backing));
+        ARENA_NAME(arena, "mesh");
+    }
+    static ScratchPool workerScratch;
+    if(arena && scratchPoolInit(&workerScratch, arena, parallelWorkerCount(), WORKER_SCRATCH_SIZE) == 0) {
+        parallelSetScratch(&workerScratch);
+    }
    
     cam = arenaPageAlloc(scratch, sizeof(Camera), ALIGN_4);
     CameraInit(cam, (vec3){1.f, 1.f, 5.f}, (vec3){0.f, 1.f, 0.f}, YAW, PITCH);
@@ -161,7 +547,7 @@ int main() {
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
     glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
 
-    GLFWwindow *window = glfwCreateWindow(width, height, "OpenGL Lighting 3", NULL, NULL);
+    GLFWwindow *window = glfwCreateWindow(windowWidth, windowHeight, "OpenGL Lighting 3", NULL, NULL);
     if(!window) {
         fprintf(stderr, "ERROR: Failed to initialize window.\n");
         glfwTerminate();
@@ -178,100 +564,250 @@ int main() {
     glfwSetScrollCallback(window, scroll_callback);
     glfwSetCursorPosCallback(window, mouse_callback);
     gladLoadGL(glfwGetProcAddress);
-    glfwSwapInterval(1);
+    glfwGetFramebufferSize(window, &windowWidth, &windowHeight);
+    //ZETA_VSYNC=0 lets frame times drop below the refresh interval when comparing wireframe modes
+    const char* vsync = getenv("ZETA_VSYNC");
+    glfwSwapInterval((vsync && strcmp(vsync, "0") == 0) ? 0 : 1);
 
     glEnable(GL_DEPTH_TEST);
-    glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+    //ZETA_WIRE_WIDTH=n starts the shader wireframe at n pixel lines
+    const char* wireWidthEnv = getenv("ZETA_WIRE_WIDTH");
+    wireWidth = wireWidthEnv ? strtof(wireWidthEnv, NULL) : WIRE_WIDTH;
+    wireWidth = (wireWidth > 0.5f) ? wireWidth : 0.5f;
+    //ZETA_PALETTE=hsv|cyclic|bands picks the startup colormap, P cycles them
+    const char* paletteName = getenv("ZETA_PALETTE");
+    palette = paletteName ? colormapFind(paletteName) : COLORMAP_HSV;
+    if(palette == COLORMAP_PALETTES) {
+        LOG_ERROR("No palette named %s, using hsv", paletteName);
+        palette = COLORMAP_HSV;
+    }
 
     f32 sigma_max = 1.0f;
     f32 sigma_min = 0.5f;
     f32 t_min = 5;
     f32 t_max = 15;
-    grid_w = 100;
-    grid_h = 100;
     ZetaPoint *zetaPoints = arenaPageAlloc(arena, grid_w * grid_h * sizeof(ZetaPoint),  ALIGN_16);
     ZetaVertex* zetaVertices = arenaPageAlloc(arena, grid_w * grid_h * sizeof(ZetaVertex), ALIGN_16);
-    populateMesh(zetaPoints, zetaVertices, grid_w, grid_h, sigma_min, sigma_max, t_min, t_max, zetaApprox);
-    
-    u32* indices = arenaPageAlloc(arena, (grid_h - 1) * (grid_w - 1) * 6 * sizeof(u32), ALIGN_4);
-    generateMesh(indices, grid_w, grid_h);
-    indexCount = ZETA_INDEX_COUNT(grid_w, grid_h);
+    //ZETA_PLUGIN=name picks a discovered kernel, ZETA_EXPR="..." a user expression in s, e.g. "exp(i*s)"
+    static PluginRegistry plugins;
+    const char* pluginDir = getenv("ZETA_PLUGIN_DIR");
+    pluginDiscover(&plugins, pluginDir ? pluginDir : "plugins");
+    const char* pluginName = getenv("ZETA_PLUGIN");
+    ZetaPlugin* plugin = pluginName ? pluginFind(&plugins, pluginName) : NULL;
+    if(pluginName && !plugin) {
+        LOG_ERROR("No plugin named %s, falling back", pluginName);
+    }
+
+    const char* exprSource = getenv("ZETA_EXPR");
+    ExprProgram exprProgram;
+    ComplexRowFunc rowFunc = zetaApproxRow;
+    void* rowCtx = NULL;
+    if(plugin) {
+        rowFunc = pluginRow;
+        rowCtx = plugin;
+    } else if(exprSource && exprCompile(&exprProgram, exprSource) == 0) {
+        rowFunc = exprRow;
+        rowCtx = &exprProgram;
+    }
+
+    //ZETA_SAMPLING=warped spends the same samples near sigma = 1/2 and in step with zero density
+    const char* sampling = getenv("ZETA_SAMPLING");
+    static ZetaLod lod;
+    surfaceLod = (lodInit(&lod, arena, grid_w, grid_h) == 0) ? &lod : NULL;
+    lod.format = vertexFormat;
+    //ZETA_INDEX_ORDER=cache trades the strips for vertex-cache ordered lists, see bench/bench_vcache.c
+    const char* indexOrder = getenv("ZETA_INDEX_ORDER");
+    if(surfaceLod && indexOrder && strcmp(indexOrder, "cache") == 0 && lodCacheOptimize(&lod, scratch) != 0) {
+        LOG_ERROR("Keeping strip templates");
+    }
+    u32* indices = surfaceLod ? NULL : arenaPageAlloc(arena, (grid_h - 1) * (grid_w - 1) * 6 * sizeof(u32), ALIGN_4);
+    //ZETA_LOD_PIXELS=n sets how many pixels of error a chunk may show before it refines
+    const char* lodPixels = getenv("ZETA_LOD_PIXELS");
+    lodPixelError = lodPixels ? strtof(lodPixels, NULL) : LOD_PIXEL_ERROR;
+    SampleLattice lattice;
+    AxisMap sigmaAxis, tAxis;
+    axisCritical(&sigmaAxis, sigma_min, sigma_max, 0.5f, 0.05f, 4.0f);
+    axisZeroDensity(&tAxis, t_min, t_max, 0.05f);
+    u32 warped = sampling && strcmp(sampling, "warped") == 0 && 
+            latticeInit(&lattice, arena, grid_w, grid_h, &sigmaAxis, &tAxis) == 0;
+    indexCount = surfaceLod ? lod.indexCount : ZETA_INDEX_COUNT(grid_w, grid_h);
+    vertexCount = (u32)lodVertexCount(grid_w, grid_h);
+
+    ZetaPyramid pyramid;
+    u32 hasPyramid = (pyramidInit(&pyramid, arena, grid_w, grid_h) == 0);
+
+    //contour working buffers and the chunk-major surface copy are only needed until they reach the GPU
+    ArenaMark uploadMark = arenaPageSave(arena);
+    usize vertexSize = surfaceLod ? lodVertexSize(lod.format) : sizeof(ZetaVertex);
+    void* packedVertices = surfaceLod ? arenaPageAlloc(arena, vertexCount * vertexSize, ALIGN_16) : (void*)zetaVertices;
+    ContourField contours;
+    u32 hasContours = (contourInit(&contours, arena, grid_w, grid_h, grid_w * grid_h / CONTOUR_VERTEX_DIVISOR, CONTOUR_ZERO_CAPACITY) == 0);
+
+    //all buffers come from the arena above, the graph itself only computes
+    ComputeStages stages = {
+        .points = zetaPoints,
+        .vertices = zetaVertices,
+        .packed = surfaceLod ? packedVertices : NULL,
+        .indices = indices,
+        .lod = surfaceLod,
+        .lattice = warped ? &lattice : NULL,
+        .rowFunc = rowFunc,
+        .rowCtx = rowCtx,
+        .sigmaMin = sigma_min,
+        .sigmaMax = sigma_max,
+        .tMin = t_min,
+        .tMax = t_max,
+        .pyramid = hasPyramid ? &pyramid : NULL,
+        .contours = hasContours ? &contours : NULL
+    };
+    runComputeGraph(&stages);
     renderFunc = drawAsPoints;
+    if(surfaceLod && lod.format == LOD_FORMAT_UNORM16) {
+        fprintf(stdout, "INFO: unorm16 vertices within %g of their float positions\n", lodQuantizationError(&lod));
+    }
     
     ScratchArena tmp = createScratchArena(SCRATCH_SIZE);
+    ARENA_NAME(&tmp, "shaders");
     Shader shader = loadGlShaders(&tmp, "shaders/mathModel.vs", "shaders/mathModel.fs");
+    Shader wireShader = loadGlShaderStages(&tmp, "shaders/mathModel.vs", "shaders/wireframe.gs", "shaders/wireframe.fs");
+    Shader contourShader = loadGlShaders(&tmp, "shaders/contour.vs", "shaders/contour.fs");
+    glActiveTexture(GL_TEXTURE0);
+    GLuint colormapTexture = uploadColormap(scratch);
 
     GLuint VAO, VBO, EBO;
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
 
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, grid_w * grid_h * sizeof(ZetaVertex), zetaVertices, GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, vertexCount * vertexSize, packedVertices, GL_STATIC_DRAW);
 
     glBindVertexArray(VAO);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(ZetaVertex), (void*)0);
+    if(surfaceLod && lod.format == LOD_FORMAT_UNORM16) {
+        glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(LodVertex), (void*)0);
+        glVertexAttribPointer(1, 1, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(LodVertex), (void*)(sizeof(u16) * 3));
+    } else {
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(ZetaVertex), (void*)0);
+        glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, sizeof(ZetaVertex), (void*)(sizeof(f32) * 3));
+    }
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, sizeof(float) * 3, (void*)(sizeof(f32) * 3));
     glEnableVertexAttribArray(1);
 
     glGenBuffers(1, &EBO);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(u32), indices, GL_STATIC_DRAW);
-    
-    mat4x4 projection;
-    mat4x4_identity(projection);
-    f32 fovRad;
-    mat4x4 model;
-    mat4x4_identity(model);
-    mat4x4 view;
+    if(surfaceLod) {
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(u16), lod.indices, GL_STATIC_DRAW);
+    } else {
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(u32), indices, GL_STATIC_DRAW);
+    }
 
-    GLuint modelLoc = glGetUniformLocation(shader.ID, "model");
-    GLuint projLoc = glGetUniformLocation(shader.ID, "projection");
-    GLuint viewLoc = glGetUniformLocation(shader.ID, "view");
+    GLuint reVAO = 0, reVBO = 0, reEBO = 0, imVAO = 0, imVBO = 0, imEBO = 0;
+    if(hasContours) {
+        uploadContour(&contours.reLines, &reVAO, &reVBO, &reEBO);
+        uploadContour(&contours.imLines, &imVAO, &imVBO, &imEBO);
+    }
+    arenaPageRestore(arena, uploadMark);
+    
+    SurfaceProgram fillProgram, wireProgram;
+    u32 quantized = surfaceLod && lod.format == LOD_FORMAT_UNORM16;
+    initSurfaceProgram(&fillProgram, shader.ID, quantized);
+    initSurfaceProgram(&wireProgram, wireShader.ID, quantized);
+    glGenQueries(FRAME_QUERIES, frameStats.queries);
+    renderBindFrameBlock(contourShader.ID);
+    GLuint contourColorLoc = glGetUniformLocation(contourShader.ID, "lineColor");
+    //projection, view and the identity model live in the Frame block and are only rewritten when marked dirty
+    renderStateInit(&renderState);
+    glClearColor(0.4f, 0.4f, 0.4f, 1.f);
 
     while(!glfwWindowShouldClose(window)) {
-        glfwGetFramebufferSize(window, &width, &height);
         currentFrame = glfwGetTime();
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
         lastPress += deltaTime;
         lastPressWire += deltaTime;
+        lastPressContour += deltaTime;
+        lastPressStats += deltaTime;
+        lastPressPalette += deltaTime;
 
-        fovRad = DEG2RAD(cam->Zoom);
+        f32 fovRad = DEG2RAD(cam->Zoom);
         processInput(window);
 
-        glClearColor(0.4f, 0.4f, 0.4f, 1.f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        RENDER_COUNT(&renderState, RENDER_CALL_CLEAR);
 
-        glUseProgram(shader.ID);
-        
-        mat4x4_perspective(projection, fovRad, (f32)width / height, 0.01f, 500.f);
-
-        vec3 tmp;
-        vec3_add(tmp, cam->Position, cam->Front);
-        mat4x4_look_at(view, cam->Position, tmp, cam->Up);
-
-        mat4x4_identity(model);
+        FrameUniforms* frame = &renderState.frame;
+        if(renderState.dirty & RENDER_DIRTY_PROJECTION) {
+            mat4x4_perspective(frame->projection, fovRad, (f32)windowWidth / windowHeight, 0.01f, 500.f);
+        }
+        if(renderState.dirty & RENDER_DIRTY_VIEW) {
+            vec3 target;
+            vec3_add(target, cam->Position, cam->Front);
+            mat4x4_look_at(frame->view, cam->Position, target, cam->Up);
+        }
+        renderFrameParams(&renderState, wireWidth, palette, wireMode == WIRE_OVERLAY);
+        renderFrameUpload(&renderState);
         
-        glUseProgram(shader.ID);
-        glUniformMatrix4fv(projLoc, 1, GL_FALSE, (const f32*)projection);
-        glUniformMatrix4fv(viewLoc, 1, GL_FALSE, (const f32*)view);
-        mat4x4_identity(model);
-        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, (const f32*)model);
-
-        glBindVertexArray(VAO);
+        //points can't go through the triangle geometry shader
+        u32 wire = !isPoints && (wireMode == WIRE_SHADER || wireMode == WIRE_OVERLAY);
+        activeSurface = wire ? &wireProgram : &fillProgram;
+        renderUseProgram(&renderState, activeSurface->id);
+        renderBindVertexArray(&renderState, VAO);
+        //chunks outside the view frustum are skipped, I prints what LOD and culling saved
+        if(surfaceLod && !isPoints) {
+            //chunk bounds are in mesh space, so the planes come from the full model view projection
+            mat4x4 viewProjection, modelViewProjection;
+            mat4x4_mul(viewProjection, frame->projection, frame->view);
+            mat4x4_mul(modelViewProjection, viewProjection, frame->model);
+            LodFrustum frustum;
+            lodFrustumFromMatrix(&frustum, (const f32*)modelViewProjection);
+            lodSelect(surfaceLod, cam->Position, &frustum, fovRad, (f32)windowHeight, lodPixelError);
+        }
+        if(!isPoints) {
+            frameStatsBegin(&frameStats, wireMode);
+        }
         renderFunc();
+        if(!isPoints) {
+            frameStatsEnd(&frameStats, wireMode, deltaTime);
+        }
+
+        //Re = 0 in white, Im = 0 in black, drawn over the surface
+        if(showContours && hasContours) {
+            renderUseProgram(&renderState, contourShader.ID);
+            renderPrimitiveRestart(&renderState, TRUE, CONTOUR_RESTART);
+            glUniform3f(contourColorLoc, 1.f, 1.f, 1.f);
+            renderBindVertexArray(&renderState, reVAO);
+            glDrawElements(GL_LINE_STRIP, contours.reLines.indexCount, GL_UNSIGNED_INT, 0);
+            glUniform3f(contourColorLoc, 0.f, 0.f, 0.f);
+            renderBindVertexArray(&renderState, imVAO);
+            glDrawElements(GL_LINE_STRIP, contours.imLines.indexCount, GL_UNSIGNED_INT, 0);
+            renderState.calls[RENDER_CALL_UNIFORM] += 2;
+            renderState.calls[RENDER_CALL_DRAW] += 2;
+        }
+        renderFrameEnd(&renderState);
 
         glfwSwapBuffers(window);
         glfwPollEvents();
     }
+    glDeleteQueries(FRAME_QUERIES, frameStats.queries);
+    glDeleteTextures(1, &colormapTexture);
+    renderStateFree(&renderState);
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
     glDeleteBuffers(1, &EBO);
+    if(hasContours) {
+        glDeleteVertexArrays(1, &reVAO);
+        glDeleteVertexArrays(1, &imVAO);
+        glDeleteBuffers(1, &reVBO);
+        glDeleteBuffers(1, &reEBO);
+        glDeleteBuffers(1, &imVBO);
+        glDeleteBuffers(1, &imEBO);
+    }
 
+    parallelSetScratch(NULL);
     arenaPagePop(map);
     arenaPagePop(map);
     releasePages(map);
+    parallelShutdown();
+    pluginUnloadAll(&plugins);
     glfwDestroyWindow(window);
     glfwTerminate();
 
@@ -17,6 +17,12 @@ typedef enum AlignType {
     ALIGN_128       = 128
 } AlignType;
  
+//position in an arena, restoring it frees everything allocated after the save
+typedef struct ArenaMark {
+    memptr arena;
+    usize offset;
+} ArenaMark;
+
 static inline usize AlignPad(usize offset, usize alignment) {
     usize mod = offset % alignment;
     return (mod == 0) ? 0 : (alignment - mod);
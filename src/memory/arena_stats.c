@@ -0,0 +1,164 @@
+#include "arena_stats.h"
+
+#ifdef ARENA_INSTRUMENT
+
+#include <stdlib.h>
+#include <string.h>
+
+static ArenaStats stats[ARENA_STATS_MAX];
+static ArenaTrace trace[ARENA_TRACE_SIZE];
+static u32 statsCount;
+static u32 statsDropped;
+static u64 traceNext;
+static u32 statsLock;
+static u32 dumpRegistered;
+
+static void statsAcquire(void) {
+    while(__atomic_test_and_set(&statsLock, __ATOMIC_ACQUIRE)) {
+    }
+}
+
+static void statsReleaseLock(void) {
+    __atomic_clear(&statsLock, __ATOMIC_RELEASE);
+}
+
+static void dumpAtExit(void) {
+    arenaStatsDump(stderr);
+}
+
+static ArenaStats* findLive(memptr arena) {
+    u32 count = __atomic_load_n(&statsCount, __ATOMIC_ACQUIRE);
+    for (u32 i = 0; i < count; i++) {
+        if(__atomic_load_n(&stats[i].arena, __ATOMIC_RELAXED) == arena) {
+            return &stats[i];
+        }
+    }
+    return NULL;
+}
+
+//arenas are registered on first use, ScratchArena is created by value so there is no earlier hook
+static ArenaStats* findOrAdd(memptr arena, const char* kind, usize capacity) {
+    ArenaStats* entry = findLive(arena);
+    if(entry) {
+        if(capacity > entry->capacity) {
+            entry->capacity = capacity;
+        }
+        if(!entry->kind) {
+            entry->kind = kind;
+        }
+        return entry;
+    }
+    statsAcquire();
+    entry = findLive(arena);
+    if(!entry && statsCount < ARENA_STATS_MAX) {
+        entry = &stats[statsCount];
+        memset(entry, 0, sizeof(ArenaStats));
+        entry->kind = kind;
+        entry->capacity = capacity;
+        entry->arena = arena;
+        __atomic_store_n(&statsCount, statsCount + 1, __ATOMIC_RELEASE);
+    } else if(!entry) {
+        statsDropped++;
+    }
+    if(!dumpRegistered) {
+        dumpRegistered = 1;
+        atexit(dumpAtExit);
+    }
+    statsReleaseLock();
+    return entry;
+}
+
+static void record(memptr arena, memptr site, usize size, usize offset, u32 kind) {
+    u64 slot = __atomic_fetch_add(&traceNext, 1, __ATOMIC_RELAXED) % ARENA_TRACE_SIZE;
+    trace[slot].arena = arena;
+    trace[slot].site = site;
+    trace[slot].size = size;
+    trace[slot].offset = offset;
+    trace[slot].kind = kind;
+}
+
+void arenaStatsAlloc(memptr arena, const char* kind, usize capacity, usize size, usize before, usize after, memptr site) {
+    ArenaStats* entry = findOrAdd(arena, kind, capacity);
+    record(arena, site, size, after - size, ARENA_TRACE_ALLOC);
+    if(!entry) {
+        return;
+    }
+    __atomic_fetch_add(&entry->allocCount, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&entry->padBytes, (after - before) - size, __ATOMIC_RELAXED);
+    __atomic_store_n(&entry->current, after, __ATOMIC_RELAXED);
+    usize high = __atomic_load_n(&entry->highWater, __ATOMIC_RELAXED);
+    while(after > high &&
+            !__atomic_compare_exchange_n(&entry->highWater, &high, after, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+void arenaStatsFail(memptr arena, const char* kind, usize capacity, usize size, memptr site) {
+    ArenaStats* entry = findOrAdd(arena, kind, capacity);
+    record(arena, site, size, 0, ARENA_TRACE_FAIL);
+    if(entry) {
+        __atomic_fetch_add(&entry->failCount, 1, __ATOMIC_RELAXED);
+    }
+}
+
+void arenaStatsRelease(memptr arena, usize offset, memptr site) {
+    ArenaStats* entry = findLive(arena);
+    record(arena, site, 0, offset, ARENA_TRACE_RELEASE);
+    if(entry) {
+        __atomic_fetch_add(&entry->releaseCount, 1, __ATOMIC_RELAXED);
+        __atomic_store_n(&entry->current, offset, __ATOMIC_RELAXED);
+    }
+}
+
+//keeps the numbers for the exit dump but lets the address be reused by a new arena
+void arenaStatsRetire(memptr arena) {
+    ArenaStats* entry = findLive(arena);
+    if(entry) {
+        __atomic_store_n(&entry->arena, NULL, __ATOMIC_RELAXED);
+    }
+}
+
+void arenaStatsName(memptr arena, const char* name) {
+    ArenaStats* entry = findOrAdd(arena, NULL, 0);
+    if(entry) {
+        entry->name = name;
+    }
+}
+
+const ArenaStats* arenaStatsFind(memptr arena) {
+    return findLive(arena);
+}
+
+static const char* traceKindName(u32 kind) {
+    switch(kind) {
+        case ARENA_TRACE_ALLOC:
+            return "alloc";
+        case ARENA_TRACE_FAIL:
+            return "FAIL";
+    }
+    return "release";
+}
+
+void arenaStatsDump(FILE* out) {
+    u32 count = __atomic_load_n(&statsCount, __ATOMIC_ACQUIRE);
+    fprintf(out, "arena usage (%u arenas, %u untracked):\n", count, statsDropped);
+    fprintf(out, "  %-10s %-8s %12s %12s %10s %10s %6s %8s\n",
+            "name", "kind", "capacity", "high-water", "allocs", "pad bytes", "fails", "releases");
+    for (u32 i = 0; i < count; i++) {
+        const ArenaStats* s = &stats[i];
+        fprintf(out, "  %-10s %-8s %12zu %12zu %10llu %10zu %6llu %8llu\n",
+                s->name ? s->name : "-", s->kind ? s->kind : "-", s->capacity, s->highWater,
+                (unsigned long long)s->allocCount, s->padBytes,
+                (unsigned long long)s->failCount, (unsigned long long)s->releaseCount);
+    }
+
+    u64 end = __atomic_load_n(&traceNext, __ATOMIC_ACQUIRE);
+    u64 begin = (end > ARENA_TRACE_DUMP) ? end - ARENA_TRACE_DUMP : 0;
+    fprintf(out, "last %llu arena calls (resolve sites with addr2line):\n", (unsigned long long)(end - begin));
+    for (u64 n = begin; n < end; n++) {
+        const ArenaTrace* t = &trace[n % ARENA_TRACE_SIZE];
+        fprintf(out, "  %-7s arena %p site %p size %zu offset %zu\n",
+                traceKindName(t->kind), t->arena, t->site, t->size, t->offset);
+    }
+}
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef m_ARENA_STATS_H
+#define m_ARENA_STATS_H
+
+#include <stdio.h>
+#include "common_types.h"
+
+//ASan poisoning of released arena memory, active in any -fsanitize=address build
+#if defined(__SANITIZE_ADDRESS__)
+#define ARENA_ASAN 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define ARENA_ASAN 1
+#endif
+#endif
+
+#ifdef ARENA_ASAN
+#include <sanitizer/asan_interface.h>
+#define ARENA_POISON(ptr, size) ASAN_POISON_MEMORY_REGION((ptr), (size))
+#define ARENA_UNPOISON(ptr, size) ASAN_UNPOISON_MEMORY_REGION((ptr), (size))
+#else
+#define ARENA_POISON(ptr, size) ((void)(ptr), (void)(size))
+#define ARENA_UNPOISON(ptr, size) ((void)(ptr), (void)(size))
+#endif
+
+//build with -DARENA_INSTRUMENT to record usage of every arena, dumped at exit
+#ifdef ARENA_INSTRUMENT
+
+#define ARENA_STATS_MAX 64
+#define ARENA_TRACE_SIZE 256
+#define ARENA_TRACE_DUMP 32
+
+typedef enum ArenaTraceKind {
+    ARENA_TRACE_ALLOC,
+    ARENA_TRACE_FAIL,
+    ARENA_TRACE_RELEASE
+} ArenaTraceKind;
+
+typedef struct ArenaStats {
+    memptr arena;
+    const char* kind;
+    const char* name;
+    usize capacity;
+    usize current;
+    usize highWater;
+    usize padBytes;
+    u64 allocCount;
+    u64 failCount;
+    u64 releaseCount;
+} ArenaStats;
+
+typedef struct ArenaTrace {
+    memptr arena;
+    memptr site;
+    usize size;
+    usize offset;
+    u32 kind;
+    u32 _pad;
+} ArenaTrace;
+
+void arenaStatsAlloc(memptr arena, const char* kind, usize capacity, usize size, usize before, usize after, memptr site);
+void arenaStatsFail(memptr arena, const char* kind, usize capacity, usize size, memptr site);
+void arenaStatsRelease(memptr arena, usize offset, memptr site);
+void arenaStatsRetire(memptr arena);
+void arenaStatsName(memptr arena, const char* name);
+const ArenaStats* arenaStatsFind(memptr arena);
+void arenaStatsDump(FILE* out);
+
+//the site is the return address of the arena function, i.e. the allocating call
+#define ARENA_TRACK_ALLOC(arena, kind, capacity, size, before, after) \
+    arenaStatsAlloc((arena), (kind), (capacity), (size), (before), (after), __builtin_return_address(0))
+#define ARENA_TRACK_FAIL(arena, kind, capacity, size) \
+    arenaStatsFail((arena), (kind), (capacity), (size), __builtin_return_address(0))
+#define ARENA_TRACK_RELEASE(arena, offset) arenaStatsRelease((arena), (offset), __builtin_return_address(0))
+#define ARENA_TRACK_RETIRE(arena) arenaStatsRetire(arena)
+#define ARENA_NAME(arena, name) arenaStatsName((arena), (name))
+
+#else
+
+#define ARENA_TRACK_ALLOC(arena, kind, capacity, size, before, after) ((void)(before))
+#define ARENA_TRACK_FAIL(arena, kind, capacity, size) ((void)0)
+#define ARENA_TRACK_RELEASE(arena, offset) ((void)0)
+#define ARENA_TRACK_RETIRE(arena) ((void)0)
+#define ARENA_NAME(arena, name) ((void)0)
+
+#endif
+
+#endif
@@ -0,0 +1,162 @@
+#include <stdio.h>
+#include "fixed_pool.h"
+#include "arena_stats.h"
+
+static void poolLock(FixedPool* pool) {
+    while(__atomic_test_and_set(&pool->lock, __ATOMIC_ACQUIRE)) {
+        while(__atomic_load_n(&pool->lock, __ATOMIC_RELAXED)) {
+        }
+    }
+}
+
+static void poolUnlock(FixedPool* pool) {
+    __atomic_clear(&pool->lock, __ATOMIC_RELEASE);
+}
+
+//free list first, then slots that have never been handed out
+static PoolFreeNode* takeLocked(FixedPool* pool) {
+    PoolFreeNode* node = pool->freeList;
+    if(node) {
+        pool->freeList = node->next;
+    } else if(pool->used < pool->capacity) {
+        node = (PoolFreeNode*)(pool->base + (usize)pool->used++ * pool->objectSize);
+    }
+    if(node) {
+        ARENA_UNPOISON(node, sizeof(PoolFreeNode));
+    }
+    return node;
+}
+
+i32 fixedPoolInit(FixedPool* pool, memMap* map, usize objectSize, usize alignment, u32 capacity, u32 cacheCount) {
+    if(objectSize == 0 || capacity == 0 || cacheCount > FIXED_POOL_MAX_CACHES) {
+        LOG_ERROR("Fixed pool needs a non-zero object size and capacity and at most %d caches",
+                FIXED_POOL_MAX_CACHES);
+        return -1;
+    }
+    if(alignment < sizeof(PoolFreeNode*)) {
+        alignment = sizeof(PoolFreeNode*);
+    }
+    if(alignment > ALIGN_128 || (alignment & (alignment - 1)) != 0) {
+        LOG_ERROR("Fixed pool alignment must be a power of two up to %d", ALIGN_128);
+        return -1;
+    }
+    objectSize += AlignPad(objectSize, alignment);
+    usize cacheBytes = (usize)cacheCount * sizeof(PoolCache);
+    usize arenaSize = (usize)capacity * objectSize + cacheBytes + 2 * ALIGN_128;
+
+    pool->arena = createPageArena(map, arenaSize);
+    if(!pool->arena) {
+        return -1;
+    }
+    pool->caches = cacheCount ? arenaPageAlloc(pool->arena, cacheBytes, ALIGN_64) : NULL;
+    pool->base = arenaPageAlloc(pool->arena, (usize)capacity * objectSize, alignment);
+    if(!pool->base || (cacheCount && !pool->caches)) {
+        LOG_ERROR("Fixed pool allocation failed.");
+        arenaPagePop(map);
+        return -1;
+    }
+    pool->objectSize = objectSize;
+    pool->capacity = capacity;
+    pool->cacheCount = cacheCount;
+    pool->lock = 0;
+    fixedPoolReset(pool);
+    return 0;
+}
+
+memptr fixedPoolAlloc(FixedPool* pool) {
+    poolLock(pool);
+    PoolFreeNode* node = takeLocked(pool);
+    poolUnlock(pool);
+    if(!node) {
+        LOG_ERROR("Fixed pool exhausted at %u objects", pool->capacity);
+        return NULL;
+    }
+    ARENA_UNPOISON(node, pool->objectSize);
+    return node;
+}
+
+void fixedPoolFree(FixedPool* pool, memptr object) {
+    if(!object) {
+        return;
+    }
+    PoolFreeNode* node = object;
+    ARENA_POISON((byte)object + sizeof(PoolFreeNode), pool->objectSize - sizeof(PoolFreeNode));
+    poolLock(pool);
+    node->next = pool->freeList;
+    pool->freeList = node;
+    poolUnlock(pool);
+}
+
+//the shared lock is only taken once per FIXED_POOL_CACHE_BATCH objects
+memptr fixedPoolAllocLocal(FixedPool* pool, u32 cacheIndex) {
+    if(cacheIndex >= pool->cacheCount) {
+        return fixedPoolAlloc(pool);
+    }
+    PoolCache* cache = &pool->caches[cacheIndex];
+    if(!cache->head) {
+        poolLock(pool);
+        for (u32 i = 0; i < FIXED_POOL_CACHE_BATCH; i++) {
+            PoolFreeNode* node = takeLocked(pool);
+            if(!node) {
+                break;
+            }
+            node->next = cache->head;
+            cache->head = node;
+            cache->count++;
+        }
+        poolUnlock(pool);
+        if(!cache->head) {
+            LOG_ERROR("Fixed pool exhausted at %u objects", pool->capacity);
+            return NULL;
+        }
+    }
+    PoolFreeNode* node = cache->head;
+    cache->head = node->next;
+    cache->count--;
+    ARENA_UNPOISON(node, pool->objectSize);
+    return node;
+}
+
+void fixedPoolFreeLocal(FixedPool* pool, u32 cacheIndex, memptr object) {
+    if(cacheIndex >= pool->cacheCount) {
+        fixedPoolFree(pool, object);
+        return;
+    }
+    if(!object) {
+        return;
+    }
+    PoolCache* cache = &pool->caches[cacheIndex];
+    PoolFreeNode* node = object;
+    ARENA_POISON((byte)object + sizeof(PoolFreeNode), pool->objectSize - sizeof(PoolFreeNode));
+    node->next = cache->head;
+    cache->head = node;
+    cache->count++;
+    if(cache->count < FIXED_POOL_CACHE_MAX) {
+        return;
+    }
+    //hand half back so other threads can reuse it
+    PoolFreeNode* first = cache->head;
+    PoolFreeNode* last = first;
+    for (u32 i = 1; i < FIXED_POOL_CACHE_MAX / 2; i++) {
+        last = last->next;
+    }
+    cache->head = last->next;
+    cache->count -= FIXED_POOL_CACHE_MAX / 2;
+    poolLock(pool);
+    last->next = pool->freeList;
+    pool->freeList = first;
+    poolUnlock(pool);
+}
+
+//drops every live object at once, callers must not touch them afterwards
+void fixedPoolReset(FixedPool* pool) {
+    poolLock(pool);
+    pool->freeList = NULL;
+    pool->used = 0;
+    ARENA_POISON(pool->base, (usize)pool->capacity * pool->objectSize);
+    for (u32 i = 0; i < pool->cacheCount; i++) {
+        pool->caches[i].head = NULL;
+        pool->caches[i].count = 0;
+    }
+    poolUnlock(pool);
+}
@@ -0,0 +1,43 @@
+#ifndef m_FIXED_POOL_H
+#define m_FIXED_POOL_H
+
+#include "common_types.h"
+#include "arena_base.h"
+#include "page_arena.h"
+
+#define FIXED_POOL_MAX_CACHES 64
+#define FIXED_POOL_CACHE_MAX 64
+#define FIXED_POOL_CACHE_BATCH 32
+
+//free objects hold the link in their own first bytes
+typedef struct PoolFreeNode {
+    struct PoolFreeNode* next;
+} PoolFreeNode;
+
+//per-thread stack of free objects, one cache line each
+typedef struct PoolCache {
+    PoolFreeNode* head;
+    u32 count;
+    u8 _pad[64 - sizeof(PoolFreeNode*) - sizeof(u32)];
+} PoolCache;
+
+typedef struct FixedPool {
+    PageArena* arena;
+    byte base;
+    PoolFreeNode* freeList;
+    PoolCache* caches;
+    usize objectSize;
+    u32 capacity;
+    u32 used;
+    u32 cacheCount;
+    u32 lock;
+} FixedPool;
+
+i32 fixedPoolInit(FixedPool* pool, memMap* map, usize objectSize, usize alignment, u32 capacity, u32 cacheCount);
+memptr fixedPoolAlloc(FixedPool* pool);
+void fixedPoolFree(FixedPool* pool, memptr object);
+memptr fixedPoolAllocLocal(FixedPool* pool, u32 cacheIndex);
+void fixedPoolFreeLocal(FixedPool* pool, u32 cacheIndex, memptr object);
+void fixedPoolReset(FixedPool* pool);
+
+#endif
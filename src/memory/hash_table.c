@@ -0,0 +1,189 @@
+#include <stdio.h>
+#include <string.h>
+#include "arena_base.h"
+#include "hash_table.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+//bit i set when control byte i of the group equals h2
+static inline u32 groupMatch(const u8* group, u8 h2) {
+#ifdef __SSE2__
+    __m128i ctrl = _mm_loadu_si128((const __m128i*)group);
+    return (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)h2)));
+#else
+    u32 mask = 0;
+    for (u32 i = 0; i < HASH_GROUP_WIDTH; i++) {
+        mask |= (u32)(group[i] == h2) << i;
+    }
+    return mask;
+#endif
+}
+
+static inline u32 groupEmpty(const u8* group) {
+#ifdef __SSE2__
+    return (u32)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)group));
+#else
+    u32 mask = 0;
+    for (u32 i = 0; i < HASH_GROUP_WIDTH; i++) {
+        mask |= (u32)(group[i] >> 7) << i;
+    }
+    return mask;
+#endif
+}
+
+static inline u32 lowestBit(u32 mask) {
+    return (u32)__builtin_ctz(mask);
+}
+
+static inline void setCtrl(HashTable* table, u32 slot, u8 value) {
+    table->ctrl[slot] = value;
+    if(slot < HASH_GROUP_WIDTH) {
+        table->ctrl[table->capacity + slot] = value;
+    }
+}
+
+//a table without values is a set, hand back the stored key so callers still get a non-NULL slot
+static inline memptr valueAt(const HashTable* table, u32 slot) {
+    if(!table->valueSize) {
+        return (memptr)&table->keys[slot];
+    }
+    return (memptr)(table->values + (usize)slot * table->valueSize);
+}
+
+i32 hashInit(HashTable* table, PageArena* arena, u32 expected, usize valueSize) {
+    //size for a 7/8 load factor, rounded up to a power of two
+    u64 needed = (u64)expected * 8 / 7 + 1;
+    u32 capacity = HASH_GROUP_WIDTH;
+    while(capacity < needed) {
+        if(capacity >= (1u << 31)) {
+            LOG_ERROR("Hash table too large for %u entries", expected);
+            return -1;
+        }
+        capacity <<= 1;
+    }
+    table->ctrl = arenaPageAlloc(arena, capacity + HASH_GROUP_WIDTH, ALIGN_16);
+    table->keys = arenaPageAlloc(arena, (usize)capacity * sizeof(u64), ALIGN_16);
+    table->values = valueSize ? arenaPageAlloc(arena, (usize)capacity * valueSize, ALIGN_16) : NULL;
+    if(!table->ctrl || !table->keys || (valueSize && !table->values)) {
+        LOG_ERROR("Hash table allocation failed.");
+        return -1;
+    }
+    table->valueSize = valueSize;
+    table->capacity = capacity;
+    table->mask = capacity - 1;
+    table->maxCount = capacity - capacity / 8;
+    hashClear(table);
+    return 0;
+}
+
+memptr hashFind(const HashTable* table, u64 key) {
+    u64 hash = hashMix64(key);
+    u8 h2 = (u8)(hash & 0x7f);
+    u32 pos = (u32)(hash >> 7) & table->mask;
+    for (;;) {
+        const u8* group = table->ctrl + pos;
+        u32 match = groupMatch(group, h2);
+        while(match) {
+            u32 slot = (pos + lowestBit(match)) & table->mask;
+            if(table->keys[slot] == key) {
+                return valueAt(table, slot);
+            }
+            match &= match - 1;
+        }
+        if(groupEmpty(group)) {
+            return NULL;
+        }
+        pos = (pos + HASH_GROUP_WIDTH) & table->mask;
+    }
+}
+
+//returns the value slot for key, new slots are zeroed and flagged through inserted
+memptr hashInsert(HashTable* table, u64 key, u32* inserted) {
+    u64 hash = hashMix64(key);
+    u8 h2 = (u8)(hash & 0x7f);
+    u32 pos = (u32)(hash >> 7) & table->mask;
+    for (;;) {
+        const u8* group = table->ctrl + pos;
+        u32 match = groupMatch(group, h2);
+        while(match) {
+            u32 slot = (pos + lowestBit(match)) & table->mask;
+            if(table->keys[slot] == key) {
+                if(inserted) {
+                    *inserted = 0;
+                }
+                return valueAt(table, slot);
+            }
+            match &= match - 1;
+        }
+        u32 empty = groupEmpty(group);
+        if(empty) {
+            if(table->count >= table->maxCount) {
+                LOG_ERROR("Hash table full at %u entries", table->count);
+                return NULL;
+            }
+            u32 slot = (pos + lowestBit(empty)) & table->mask;
+            setCtrl(table, slot, h2);
+            table->keys[slot] = key;
+            table->count++;
+            if(table->valueSize) {
+                memset(valueAt(table, slot), 0, table->valueSize);
+            }
+            if(inserted) {
+                *inserted = 1;
+            }
+            return valueAt(table, slot);
+        }
+        pos = (pos + HASH_GROUP_WIDTH) & table->mask;
+    }
+}
+
+//backward shift: pull later entries of the run into the hole unless that would move them before home
+i32 hashRemove(HashTable* table, u64 key) {
+    u64 hash = hashMix64(key);
+    u8 h2 = (u8)(hash & 0x7f);
+    u32 pos = (u32)(hash >> 7) & table->mask;
+    u32 hole = 0;
+    u32 found = 0;
+    while(!found) {
+        const u8* group = table->ctrl + pos;
+        u32 match = groupMatch(group, h2);
+        while(match) {
+            u32 slot = (pos + lowestBit(match)) & table->mask;
+            if(table->keys[slot] == key) {
+                hole = slot;
+                found = 1;
+                break;
+            }
+            match &= match - 1;
+        }
+        if(!found && groupEmpty(group)) {
+            return -1;
+        }
+        pos = (pos + HASH_GROUP_WIDTH) & table->mask;
+    }
+
+    u32 next = (hole + 1) & table->mask;
+    while(table->ctrl[next] != HASH_CTRL_EMPTY) {
+        u32 home = (u32)(hashMix64(table->keys[next]) >> 7) & table->mask;
+        //entry may move back only if home is not inside (hole, next]
+        if(((next - home) & table->mask) >= ((next - hole) & table->mask)) {
+            setCtrl(table, hole, table->ctrl[next]);
+            table->keys[hole] = table->keys[next];
+            if(table->valueSize) {
+                memcpy(valueAt(table, hole), valueAt(table, next), table->valueSize);
+            }
+            hole = next;
+        }
+        next = (next + 1) & table->mask;
+    }
+    setCtrl(table, hole, HASH_CTRL_EMPTY);
+    table->count--;
+    return 0;
+}
+
+void hashClear(HashTable* table) {
+    memset(table->ctrl, HASH_CTRL_EMPTY, table->capacity + HASH_GROUP_WIDTH);
+    table->count = 0;
+}
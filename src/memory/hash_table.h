@@ -0,0 +1,40 @@
+#ifndef m_HASH_TABLE_H
+#define m_HASH_TABLE_H
+
+#include "common_types.h"
+#include "page_arena.h"
+
+#define HASH_GROUP_WIDTH 16
+#define HASH_CTRL_EMPTY 0x80
+
+//linear probing over SwissTable-style control bytes: 0x80 marks an empty slot, a full slot
+//holds the low 7 bits of the hash. The first HASH_GROUP_WIDTH control bytes are mirrored
+//past the end so a group load never wraps. Deletion shifts later entries back, so there
+//are no tombstones and a probe always stops at the first empty slot.
+typedef struct HashTable {
+    u8* ctrl;
+    u64* keys;
+    byte values;
+    usize valueSize;
+    u32 capacity;
+    u32 mask;
+    u32 count;
+    u32 maxCount;
+} HashTable;
+
+i32 hashInit(HashTable* table, PageArena* arena, u32 expected, usize valueSize);
+memptr hashFind(const HashTable* table, u64 key);
+memptr hashInsert(HashTable* table, u64 key, u32* inserted);
+i32 hashRemove(HashTable* table, u64 key);
+void hashClear(HashTable* table);
+
+static inline u64 hashMix64(u64 key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdull;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ull;
+    key ^= key >> 33;
+    return key;
+}
+
+#endif
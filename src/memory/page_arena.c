@@ -5,6 +5,25 @@
 #include <sys/mman.h>
 #include "arena_base.h"
 #include "page_arena.h"
+#include "arena_stats.h"
+
+#ifndef MAP_NORESERVE
+#define MAP_NORESERVE 0
+#endif
+
+//round needed up to a page and make [base + committed, base + needed) writable
+static i32 commitPages(memMap* map, byte base, usize* committed, usize needed) {
+    if(needed <= *committed) {
+        return 0;
+    }
+    usize end = needed + AlignPad(needed, map->pageSize);
+    if(mprotect(base + *committed, end - *committed, PROT_READ | PROT_WRITE) != 0) {
+        LOG_ERROR("Failed to commit %zu bytes of reserved memory", end - *committed);
+        return -1;
+    }
+    *committed = end;
+    return 0;
+}
 
 memMap* initMemMap(usize requestedSize) {
     if (requestedSize < 1) {
@@ -39,7 +58,10 @@ memMap* initMemMap(usize requestedSize) {
         .offset = 0,
         .previous = 0,
         .size = usableSize,
-        .arenaCount = 0
+        .tableSize = pageSize,
+        .tableLimit = pageSize,
+        .arenaCount = 0,
+        .growable = 0
     };
 
     memcpy(structBase, &tmp, sizeof(memMap));
@@ -50,6 +72,55 @@ memMap* initMemMap(usize requestedSize) {
     return map;
 }
 
+memMap* initMemMapReserve(usize reserveSize) {
+    if (reserveSize < 1) {
+        LOG_ERROR("Reservation must be non-zero positive integer");
+        return NULL;
+    }
+
+    usize pageSize = sysconf(_SC_PAGESIZE);
+    usize usableSize = reserveSize + AlignPad(reserveSize, pageSize);
+    usize tableLimit = PAGE_TABLE_RESERVE + AlignPad(PAGE_TABLE_RESERVE, pageSize);
+    //guard | descriptor table | guard | arenas | guard, nothing is writable until committed
+    usize total = usableSize + tableLimit + 3 * pageSize;
+
+    memptr raw = mmap(NULL, total, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (raw == MAP_FAILED) {
+        LOG_ERROR("FAILED TO RESERVE ADDRESS SPACE, size: %zu", total);
+        return NULL;
+    }
+
+    byte structBase = (byte)raw + pageSize;
+    if (mprotect(structBase, pageSize, PROT_READ | PROT_WRITE) != 0) {
+        LOG_ERROR("Failed to commit arena descriptor table");
+        munmap(raw, total);
+        return NULL;
+    }
+    byte usableStart = structBase + tableLimit + pageSize;
+
+    memMap tmp = {
+        .start = raw,
+        .base = usableStart,
+        .structBase = NULL,
+        .arenaCurrent = NULL,
+        .limit = total,
+        .pageSize = pageSize,
+        .offset = 0,
+        .previous = 0,
+        .size = usableSize,
+        .tableSize = pageSize,
+        .tableLimit = tableLimit,
+        .arenaCount = 0,
+        .growable = 1
+    };
+
+    memcpy(structBase, &tmp, sizeof(memMap));
+    memMap* map = (memMap*)structBase;
+    map->structBase = map;
+
+    return map;
+}
+
 void pageAlign(memMap* map, usize arenaSize) {
     usize remainder = arenaSize % map->pageSize; 
     usize alignPad = (remainder == 0) ? 0 : (map->pageSize - remainder);
@@ -61,6 +132,8 @@ void pageAlign(memMap* map, usize arenaSize) {
 }
 
 void releasePages(memMap* map) {
+    //shadow memory outlives munmap, a later mapping at this address must not start poisoned
+    ARENA_UNPOISON(map->base, map->peak);
     munmap(map->start, map->limit);
 }
 
@@ -79,18 +152,24 @@ PageArena* createPageArena(memMap* map, usize arenaSize) {
     tmp.size = arenaSize;
     tmp.offset = 0;
     tmp.previous = tmp.offset;
+    tmp.committed = map->growable ? 0 : arenaSize;
+    tmp.mapOffset = (usize)(arenaBase - (byte)map->base);
+    tmp.backing = PAGE_BACKING_SMALL;
     tmp.parent = map;
-    byte structBase;
-    if(tmp.parent->arenaCount < 1) {
-        structBase = tmp.parent->structBase + sizeof(memMap);
-    } else {
-        structBase = tmp.parent->structBase + sizeof(memMap) + tmp.parent->arenaCount * sizeof(PageArena);
+    usize slot = sizeof(memMap) + tmp.parent->arenaCount * sizeof(PageArena);
+    if(slot + sizeof(PageArena) > map->tableLimit ||
+            commitPages(map, (byte)map->structBase, &map->tableSize, slot + sizeof(PageArena)) != 0) {
+        LOG_ERROR("Arena descriptor table full at %u arenas", map->arenaCount);
+        map->offset = tmp.mapOffset;
+        return NULL;
     }
+    byte structBase = (byte)tmp.parent->structBase + slot;
     memcpy(structBase, &tmp, sizeof(PageArena));
     tmp.parent->arenaCount++;
     PageArena* arena = (PageArena*)structBase;
     arena->base = arenaBase;
     map->previous = map->offset;
+    map->peak = (map->offset > map->peak) ? map->offset : map->peak;
     if(map->arenaCurrent) {
         arena->arenaPrevious = map->arenaCurrent;
     } else {
@@ -100,6 +179,87 @@ PageArena* createPageArena(memMap* map, usize arenaSize) {
     return arena;
 }
 
+//2 MiB pages for big mesh arrays: hugetlbfs pages first, then transparent huge pages
+PageArena* createPageArenaHuge(memMap* map, usize arenaSize) {
+    usize mapOffset = map->offset;
+    usize pad = AlignPad((usize)((byte)map->base + map->offset), PAGE_HUGE_SIZE);
+    usize size = arenaSize + AlignPad(arenaSize, PAGE_HUGE_SIZE);
+    if(size + pad > map->size - map->offset) {
+        LOG_ERROR("No room for %zu byte huge page arena, using small pages", size);
+        return createPageArena(map, arenaSize);
+    }
+    map->offset += pad;
+    PageArena* arena = createPageArena(map, size);
+    if(!arena) {
+        map->offset = mapOffset;
+        return NULL;
+    }
+    arena->mapOffset = mapOffset;
+
+#ifdef MAP_HUGETLB
+    memptr huge = mmap(arena->base, size, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_HUGETLB, -1, 0);
+    if(huge != MAP_FAILED) {
+        arena->backing = PAGE_BACKING_HUGETLB;
+        arena->committed = size;
+        return arena;
+    }
+    //a failed MAP_FIXED may already have dropped the old mapping, put it back
+    int prot = map->growable ? PROT_NONE : PROT_READ | PROT_WRITE;
+    if(mmap(arena->base, size, prot, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_NORESERVE, -1, 0) == MAP_FAILED) {
+        LOG_ERROR("Failed to restore arena mapping after huge page attempt");
+        arenaPagePop(map);
+        return NULL;
+    }
+#endif
+#ifdef MADV_HUGEPAGE
+    if(madvise(arena->base, size, MADV_HUGEPAGE) == 0) {
+        arena->backing = PAGE_BACKING_TRANSPARENT;
+    }
+#endif
+    return arena;
+}
+
+const char* pageBackingName(u32 backing) {
+    switch(backing) {
+        case PAGE_BACKING_HUGETLB:
+            return "hugetlb 2 MiB pages";
+        case PAGE_BACKING_TRANSPARENT:
+            return "transparent huge pages";
+    }
+    return "4 KiB pages";
+}
+
+//only the newest arena borders free address space, so only it can grow in place
+static i32 growPageArena(PageArena* arena, usize needed) {
+    memMap* map = arena->parent;
+    if(!map->growable || arena != map->arenaCurrent) {
+        return -1;
+    }
+    usize start = (usize)(arena->base - (byte)map->base);
+    usize size = (arena->size > 0) ? arena->size : map->pageSize;
+    while(size < needed) {
+        size *= 2;
+    }
+    if(size > map->size - start) {
+        size = map->size - start;
+    }
+    if(size < needed) {
+        LOG_ERROR("Reserved address space exhausted growing arena to %zu bytes", needed);
+        return -1;
+    }
+#ifdef MADV_HUGEPAGE
+    if(arena->backing == PAGE_BACKING_TRANSPARENT) {
+        madvise(arena->base + arena->size, size - arena->size, MADV_HUGEPAGE);
+    }
+#endif
+    arena->size = size;
+    map->offset = start + size + AlignPad(size, map->pageSize);
+    map->previous = map->offset;
+    map->peak = (map->offset > map->peak) ? map->offset : map->peak;
+    return 0;
+}
+
 memptr arenaPageAlloc(PageArena* arena, usize alloc_size, usize alignment) {
     if(alloc_size < 1) {
         LOG_ERROR("request 0 bit allocation, return NULL");
@@ -114,9 +274,15 @@ memptr arenaPageAlloc(PageArena* arena, usize alloc_size, usize alignment) {
         case ALIGN_32:
         case ALIGN_64:
         case ALIGN_128:
+        {
+            usize before = arena->offset;
+            if(arena->offset + AlignPad(arena->offset, alignment) + alloc_size > arena->size) {
+                growPageArena(arena, arena->offset + AlignPad(arena->offset, alignment) + alloc_size);
+            }
 
             if(arena->size < alloc_size || arena->size - arena->offset < alloc_size || arena->size < alignment) {
                 LOG_ERROR("allocation request beyond size of arena, return null");
+                ARENA_TRACK_FAIL(arena, "page", arena->size, alloc_size);
                 return NULL;
             }
 
@@ -126,12 +292,21 @@ memptr arenaPageAlloc(PageArena* arena, usize alloc_size, usize alignment) {
 
             if(alloc_size + arena->offset > arena->size) {
                 LOG_ERROR("ERROR: Arena overflow!");
+                ARENA_TRACK_FAIL(arena, "page", arena->size, alloc_size);
+                return NULL;
+            }
+
+            if(commitPages(arena->parent, arena->base, &arena->committed, arena->offset + alloc_size) != 0) {
+                ARENA_TRACK_FAIL(arena, "page", arena->size, alloc_size);
                 return NULL;
             }
 
             memptr ptr = (memptr)(arena->base + arena->offset);
             arena->offset += alloc_size;
+            ARENA_UNPOISON(ptr, alloc_size);
+            ARENA_TRACK_ALLOC(arena, "page", arena->size, alloc_size, before, arena->offset);
             return ptr;
+        }
     }
     LOG_ERROR("Returning null due to unacceptable alignment request on allocation.");
     return NULL;
@@ -140,16 +315,124 @@ memptr arenaPageAlloc(PageArena* arena, usize alloc_size, usize alignment) {
 void arenaPagePop(memMap* map) {
     if(map->arenaCurrent) {
         PageArena* current = map->arenaCurrent;
+        ARENA_POISON(current->base, current->offset);
+        ARENA_TRACK_RELEASE(current, 0);
+        ARENA_TRACK_RETIRE(current);
+        //hand the touched pages back to the kernel, the range stays reserved
+        if(current->backing == PAGE_BACKING_HUGETLB) {
+            int prot = map->growable ? PROT_NONE : PROT_READ | PROT_WRITE;
+            mmap(current->base, current->size, prot, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_NORESERVE, -1, 0);
+        } else if(map->growable && current->committed > 0) {
+            madvise(current->base, current->committed, MADV_DONTNEED);
+            mprotect(current->base, current->committed, PROT_NONE);
+        }
         current->base = NULL;
         current->size = 0;
         current->offset = 0;
+        current->committed = 0;
+        current->backing = PAGE_BACKING_SMALL;
 
         map->arenaCurrent = current->arenaPrevious;
         map->arenaCount--;
-        map->offset = map->previous;
+        map->offset = current->mapOffset;
+        map->previous = map->offset;
 
     } else {
         LOG_ERROR("Current arena NULL on pop request");
         //exit(EXIT_FAILURE);
     }
 }
+
+//commit is an atomic max, overlapping mprotect calls from racing threads are harmless
+static i32 commitPagesAtomic(PageArena* arena, usize needed) {
+    usize committed = __atomic_load_n(&arena->committed, __ATOMIC_ACQUIRE);
+    if(needed <= committed) {
+        return 0;
+    }
+    usize pageSize = arena->parent->pageSize;
+    usize end = needed + AlignPad(needed, pageSize);
+    if(mprotect(arena->base + committed, end - committed, PROT_READ | PROT_WRITE) != 0) {
+        LOG_ERROR("Failed to commit %zu bytes of reserved memory", end - committed);
+        return -1;
+    }
+    while(committed < end &&
+            !__atomic_compare_exchange_n(&arena->committed, &committed, end, 0, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE)) {
+    }
+    return 0;
+}
+
+//safe to call from many threads at once, never grows the arena
+memptr arenaPageAllocAtomic(PageArena* arena, usize alloc_size, usize alignment) {
+    if(alloc_size < 1 || alignment < ALIGN_1 || alignment > ALIGN_128 || (alignment & (alignment - 1)) != 0) {
+        LOG_ERROR("Bad concurrent allocation request: %zu bytes aligned to %zu", alloc_size, alignment);
+        return NULL;
+    }
+    usize offset = __atomic_load_n(&arena->offset, __ATOMIC_RELAXED);
+    usize start;
+    do {
+        start = offset + AlignPad(offset, alignment);
+        if(start > arena->size || arena->size - start < alloc_size) {
+            LOG_ERROR("ERROR: Arena overflow!");
+            ARENA_TRACK_FAIL(arena, "page", arena->size, alloc_size);
+            return NULL;
+        }
+    } while(!__atomic_compare_exchange_n(&arena->offset, &offset, start + alloc_size, 1,
+                __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+    if(commitPagesAtomic(arena, start + alloc_size) != 0) {
+        ARENA_TRACK_FAIL(arena, "page", arena->size, alloc_size);
+        return NULL;
+    }
+    ARENA_UNPOISON(arena->base + start, alloc_size);
+    ARENA_TRACK_ALLOC(arena, "page", arena->size, alloc_size, offset, start + alloc_size);
+    return (memptr)(arena->base + start);
+}
+
+void arenaChunkInit(ArenaChunk* chunk, PageArena* arena, usize chunkSize) {
+    chunk->arena = arena;
+    chunk->base = NULL;
+    chunk->offset = 0;
+    chunk->size = 0;
+    chunk->chunkSize = chunkSize ? chunkSize : ARENA_CHUNK_SIZE;
+}
+
+//small requests bump a private chunk, big ones go straight to the shared offset
+memptr arenaChunkAlloc(ArenaChunk* chunk, usize alloc_size, usize alignment) {
+    if(alloc_size < 1 || alignment < ALIGN_1 || alignment > ALIGN_128 || (alignment & (alignment - 1)) != 0) {
+        LOG_ERROR("Bad chunk allocation request: %zu bytes aligned to %zu", alloc_size, alignment);
+        return NULL;
+    }
+    usize start = chunk->offset + AlignPad((usize)(chunk->base + chunk->offset), alignment);
+    if(chunk->base && start <= chunk->size && chunk->size - start >= alloc_size) {
+        chunk->offset = start + alloc_size;
+        return (memptr)(chunk->base + start);
+    }
+    if(alloc_size > chunk->chunkSize / 4) {
+        return arenaPageAllocAtomic(chunk->arena, alloc_size, alignment);
+    }
+    //chunks start on their own cache line so neighbouring threads never share one
+    byte base = arenaPageAllocAtomic(chunk->arena, chunk->chunkSize, ALIGN_64);
+    if(!base) {
+        return NULL;
+    }
+    chunk->base = base;
+    chunk->size = chunk->chunkSize;
+    chunk->offset = AlignPad((usize)base, alignment) + alloc_size;
+    return (memptr)(base + chunk->offset - alloc_size);
+}
+
+ArenaMark arenaPageSave(PageArena* arena) {
+    ArenaMark mark = { .arena = arena, .offset = arena->offset };
+    return mark;
+}
+
+//committed pages are kept, the next allocations reuse them
+void arenaPageRestore(PageArena* arena, ArenaMark mark) {
+    if(mark.arena != arena || mark.offset > arena->offset) {
+        LOG_ERROR("Page arena mark does not belong to this arena or was already released");
+        return;
+    }
+    ARENA_POISON(arena->base + mark.offset, arena->offset - mark.offset);
+    ARENA_TRACK_RELEASE(arena, mark.offset);
+    arena->offset = mark.offset;
+}
@@ -2,6 +2,17 @@
 #define m_PAGE_ARENA_H
 
 #include "common_types.h"
+#include "arena_base.h"
+
+#define PAGE_TABLE_RESERVE MiB(1)
+#define PAGE_HUGE_SIZE MiB(2)
+#define ARENA_CHUNK_SIZE 1024 * 64
+
+typedef enum PageBacking {
+    PAGE_BACKING_SMALL       = 0,
+    PAGE_BACKING_TRANSPARENT = 1,
+    PAGE_BACKING_HUGETLB     = 2
+} PageBacking;
 
 struct PageArena;
 
@@ -16,8 +27,11 @@ typedef struct memMap{
     usize size;
     usize pageSize;
     usize selfSize;
+    usize tableSize;
+    usize tableLimit;
+    usize peak;
     u32 arenaCount;
-    u32 _pad;
+    u32 growable;
 } memMap;
 
 typedef struct PageArena{
@@ -27,14 +41,35 @@ typedef struct PageArena{
     usize offset;
     usize size;
     usize previous;
+    usize committed;
+    usize mapOffset;
+    u32 backing;
+    u32 _pad;
 } PageArena;
 
+//a thread's private slice of a shared arena, refilled from the arena with one atomic per chunk
+typedef struct ArenaChunk {
+    PageArena* arena;
+    byte base;
+    usize offset;
+    usize size;
+    usize chunkSize;
+} ArenaChunk;
+
 memMap *initMemMap(usize requestedSize);
+memMap *initMemMapReserve(usize reserveSize);
 void pageAlign(memMap* map, usize arenaSize);
 void releasePages(memMap* map);
 
 PageArena *createPageArena(memMap* map, usize arenaSize);
+PageArena *createPageArenaHuge(memMap* map, usize arenaSize);
+const char *pageBackingName(u32 backing);
 memptr arenaPageAlloc(PageArena* arena, usize alloc_size, usize alignment);
 void arenaPagePop(memMap* map);
+memptr arenaPageAllocAtomic(PageArena* arena, usize alloc_size, usize alignment);
+void arenaChunkInit(ArenaChunk* chunk, PageArena* arena, usize chunkSize);
+memptr arenaChunkAlloc(ArenaChunk* chunk, usize alloc_size, usize alignment);
+ArenaMark arenaPageSave(PageArena* arena);
+void arenaPageRestore(PageArena* arena, ArenaMark mark);
 
 #endif
@@ -0,0 +1,161 @@
+#include <stdio.h>
+#include <string.h>
+#include "arena_base.h"
+#include "ring_queue.h"
+
+static u64 ringCapacity(u32 capacity) {
+    u64 size = 2;
+    while(size < capacity) {
+        size <<= 1;
+    }
+    return size;
+}
+
+SpscRing* spscCreate(PageArena* arena, u32 capacity, usize elementSize) {
+    if(capacity == 0 || elementSize == 0) {
+        LOG_ERROR("Ring needs a non-zero capacity and element size");
+        return NULL;
+    }
+    u64 size = ringCapacity(capacity);
+    SpscRing* ring = arenaPageAlloc(arena, sizeof(SpscRing), ALIGN_64);
+    byte buffer = arenaPageAlloc(arena, size * elementSize, ALIGN_64);
+    if(!ring || !buffer) {
+        LOG_ERROR("Ring allocation failed.");
+        return NULL;
+    }
+    memset(ring, 0, sizeof(SpscRing));
+    ring->buffer = buffer;
+    ring->elementSize = elementSize;
+    ring->capacity = size;
+    ring->mask = size - 1;
+    return ring;
+}
+
+//copies count elements between the ring at pos and flat memory, splitting at the wrap
+static void ringCopy(SpscRing* ring, u64 pos, byte flat, u32 count, u32 toRing) {
+    u64 first = pos & ring->mask;
+    u64 run = (ring->capacity - first < count) ? ring->capacity - first : count;
+    byte slot = ring->buffer + first * ring->elementSize;
+    if(toRing) {
+        memcpy(slot, flat, run * ring->elementSize);
+        memcpy(ring->buffer, flat + run * ring->elementSize, (count - run) * ring->elementSize);
+    } else {
+        memcpy(flat, slot, run * ring->elementSize);
+        memcpy(flat + run * ring->elementSize, ring->buffer, (count - run) * ring->elementSize);
+    }
+}
+
+u32 spscPush(SpscRing* ring, const void* items, u32 count) {
+    u64 tail = ring->tail;
+    u64 space = ring->capacity - (tail - ring->cachedHead);
+    if(space < count) {
+        ring->cachedHead = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        space = ring->capacity - (tail - ring->cachedHead);
+    }
+    u32 n = (space < count) ? (u32)space : count;
+    if(n == 0) {
+        return 0;
+    }
+    ringCopy(ring, tail, (byte)items, n, 1);
+    __atomic_store_n(&ring->tail, tail + n, __ATOMIC_RELEASE);
+    return n;
+}
+
+u32 spscPop(SpscRing* ring, void* out, u32 maxCount) {
+    u64 head = ring->head;
+    u64 ready = ring->cachedTail - head;
+    if(ready < maxCount) {
+        ring->cachedTail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+        ready = ring->cachedTail - head;
+    }
+    u32 n = (ready < maxCount) ? (u32)ready : maxCount;
+    if(n == 0) {
+        return 0;
+    }
+    ringCopy(ring, head, (byte)out, n, 0);
+    __atomic_store_n(&ring->head, head + n, __ATOMIC_RELEASE);
+    return n;
+}
+
+static inline u64* cellSeq(MpscRing* ring, u64 pos) {
+    return (u64*)(ring->cells + (pos & ring->mask) * ring->cellSize);
+}
+
+MpscRing* mpscCreate(PageArena* arena, u32 capacity, usize elementSize) {
+    if(capacity == 0 || elementSize == 0) {
+        LOG_ERROR("Ring needs a non-zero capacity and element size");
+        return NULL;
+    }
+    u64 size = ringCapacity(capacity);
+    usize cellSize = sizeof(u64) + elementSize;
+    cellSize += AlignPad(cellSize, sizeof(u64));
+    MpscRing* ring = arenaPageAlloc(arena, sizeof(MpscRing), ALIGN_64);
+    byte cells = arenaPageAlloc(arena, size * cellSize, ALIGN_64);
+    if(!ring || !cells) {
+        LOG_ERROR("Ring allocation failed.");
+        return NULL;
+    }
+    memset(ring, 0, sizeof(MpscRing));
+    ring->cells = cells;
+    ring->elementSize = elementSize;
+    ring->cellSize = cellSize;
+    ring->capacity = size;
+    ring->mask = size - 1;
+    for (u64 i = 0; i < size; i++) {
+        *cellSeq(ring, i) = i;
+    }
+    return ring;
+}
+
+//claims as many of count consecutive cells as are free with one CAS on the tail
+u32 mpscPush(MpscRing* ring, const void* items, u32 count) {
+    u64 tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+    for (;;) {
+        u32 n = count;
+        u32 stale = 0;
+        //cells are freed in order, so the last free cell bounds the batch
+        while(n > 0) {
+            u64 pos = tail + n - 1;
+            i64 diff = (i64)(__atomic_load_n(cellSeq(ring, pos), __ATOMIC_ACQUIRE) - pos);
+            if(diff == 0) {
+                break;
+            }
+            if(diff > 0) {
+                stale = 1;
+                break;
+            }
+            n--;
+        }
+        if(stale) {
+            tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+            continue;
+        }
+        if(n == 0) {
+            return 0;
+        }
+        if(__atomic_compare_exchange_n(&ring->tail, &tail, tail + n, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            for (u32 i = 0; i < n; i++) {
+                u64* seq = cellSeq(ring, tail + i);
+                memcpy(seq + 1, (const u8*)items + (usize)i * ring->elementSize, ring->elementSize);
+                __atomic_store_n(seq, tail + i + 1, __ATOMIC_RELEASE);
+            }
+            return n;
+        }
+    }
+}
+
+u32 mpscPop(MpscRing* ring, void* out, u32 maxCount) {
+    u64 head = ring->head;
+    u32 n = 0;
+    while(n < maxCount) {
+        u64* seq = cellSeq(ring, head + n);
+        if(__atomic_load_n(seq, __ATOMIC_ACQUIRE) != head + n + 1) {
+            break;
+        }
+        memcpy((u8*)out + (usize)n * ring->elementSize, seq + 1, ring->elementSize);
+        __atomic_store_n(seq, head + n + ring->capacity, __ATOMIC_RELEASE);
+        n++;
+    }
+    ring->head = head + n;
+    return n;
+}
@@ -0,0 +1,48 @@
+#ifndef m_RING_QUEUE_H
+#define m_RING_QUEUE_H
+
+#include "common_types.h"
+#include "page_arena.h"
+
+#define RING_CACHE_LINE 64
+
+//single producer, single consumer. Each side owns a cache line holding its index and a
+//cached copy of the other side's, so the shared line is only read when the cache runs out.
+typedef struct SpscRing {
+    byte buffer;
+    usize elementSize;
+    u64 mask;
+    u64 capacity;
+    u8 _pad0[RING_CACHE_LINE - sizeof(byte) - sizeof(usize) - 2 * sizeof(u64)];
+    u64 tail;
+    u64 cachedHead;
+    u8 _pad1[RING_CACHE_LINE - 2 * sizeof(u64)];
+    u64 head;
+    u64 cachedTail;
+    u8 _pad2[RING_CACHE_LINE - 2 * sizeof(u64)];
+} SpscRing;
+
+//many producers, one consumer. Every cell carries a sequence number (Vyukov's bounded queue):
+//seq == pos means free for the producer of pos, seq == pos + 1 means ready for the consumer.
+typedef struct MpscRing {
+    byte cells;
+    usize elementSize;
+    usize cellSize;
+    u64 mask;
+    u64 capacity;
+    u8 _pad0[RING_CACHE_LINE - sizeof(byte) - 2 * sizeof(usize) - 2 * sizeof(u64)];
+    u64 tail;
+    u8 _pad1[RING_CACHE_LINE - sizeof(u64)];
+    u64 head;
+    u8 _pad2[RING_CACHE_LINE - sizeof(u64)];
+} MpscRing;
+
+SpscRing *spscCreate(PageArena* arena, u32 capacity, usize elementSize);
+u32 spscPush(SpscRing* ring, const void* items, u32 count);
+u32 spscPop(SpscRing* ring, void* out, u32 maxCount);
+
+MpscRing *mpscCreate(PageArena* arena, u32 capacity, usize elementSize);
+u32 mpscPush(MpscRing* ring, const void* items, u32 count);
+u32 mpscPop(MpscRing* ring, void* out, u32 maxCount);
+
+#endif
@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include "arena_base.h"
 #include "scratch_arena.h"
+#include "arena_stats.h"
 
 #define SCRATCH_ARENA_IMPLEMENTED
 
@@ -14,7 +15,7 @@ ScratchArena createScratchArena(usize arena_size) {
     }
     arena.size = arena_size;
     arena.offset = 0;
-    arena.previous = arena.offset;
+    arena.previous = SCRATCH_NO_MARK;
     return arena;
 }
 
@@ -28,9 +29,11 @@ void* arenaScratchAlloc(ScratchArena* arena, usize alloc_size, usize alignment)
         case ALIGN_32:
         case ALIGN_64:
         case ALIGN_128:
-
+        {
+            usize before = arena->offset;
             if(arena->size < alloc_size || arena->size - arena->offset < alloc_size || arena->size < alignment) {
                 LOG_ERROR("ERROR: allocation request beyond size of arena, return null");
+                ARENA_TRACK_FAIL(arena, "scratch", arena->size, alloc_size);
                 return NULL;
             }
 
@@ -45,27 +48,71 @@ void* arenaScratchAlloc(ScratchArena* arena, usize alloc_size, usize alignment)
 
             if(aligned + arena->offset > arena->size) {
                 LOG_ERROR("ERROR: Arena overflow!");
+                ARENA_TRACK_FAIL(arena, "scratch", arena->size, alloc_size);
                 return NULL;
             }
 
         memptr ptr = (memptr)(arena->base + arena->offset);
         arena->offset += aligned;
+        ARENA_UNPOISON(ptr, aligned);
+        ARENA_TRACK_ALLOC(arena, "scratch", arena->size, alloc_size, before, arena->offset);
         return ptr;
+        }
     }
     LOG_ERROR("Returning null due to unacceptable alignment request on allocation.");
     return NULL;
 }
 
 void resetScratchArena(ScratchArena* arena) {
+    ARENA_POISON(arena->base, arena->offset);
+    ARENA_TRACK_RELEASE(arena, 0);
     arena->offset = 0;
+    arena->previous = SCRATCH_NO_MARK;
 }
 
+//each push stores {offset, enclosing push} in the arena itself, so pushes nest to any depth
 void arenaScratchPush(ScratchArena* arena) {
-    arena->previous = arena->offset;
+    usize mark = arena->offset;
+    usize* link = arenaScratchAlloc(arena, 2 * sizeof(usize), ALIGN_8);
+    if(!link) {
+        LOG_ERROR("No room to push scratch mark");
+        return;
+    }
+    link[0] = mark;
+    link[1] = arena->previous;
+    arena->previous = (usize)((byte)link - arena->base);
 }
 
 void arenaScratchPop(ScratchArena* arena) {
-    arena->offset = arena->previous;
+    if(arena->previous == SCRATCH_NO_MARK) {
+        LOG_ERROR("Scratch pop without a matching push");
+        return;
+    }
+    usize* link = (usize*)(arena->base + arena->previous);
+    usize end = arena->offset;
+    arena->offset = link[0];
+    arena->previous = link[1];
+    ARENA_POISON(arena->base + arena->offset, end - arena->offset);
+    ARENA_TRACK_RELEASE(arena, arena->offset);
+}
+
+ArenaMark arenaScratchSave(ScratchArena* arena) {
+    ArenaMark mark = { .arena = arena, .offset = arena->offset };
+    return mark;
+}
+
+void arenaScratchRestore(ScratchArena* arena, ArenaMark mark) {
+    if(mark.arena != arena || mark.offset > arena->offset) {
+        LOG_ERROR("Scratch mark does not belong to this arena or was already released");
+        return;
+    }
+    //drop pushes made after the mark so a later pop can't land past it
+    while(arena->previous != SCRATCH_NO_MARK && arena->previous >= mark.offset) {
+        arena->previous = ((usize*)(arena->base + arena->previous))[1];
+    }
+    ARENA_POISON(arena->base + mark.offset, arena->offset - mark.offset);
+    ARENA_TRACK_RELEASE(arena, mark.offset);
+    arena->offset = mark.offset;
 }
 
 void destroyScratchArena(ScratchArena* arena) {
@@ -74,6 +121,8 @@ void destroyScratchArena(ScratchArena* arena) {
         return;
     }
     else {
+        ARENA_UNPOISON(arena->base, arena->size);
+        ARENA_TRACK_RETIRE(arena);
         free(arena->base);
         arena->base = NULL;
         arena->size = 0;
@@ -2,6 +2,9 @@
 #define m_SCRATCH_ARENA_H
 
 #include "common_types.h"
+#include "arena_base.h"
+
+#define SCRATCH_NO_MARK ((usize)-1)
 
 typedef struct {
     byte base;
@@ -15,6 +18,8 @@ void* arenaScratchAlloc(ScratchArena* arena, usize alloc_size, usize alignment);
 void resetScratchArena(ScratchArena* arena);
 void arenaScratchPush(ScratchArena* arena);
 void arenaScratchPop(ScratchArena* arena);
+ArenaMark arenaScratchSave(ScratchArena* arena);
+void arenaScratchRestore(ScratchArena* arena, ArenaMark mark);
 void destroyScratchArena(ScratchArena* arena);
 
 #endif
@@ -0,0 +1,42 @@
+#include <stdio.h>
+#include "arena_base.h"
+#include "scratch_pool.h"
+
+i32 scratchPoolInit(ScratchPool* pool, PageArena* arena, u32 count, usize slotSize) {
+    if(count == 0 || count > SCRATCH_POOL_MAX_SLOTS || slotSize == 0) {
+        LOG_ERROR("Scratch pool needs 1 to %d slots of non-zero size", SCRATCH_POOL_MAX_SLOTS);
+        return -1;
+    }
+    //round each buffer to whole cache lines so neighbours never share one
+    slotSize += AlignPad(slotSize, SCRATCH_CACHE_LINE);
+    pool->slots = arenaPageAlloc(arena, count * sizeof(ScratchSlot), ALIGN_64);
+    byte memory = arenaPageAlloc(arena, count * slotSize, ALIGN_64);
+    if(!pool->slots || !memory) {
+        LOG_ERROR("Scratch pool allocation failed.");
+        return -1;
+    }
+    pool->slotSize = slotSize;
+    pool->count = count;
+    for (u32 i = 0; i < count; i++) {
+        ScratchArena* slot = &pool->slots[i].arena;
+        slot->base = memory + i * slotSize;
+        slot->size = slotSize;
+        slot->offset = 0;
+        slot->previous = SCRATCH_NO_MARK;
+    }
+    return 0;
+}
+
+ScratchArena* scratchPoolGet(ScratchPool* pool, u32 index) {
+    if(index >= pool->count) {
+        LOG_ERROR("No scratch slot for worker %u, pool has %u", index, pool->count);
+        return NULL;
+    }
+    return &pool->slots[index].arena;
+}
+
+void scratchPoolReset(ScratchPool* pool) {
+    for (u32 i = 0; i < pool->count; i++) {
+        resetScratchArena(&pool->slots[i].arena);
+    }
+}
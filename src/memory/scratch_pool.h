@@ -0,0 +1,29 @@
+#ifndef m_SCRATCH_POOL_H
+#define m_SCRATCH_POOL_H
+
+#include "common_types.h"
+#include "scratch_arena.h"
+#include "page_arena.h"
+
+#define SCRATCH_POOL_MAX_SLOTS 64
+#define SCRATCH_CACHE_LINE 64
+
+//one arena header per cache line so bumping offsets never shares a line across threads
+typedef struct ScratchSlot {
+    ScratchArena arena;
+    u8 _pad[SCRATCH_CACHE_LINE - sizeof(ScratchArena)];
+} ScratchSlot;
+
+typedef struct ScratchPool {
+    ScratchSlot* slots;
+    usize slotSize;
+    u32 count;
+    u32 _pad;
+} ScratchPool;
+
+//slots live in the page arena, never call destroyScratchArena on them
+i32 scratchPoolInit(ScratchPool* pool, PageArena* arena, u32 count, usize slotSize);
+ScratchArena* scratchPoolGet(ScratchPool* pool, u32 index);
+void scratchPoolReset(ScratchPool* pool);
+
+#endif
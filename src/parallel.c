@@ -0,0 +1,430 @@
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <unistd.h>
+#include "parallel.h"
+#include "page_arena.h"
+#include "arena_stats.h"
+
+//Chase-Lev deque: the owner pushes and pops at bottom, thieves take from top
+typedef struct JobWorker {
+    i64 top;
+    u8 _padTop[56];
+    i64 bottom;
+    Job** buffer;
+    Job* jobs;
+    u32 jobNext;
+    u32 rng;
+    u8 _padBottom[32];
+} JobWorker;
+
+typedef struct JobScheduler {
+    pthread_t threads[PARALLEL_MAX_WORKERS];
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    memMap* map;
+    JobWorker* workers;
+    u32 workerCount;
+    u32 sleeping;
+    u32 shutdown;
+    u32 running;
+} JobScheduler;
+
+typedef struct ParallelRange {
+    ParallelBody body;
+    void* ctx;
+    u32 grain;
+} ParallelRange;
+
+static JobScheduler sched;
+static ScratchPool* workerScratch;
+static __thread JobWorker* self;
+static __thread u32 workerIndex;
+static __thread Job* currentJob;
+
+static i32 dequePush(JobWorker* w, Job* job) {
+    i64 b = __atomic_load_n(&w->bottom, __ATOMIC_RELAXED);
+    i64 t = __atomic_load_n(&w->top, __ATOMIC_ACQUIRE);
+    if(b - t >= JOB_DEQUE_SIZE) {
+        return -1;
+    }
+    __atomic_store_n(&w->buffer[b & (JOB_DEQUE_SIZE - 1)], job, __ATOMIC_RELAXED);
+    //seq_cst so a sleeper that counted itself in before this store is guaranteed to see the job
+    __atomic_store_n(&w->bottom, b + 1, __ATOMIC_SEQ_CST);
+    return 0;
+}
+
+static Job* dequePop(JobWorker* w) {
+    i64 b = __atomic_load_n(&w->bottom, __ATOMIC_RELAXED) - 1;
+    __atomic_store_n(&w->bottom, b, __ATOMIC_SEQ_CST);
+    i64 t = __atomic_load_n(&w->top, __ATOMIC_SEQ_CST);
+    if(t > b) {
+        __atomic_store_n(&w->bottom, b + 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+    Job* job = __atomic_load_n(&w->buffer[b & (JOB_DEQUE_SIZE - 1)], __ATOMIC_RELAXED);
+    if(t == b) {
+        //last job, race the thieves for it
+        if(!__atomic_compare_exchange_n(&w->top, &t, t + 1, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+            job = NULL;
+        }
+        __atomic_store_n(&w->bottom, b + 1, __ATOMIC_RELAXED);
+    }
+    return job;
+}
+
+static Job* dequeSteal(JobWorker* w) {
+    i64 t = __atomic_load_n(&w->top, __ATOMIC_SEQ_CST);
+    i64 b = __atomic_load_n(&w->bottom, __ATOMIC_SEQ_CST);
+    if(t >= b) {
+        return NULL;
+    }
+    Job* job = __atomic_load_n(&w->buffer[t & (JOB_DEQUE_SIZE - 1)], __ATOMIC_RELAXED);
+    if(!__atomic_compare_exchange_n(&w->top, &t, t + 1, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+        return NULL;
+    }
+    return job;
+}
+
+static u32 workAvailable(void) {
+    u32 count = __atomic_load_n(&sched.workerCount, __ATOMIC_ACQUIRE);
+    for (u32 i = 0; i < count; i++) {
+        JobWorker* w = &sched.workers[i];
+        if(__atomic_load_n(&w->bottom, __ATOMIC_SEQ_CST) > __atomic_load_n(&w->top, __ATOMIC_SEQ_CST)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static Job* findJob(void) {
+    if(!self) {
+        return NULL;
+    }
+    Job* job = dequePop(self);
+    if(job) {
+        return job;
+    }
+    u32 count = __atomic_load_n(&sched.workerCount, __ATOMIC_ACQUIRE);
+    self->rng ^= self->rng << 13;
+    self->rng ^= self->rng >> 17;
+    self->rng ^= self->rng << 5;
+    u32 start = self->rng % count;
+    for (u32 i = 0; i < count; i++) {
+        JobWorker* victim = &sched.workers[(start + i) % count];
+        if(victim == self) {
+            continue;
+        }
+        job = dequeSteal(victim);
+        if(job) {
+            return job;
+        }
+    }
+    return NULL;
+}
+
+//sleepers bump the count before checking for work, pushers check the count after publishing
+static void idleSleep(Job* waitFor) {
+    pthread_mutex_lock(&sched.lock);
+    __atomic_add_fetch(&sched.sleeping, 1, __ATOMIC_SEQ_CST);
+    while(!__atomic_load_n(&sched.shutdown, __ATOMIC_SEQ_CST) && !workAvailable() &&
+            !(waitFor && __atomic_load_n(&waitFor->done, __ATOMIC_SEQ_CST))) {
+        pthread_cond_wait(&sched.wake, &sched.lock);
+    }
+    __atomic_sub_fetch(&sched.sleeping, 1, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&sched.lock);
+}
+
+static void wakeWorkers(u32 all) {
+    pthread_mutex_lock(&sched.lock);
+    if(all) {
+        pthread_cond_broadcast(&sched.wake);
+    } else {
+        pthread_cond_signal(&sched.wake);
+    }
+    pthread_mutex_unlock(&sched.lock);
+}
+
+static void finishJob(Job* job) {
+    if(__atomic_sub_fetch(&job->unfinished, 1, __ATOMIC_ACQ_REL) != 0) {
+        return;
+    }
+    //everything we need from the job is read before done, a waiter may drop it right after,
+    //so the wakeup checks the sleeper count like jobSubmit does and never touches the job again
+    Job* parent = job->parent;
+    for (u32 i = 0; i < job->continuationCount; i++) {
+        jobSubmit(job->continuations[i]);
+    }
+    __atomic_store_n(&job->done, 1, __ATOMIC_SEQ_CST);
+    if(__atomic_load_n(&sched.sleeping, __ATOMIC_SEQ_CST) > 0) {
+        wakeWorkers(1);
+    }
+    if(parent) {
+        finishJob(parent);
+    }
+}
+
+static void runJob(Job* job) {
+    Job* outer = currentJob;
+    ScratchArena* scratch = parallelScratch();
+    ArenaMark mark = {0};
+    if(scratch) {
+        if(!outer) {
+            resetScratchArena(scratch);
+        }
+        mark = arenaScratchSave(scratch);
+    }
+    currentJob = job;
+    job->func(job, job->ctx, job->begin, job->end);
+    currentJob = outer;
+    if(scratch) {
+        arenaScratchRestore(scratch, mark);
+    }
+    finishJob(job);
+}
+
+static void* workerMain(void* arg) {
+    workerIndex = (u32)(usize)arg;
+    self = &sched.workers[workerIndex];
+    u32 idle = 0;
+    while(!__atomic_load_n(&sched.shutdown, __ATOMIC_ACQUIRE)) {
+        Job* job = findJob();
+        if(job) {
+            runJob(job);
+            idle = 0;
+        } else if(++idle < JOB_SPIN_ROUNDS) {
+            sched_yield();
+        } else {
+            idleSleep(NULL);
+            idle = 0;
+        }
+    }
+    return NULL;
+}
+
+void parallelInit(u32 workerCount) {
+    if(sched.running) {
+        LOG_ERROR("Parallel pool already initialized.");
+        return;
+    }
+    if(workerCount == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        workerCount = (online > 0) ? (u32)online : 1;
+    }
+    if(workerCount > PARALLEL_MAX_WORKERS) {
+        workerCount = PARALLEL_MAX_WORKERS;
+    }
+
+    //deques and job pools for every worker come out of one arena owned by the scheduler
+    usize perWorker = sizeof(JobWorker) + JOB_POOL_SIZE * sizeof(Job) + JOB_DEQUE_SIZE * sizeof(Job*);
+    sched.map = initMemMap(workerCount * perWorker + MiB(1));
+    PageArena* arena = sched.map ? createPageArena(sched.map, workerCount * (perWorker + 256) + KiB(4)) : NULL;
+    if(!arena) {
+        LOG_ERROR("Failed to allocate job pools, running serial");
+        if(sched.map) {
+            releasePages(sched.map);
+            sched.map = NULL;
+        }
+        return;
+    }
+    ARENA_NAME(arena, "jobs");
+    sched.workers = arenaPageAlloc(arena, workerCount * sizeof(JobWorker), ALIGN_64);
+    for (u32 i = 0; i < workerCount; i++) {
+        JobWorker* w = &sched.workers[i];
+        w->top = 0;
+        w->bottom = 0;
+        w->jobs = arenaPageAlloc(arena, JOB_POOL_SIZE * sizeof(Job), ALIGN_64);
+        w->buffer = arenaPageAlloc(arena, JOB_DEQUE_SIZE * sizeof(Job*), ALIGN_64);
+        w->jobNext = 0;
+        w->rng = 0x9E3779B9u * (i + 1);
+        memset(w->jobs, 0, JOB_POOL_SIZE * sizeof(Job));
+    }
+
+    pthread_mutex_init(&sched.lock, NULL);
+    pthread_cond_init(&sched.wake, NULL);
+    sched.sleeping = 0;
+    sched.shutdown = 0;
+    sched.workerCount = workerCount;
+    sched.running = 1;
+    workerIndex = 0;
+    self = &sched.workers[0];
+
+    //calling thread is worker 0 and runs jobs whenever it waits on one
+    for (u32 i = 1; i < workerCount; i++) {
+        if(pthread_create(&sched.threads[i], NULL, workerMain, (void*)(usize)i) != 0) {
+            LOG_ERROR("Failed to spawn worker %u, continuing with %u workers", i, i);
+            __atomic_store_n(&sched.workerCount, i, __ATOMIC_RELEASE);
+            break;
+        }
+    }
+}
+
+void parallelShutdown(void) {
+    if(!sched.running) {
+        return;
+    }
+    pthread_mutex_lock(&sched.lock);
+    __atomic_store_n(&sched.shutdown, 1, __ATOMIC_SEQ_CST);
+    pthread_cond_broadcast(&sched.wake);
+    pthread_mutex_unlock(&sched.lock);
+    for (u32 i = 1; i < sched.workerCount; i++) {
+        pthread_join(sched.threads[i], NULL);
+    }
+    pthread_cond_destroy(&sched.wake);
+    pthread_mutex_destroy(&sched.lock);
+    arenaPagePop(sched.map);
+    releasePages(sched.map);
+    sched.map = NULL;
+    sched.workers = NULL;
+    sched.workerCount = 0;
+    sched.running = 0;
+    self = NULL;
+}
+
+u32 parallelWorkerCount(void) {
+    return sched.running ? sched.workerCount : 1;
+}
+
+u32 parallelWorkerIndex(void) {
+    return workerIndex;
+}
+
+Job* jobCreate(Job* parent, JobFunc func, void* ctx, u32 begin, u32 end) {
+    if(!self) {
+        LOG_ERROR("Jobs can only be created on a worker thread of a running pool.");
+        return NULL;
+    }
+    //a slot still in flight may belong to an ancestor of the caller, waiting for it could never end, so skip it
+    Job* job = NULL;
+    for (u32 probe = 0; probe < JOB_POOL_PROBE; probe++) {
+        Job* slot = &self->jobs[self->jobNext++ & (JOB_POOL_SIZE - 1)];
+        if(!slot->func || __atomic_load_n(&slot->done, __ATOMIC_ACQUIRE)) {
+            job = slot;
+            break;
+        }
+    }
+    if(!job) {
+        return NULL;
+    }
+    job->func = func;
+    job->ctx = ctx;
+    job->parent = parent;
+    job->begin = begin;
+    job->end = end;
+    job->unfinished = 1;
+    job->waiting = 1;
+    job->done = 0;
+    job->continuationCount = 0;
+    if(parent) {
+        __atomic_add_fetch(&parent->unfinished, 1, __ATOMIC_RELAXED);
+    }
+    return job;
+}
+
+void jobDiscard(Job* job) {
+    Job* parent = job->parent;
+    __atomic_store_n(&job->done, 1, __ATOMIC_RELEASE);
+    if(parent) {
+        finishJob(parent);
+    }
+}
+
+i32 jobDepend(Job* job, Job* before) {
+    if(before->continuationCount >= JOB_MAX_CONTINUATIONS) {
+        LOG_ERROR("Job already has %u continuations", before->continuationCount);
+        return -1;
+    }
+    before->continuations[before->continuationCount++] = job;
+    __atomic_add_fetch(&job->waiting, 1, __ATOMIC_RELAXED);
+    return 0;
+}
+
+void jobSubmit(Job* job) {
+    if(__atomic_sub_fetch(&job->waiting, 1, __ATOMIC_ACQ_REL) != 0) {
+        return;
+    }
+    //full deque or a thread outside the pool, run it right here
+    if(!self || dequePush(self, job) != 0) {
+        runJob(job);
+        return;
+    }
+    if(__atomic_load_n(&sched.sleeping, __ATOMIC_SEQ_CST) > 0) {
+        wakeWorkers(0);
+    }
+}
+
+void jobWait(Job* job) {
+    u32 idle = 0;
+    while(!__atomic_load_n(&job->done, __ATOMIC_ACQUIRE)) {
+        Job* next = findJob();
+        if(next) {
+            runJob(next);
+            idle = 0;
+        } else if(++idle < JOB_SPIN_ROUNDS || !sched.running) {
+            sched_yield();
+        } else {
+            idleSleep(job);
+            idle = 0;
+        }
+    }
+}
+
+Job* jobCurrent(void) {
+    return currentJob;
+}
+
+//split in halves until a piece fits the grain, the halves given away are what other workers steal
+static void runRange(Job* job, void* ctx, u32 begin, u32 end) {
+    ParallelRange* range = ctx;
+    while(end - begin > range->grain) {
+        u32 mid = begin + (end - begin) / 2;
+        Job* half = jobCreate(job, runRange, range, mid, end);
+        if(!half) {
+            break;
+        }
+        jobSubmit(half);
+        end = mid;
+    }
+    range->body(range->ctx, begin, end);
+}
+
+void parallelFor(u32 count, u32 grain, ParallelBody body, void* ctx) {
+    if(count == 0) {
+        return;
+    }
+    if(grain == 0) {
+        grain = 1;
+    }
+    //serial fallback: no pool, or a single chunk
+    if(!sched.running || sched.workerCount < 2 || count <= grain || !self) {
+        if(!currentJob && parallelScratch()) {
+            resetScratchArena(parallelScratch());
+        }
+        body(ctx, 0, count);
+        return;
+    }
+
+    u32 maxPieces = sched.workerCount * PARALLEL_SPLITS_PER_WORKER;
+    if(count / grain > maxPieces) {
+        grain = (count + maxPieces - 1) / maxPieces;
+    }
+    ParallelRange range = { .body = body, .ctx = ctx, .grain = grain };
+    Job* root = jobCreate(NULL, runRange, &range, 0, count);
+    if(!root) {
+        body(ctx, 0, count);
+        return;
+    }
+    jobSubmit(root);
+    jobWait(root);
+}
+
+void parallelSetScratch(ScratchPool* scratch) {
+    if(scratch && scratch->count < parallelWorkerCount()) {
+        LOG_ERROR("Scratch pool has %u slots for %u workers", scratch->count, parallelWorkerCount());
+    }
+    workerScratch = scratch;
+}
+
+ScratchArena* parallelScratch(void) {
+    return workerScratch ? scratchPoolGet(workerScratch, workerIndex) : NULL;
+}
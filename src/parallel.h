@@ -0,0 +1,62 @@
+#ifndef zeta_PARALLEL_H
+#define zeta_PARALLEL_H
+
+#include "common_types.h"
+#include "scratch_pool.h"
+
+#define PARALLEL_MAX_WORKERS 64
+//per worker: a slot is recycled once its job is done, the ring is this long
+#define JOB_POOL_SIZE 4096
+//slots jobCreate looks at past a busy one before giving up, long lived jobs only pin their own slot
+#define JOB_POOL_PROBE 16
+#define JOB_DEQUE_SIZE 4096
+#define JOB_MAX_CONTINUATIONS 6
+//failed rounds of looking for work before an idle worker goes to sleep
+#define JOB_SPIN_ROUNDS 64
+//parallelFor never cuts a range into more than this many pieces per worker
+#define PARALLEL_SPLITS_PER_WORKER 16
+
+//body receives a half open range [begin, end) of the iteration space
+typedef void (*ParallelBody)(void* ctx, u32 begin, u32 end);
+
+typedef struct Job Job;
+typedef void (*JobFunc)(Job* job, void* ctx, u32 begin, u32 end);
+
+//two cache lines, a job is finished once its function and every child returned, then its continuations become runnable
+struct Job {
+    JobFunc func;
+    void* ctx;
+    Job* parent;
+    u32 begin;
+    u32 end;
+    u32 unfinished;
+    u32 waiting;
+    u32 done;
+    u32 continuationCount;
+    u32 _pad[8];
+    Job* continuations[JOB_MAX_CONTINUATIONS];
+};
+
+void parallelInit(u32 workerCount);
+void parallelShutdown(void);
+u32 parallelWorkerCount(void);
+u32 parallelWorkerIndex(void);
+void parallelFor(u32 count, u32 grain, ParallelBody body, void* ctx);
+
+//jobs come from the creating worker's pool, every created job has to be submitted or discarded,
+//NULL when no nearby slot is free, callers then run the work inline
+Job* jobCreate(Job* parent, JobFunc func, void* ctx, u32 begin, u32 end);
+//gives back a created job that will never be submitted
+void jobDiscard(Job* job);
+//job runs only after before finished, both must not be submitted yet
+i32 jobDepend(Job* job, Job* before);
+void jobSubmit(Job* job);
+//runs other jobs on this thread until job is finished
+void jobWait(Job* job);
+Job* jobCurrent(void);
+
+//worker scratch is rolled back around every job, so it only lives for one job or parallelFor
+void parallelSetScratch(ScratchPool* scratch);
+ScratchArena* parallelScratch(void);
+
+#endif
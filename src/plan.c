@@ -0,0 +1,134 @@
+#include "plan.h"
+#include "zeta.h"
+#include "pyramid.h"
+#include "contour.h"
+#include "lod.h"
+#include "colormap.h"
+#include "dirichlet.h"
+#include "expr.h"
+#include "plugin.h"
+#include "page_arena.h"
+#include "scratch_pool.h"
+
+static usize slack(usize bytes) {
+    return bytes + PLAN_ALLOC_SLACK;
+}
+
+//mirrors pyramidInit
+static usize pyramidBytes(u32 w, u32 h) {
+    usize total = 0;
+    u32 lw = (w - 1 + PYRAMID_TILE - 1) / PYRAMID_TILE;
+    u32 lh = (h - 1 + PYRAMID_TILE - 1) / PYRAMID_TILE;
+    for (;;) {
+        total += slack((usize)lw * lh * sizeof(PyramidNode));
+        if(lw == 1 && lh == 1) {
+            return total;
+        }
+        lw = (lw + 1) / 2;
+        lh = (lh + 1) / 2;
+    }
+}
+
+//mirrors contourInit with the default capacities
+static usize contourBytes(u32 w, u32 h) {
+    usize cap = (usize)w * h / CONTOUR_VERTEX_DIVISOR;
+    usize perFamily = slack(cap * sizeof(ZetaVertex)) + slack(cap * 2 * sizeof(u32)) +
+        slack(cap * 2 * sizeof(u32)) + slack(cap) + slack((usize)(w - 1) * (h - 1));
+    return slack(2 * (usize)h * (w - 1) * sizeof(u32)) + slack(2 * (usize)(h - 1) * w * sizeof(u32)) +
+        slack(2 * (usize)h * sizeof(u32)) + slack(CONTOUR_ZERO_CAPACITY * sizeof(ContourZero)) + 2 * perFamily;
+}
+
+//mirrors lodInit, grids too small for a chunk fall back to the full index buffer
+static usize lodBytes(u32 w, u32 h) {
+    if(w < LOD_CHUNK + 1 || h < LOD_CHUNK + 1) {
+        return slack((usize)(w - 1) * (h - 1) * 6 * sizeof(u32));
+    }
+    usize chunks = (usize)((w - 1) / LOD_CHUNK) * ((h - 1) / LOD_CHUNK);
+    return slack(chunks * sizeof(LodChunk)) + slack(chunks * sizeof(LodDraw)) + slack(lodTemplateCapacity() * sizeof(u16));
+}
+
+//row buffers each worker keeps on its stack while evaluating
+static usize evaluatorBytes(u32 evaluator) {
+    switch(evaluator) {
+        case PLAN_EVAL_EXPR:
+            return 2 * EXPR_MAX_REGS * EXPR_LANES * sizeof(f32) + sizeof(ExprProgram);
+        case PLAN_EVAL_PLUGIN:
+            return 4 * PLUGIN_STAGE_SIZE * sizeof(f64);
+    }
+    return (2 * DIRICHLET_MAX_SERIES + 1) * DIRICHLET_ROW_BLOCK * sizeof(f32);
+}
+
+void planMeasure(GridPlan* plan, const PlanRequest* request, u32 w, u32 h) {
+    usize samples = (usize)w * h;
+    usize indexBytes = (w < LOD_CHUNK + 1 || h < LOD_CHUNK + 1) ?
+        (usize)(w - 1) * (h - 1) * 6 * sizeof(u32) : lodTemplateCapacity() * sizeof(u16);
+    //with LOD the upload is a chunk-major copy that lives until the GPU has it
+    usize surfaceVertices = lodVertexCount(lodGridSize(w), lodGridSize(h));
+    usize surfaceVertexSize = (w < LOD_CHUNK + 1 || h < LOD_CHUNK + 1) ? sizeof(ZetaVertex) : lodVertexSize(request->vertexFormat);
+    usize packedBytes = (w < LOD_CHUNK + 1 || h < LOD_CHUNK + 1) ? 0 : slack(surfaceVertices * surfaceVertexSize);
+    usize contourCap = samples / CONTOUR_VERTEX_DIVISOR;
+    usize slotSize = request->workerScratch + AlignPad(request->workerScratch, SCRATCH_CACHE_LINE);
+
+    plan->w = w;
+    plan->h = h;
+    plan->budget = request->budget;
+    plan->field = slack(samples * sizeof(ZetaPoint));
+    plan->vertices = slack(samples * sizeof(ZetaVertex)) + packedBytes;
+    plan->indices = lodBytes(w, h);
+    plan->lattice = request->warped ? slack((usize)w * sizeof(f32)) + slack((usize)h * sizeof(f32)) : 0;
+    plan->pyramid = pyramidBytes(w, h);
+    plan->contour = contourBytes(w, h);
+    plan->workerScratch = request->workers * (slotSize + sizeof(ScratchSlot)) + 2 * PLAN_ALLOC_SLACK;
+    plan->evaluator = request->workers * evaluatorBytes(request->evaluator);
+    //the surface mesh plus both contour families, worst case, and the palette array
+    plan->gpu = surfaceVertices * surfaceVertexSize + indexBytes + 2 * contourCap * (sizeof(ZetaVertex) + 2 * sizeof(u32)) +
+        COLORMAP_BYTES;
+
+    usize host = plan->field + plan->vertices + plan->indices + plan->lattice + plan->pyramid +
+        plan->contour + plan->workerScratch;
+    plan->meshArenaSize = host + AlignPad(host, PAGE_HUGE_SIZE);
+    plan->total = plan->meshArenaSize + plan->evaluator + plan->gpu;
+}
+
+//largest grid of the requested aspect whose every stage fits the budget
+i32 planGrid(GridPlan* plan, const PlanRequest* request) {
+    f32 aspect = (request->aspect > 0.0f) ? request->aspect : 1.0f;
+    u32 lo = 1;
+    u32 hi = PLAN_MAX_SIDE;
+    while(lo < hi) {
+        u32 h = lo + (hi - lo + 1) / 2;
+        f32 wf = (f32)h * aspect + 0.5f;
+        u32 w = (wf < 2.0f) ? 2 : (wf > PLAN_MAX_SIDE) ? PLAN_MAX_SIDE : (u32)wf;
+        planMeasure(plan, request, w, h);
+        //base vertices are GLint, keep every uploaded vertex addressable
+        if(plan->total <= request->budget && lodVertexCount(lodGridSize(w), lodGridSize(h)) < 0x7FFFFFFFu) {
+            lo = h;
+        } else {
+            hi = h - 1;
+        }
+    }
+    if(lo < 2) {
+        planMeasure(plan, request, 2, 2);
+        LOG_ERROR("Memory budget of %zu bytes can't hold a 2x2 grid, needs %zu", request->budget, plan->total);
+        return -1;
+    }
+    f32 wf = (f32)lo * aspect + 0.5f;
+    planMeasure(plan, request, (wf < 2.0f) ? 2 : (wf > PLAN_MAX_SIDE) ? PLAN_MAX_SIDE : (u32)wf, lo);
+    return 0;
+}
+
+void planReport(const GridPlan* plan, FILE* out) {
+    f64 mib = 1.0 / (1024.0 * 1024.0);
+    f64 perSample = 1.0 / ((f64)plan->w * plan->h);
+    fprintf(out, "INFO: grid plan %ux%u for a %.1f MiB budget\n", plan->w, plan->h, plan->budget * mib);
+    fprintf(out, "  %-16s %10s %12s\n", "stage", "MiB", "bytes/sample");
+    const char* names[] = { "field", "vertices", "indices", "lattice", "pyramid", "contour",
+        "worker scratch", "evaluator", "gpu copy" };
+    usize sizes[] = { plan->field, plan->vertices, plan->indices, plan->lattice, plan->pyramid, plan->contour,
+        plan->workerScratch, plan->evaluator, plan->gpu };
+    for (u32 i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        fprintf(out, "  %-16s %10.2f %12.2f\n", names[i], sizes[i] * mib, sizes[i] * perSample);
+    }
+    fprintf(out, "  %-16s %10.2f\n", "mesh arena", plan->meshArenaSize * mib);
+    fprintf(out, "  %-16s %10.2f %12.2f\n", "total", plan->total * mib, plan->total * perSample);
+}
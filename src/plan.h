@@ -0,0 +1,49 @@
+#ifndef zeta_PLAN_H
+#define zeta_PLAN_H
+
+#include <stdio.h>
+#include "common_types.h"
+
+//bytes allowed per arena allocation for alignment padding
+#define PLAN_ALLOC_SLACK 128
+#define PLAN_MAX_SIDE 65535
+
+typedef enum PlanEvaluator {
+    PLAN_EVAL_ZETA,
+    PLAN_EVAL_EXPR,
+    PLAN_EVAL_PLUGIN
+} PlanEvaluator;
+
+typedef struct PlanRequest {
+    usize budget;
+    f32 aspect;
+    u32 evaluator;
+    u32 warped;
+    u32 vertexFormat;
+    u32 workers;
+    usize workerScratch;
+} PlanRequest;
+
+//every stage in bytes for one grid size, the mesh arena holds all host stages
+typedef struct GridPlan {
+    u32 w;
+    u32 h;
+    usize field;
+    usize vertices;
+    usize indices;
+    usize lattice;
+    usize pyramid;
+    usize contour;
+    usize workerScratch;
+    usize evaluator;
+    usize gpu;
+    usize meshArenaSize;
+    usize total;
+    usize budget;
+} GridPlan;
+
+void planMeasure(GridPlan* plan, const PlanRequest* request, u32 w, u32 h);
+i32 planGrid(GridPlan* plan, const PlanRequest* request);
+void planReport(const GridPlan* plan, FILE* out);
+
+#endif
@@ -0,0 +1,156 @@
+#include <dirent.h>
+#include <dlfcn.h>
+#include <stdio.h>
+#include <string.h>
+#include "plugin.h"
+
+static u32 hasSharedSuffix(const char* name) {
+    usize len = strlen(name);
+    if(len > 3 && strcmp(name + len - 3, ".so") == 0) return 1;
+    if(len > 6 && strcmp(name + len - 6, ".dylib") == 0) return 1;
+    return 0;
+}
+
+static u32 validPlugin(const ZetaPluginInfo* info, const char* path) {
+    if(!info) {
+        LOG_ERROR("Plugin %s returned no description", path);
+        return 0;
+    }
+    if(info->abiVersion != ZETA_PLUGIN_ABI_VERSION) {
+        LOG_ERROR("Plugin %s built for ABI %u, host is %d", path, info->abiVersion, ZETA_PLUGIN_ABI_VERSION);
+        return 0;
+    }
+    if(!info->name) {
+        LOG_ERROR("Plugin %s has no name", path);
+        return 0;
+    }
+    u32 hasF32 = (info->flags & ZETA_PLUGIN_F32) && info->evaluateF32;
+    u32 hasF64 = (info->flags & ZETA_PLUGIN_F64) && info->evaluateF64;
+    if(!hasF32 && !hasF64) {
+        LOG_ERROR("Plugin %s declares no usable evaluate function", path);
+        return 0;
+    }
+    return 1;
+}
+
+u32 pluginDiscover(PluginRegistry* registry, const char* directory) {
+    DIR* dir = opendir(directory);
+    if(!dir) {
+        return registry->count;
+    }
+
+    struct dirent* entry;
+    while((entry = readdir(dir)) != NULL) {
+        if(!hasSharedSuffix(entry->d_name)) {
+            continue;
+        }
+        if(registry->count >= PLUGIN_MAX_COUNT) {
+            LOG_ERROR("Plugin registry full, skipping %s", entry->d_name);
+            break;
+        }
+
+        ZetaPlugin* plugin = &registry->plugins[registry->count];
+        int length = snprintf(plugin->path, PLUGIN_PATH_SIZE, "%s/%s", directory, entry->d_name);
+        if(length < 0 || length >= PLUGIN_PATH_SIZE) {
+            LOG_ERROR("Plugin path %s/%s longer than %d bytes, skipping", directory, entry->d_name, PLUGIN_PATH_SIZE - 1);
+            continue;
+        }
+        plugin->handle = dlopen(plugin->path, RTLD_NOW | RTLD_LOCAL);
+        if(!plugin->handle) {
+            LOG_ERROR("dlopen failed: %s", dlerror());
+            continue;
+        }
+
+        ZetaPluginDescribeFunc describe;
+        *(void**)(&describe) = dlsym(plugin->handle, ZETA_PLUGIN_ENTRY);
+        if(!describe) {
+            LOG_ERROR("Plugin %s does not export %s", plugin->path, ZETA_PLUGIN_ENTRY);
+            dlclose(plugin->handle);
+            continue;
+        }
+        plugin->info = describe();
+        if(!validPlugin(plugin->info, plugin->path)) {
+            dlclose(plugin->handle);
+            continue;
+        }
+        if(pluginFind(registry, plugin->info->name)) {
+            LOG_ERROR("Duplicate plugin name %s, skipping %s", plugin->info->name, plugin->path);
+            dlclose(plugin->handle);
+            continue;
+        }
+
+        pthread_mutex_init(&plugin->lock, NULL);
+        registry->count++;
+        fprintf(stdout, "INFO: plugin '%s' from %s, %s%s, batch %u, %s\n", plugin->info->name, plugin->path,
+                (plugin->info->flags & ZETA_PLUGIN_F32) ? "f32 " : "",
+                (plugin->info->flags & ZETA_PLUGIN_F64) ? "f64 " : "",
+                plugin->info->batchWidth,
+                (plugin->info->flags & ZETA_PLUGIN_THREAD_SAFE) ? "thread safe" : "serialized");
+    }
+    closedir(dir);
+    return registry->count;
+}
+
+void pluginUnloadAll(PluginRegistry* registry) {
+    for (u32 k = 0; k < registry->count; k++) {
+        pthread_mutex_destroy(&registry->plugins[k].lock);
+        dlclose(registry->plugins[k].handle);
+        registry->plugins[k].handle = NULL;
+        registry->plugins[k].info = NULL;
+    }
+    registry->count = 0;
+}
+
+ZetaPlugin* pluginFind(PluginRegistry* registry, const char* name) {
+    for (u32 k = 0; k < registry->count; k++) {
+        if(strcmp(registry->plugins[k].info->name, name) == 0) {
+            return &registry->plugins[k];
+        }
+    }
+    return NULL;
+}
+
+//rows run on the pool either way, kernels that are not thread safe are entered one at a time
+void pluginRow(void* ctx, const f32* sigma, f32 t, u32 count, f32* re_out, f32* im_out) {
+    ZetaPlugin* plugin = ctx;
+    const ZetaPluginInfo* info = plugin->info;
+    u32 width = (info->batchWidth == 0 || info->batchWidth > PLUGIN_STAGE_SIZE) ? PLUGIN_STAGE_SIZE : info->batchWidth;
+    u32 serialize = !(info->flags & ZETA_PLUGIN_THREAD_SAFE);
+    u32 useF32 = (info->flags & ZETA_PLUGIN_F32) && info->evaluateF32;
+
+    f32 tLane[PLUGIN_STAGE_SIZE];
+    f64 stageRe[PLUGIN_STAGE_SIZE];
+    f64 stageIm[PLUGIN_STAGE_SIZE];
+    f64 outRe[PLUGIN_STAGE_SIZE];
+    f64 outIm[PLUGIN_STAGE_SIZE];
+    for (u32 l = 0; l < width; l++) {
+        tLane[l] = t;
+        stageIm[l] = t;
+    }
+
+    for (u32 base = 0; base < count; base += width) {
+        u32 n = (count - base < width) ? count - base : width;
+        if(!useF32) {
+            for (u32 l = 0; l < n; l++) {
+                stageRe[l] = sigma[base + l];
+            }
+        }
+        if(serialize) {
+            pthread_mutex_lock(&plugin->lock);
+        }
+        if(useF32) {
+            info->evaluateF32(info->state, sigma + base, tLane, n, re_out + base, im_out + base);
+        } else {
+            info->evaluateF64(info->state, stageRe, stageIm, n, outRe, outIm);
+        }
+        if(serialize) {
+            pthread_mutex_unlock(&plugin->lock);
+        }
+        if(!useF32) {
+            for (u32 l = 0; l < n; l++) {
+                re_out[base + l] = (f32)outRe[l];
+                im_out[base + l] = (f32)outIm[l];
+            }
+        }
+    }
+}
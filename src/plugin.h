@@ -0,0 +1,30 @@
+#ifndef zeta_PLUGIN_H
+#define zeta_PLUGIN_H
+
+#include <pthread.h>
+#include "common_types.h"
+#include "plugin_api.h"
+#include "zeta.h"
+
+#define PLUGIN_MAX_COUNT 16
+#define PLUGIN_PATH_SIZE 256
+#define PLUGIN_STAGE_SIZE 256
+
+typedef struct ZetaPlugin {
+    void* handle;
+    const ZetaPluginInfo* info;
+    pthread_mutex_t lock;
+    char path[PLUGIN_PATH_SIZE];
+} ZetaPlugin;
+
+typedef struct PluginRegistry {
+    u32 count;
+    ZetaPlugin plugins[PLUGIN_MAX_COUNT];
+} PluginRegistry;
+
+u32 pluginDiscover(PluginRegistry* registry, const char* directory);
+void pluginUnloadAll(PluginRegistry* registry);
+ZetaPlugin* pluginFind(PluginRegistry* registry, const char* name);
+void pluginRow(void* ctx, const f32* sigma, f32 t, u32 count, f32* re_out, f32* im_out);
+
+#endif
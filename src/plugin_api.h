@@ -0,0 +1,34 @@
+#ifndef zeta_PLUGIN_API_H
+#define zeta_PLUGIN_API_H
+
+//ABI shared with external kernels, plugins only need this header
+#include <stdint.h>
+
+#define ZETA_PLUGIN_ABI_VERSION 1
+#define ZETA_PLUGIN_ENTRY "zetaPluginDescribe"
+
+typedef enum ZetaPluginFlags {
+    ZETA_PLUGIN_F32         = 1 << 0,
+    ZETA_PLUGIN_F64         = 1 << 1,
+    ZETA_PLUGIN_THREAD_SAFE = 1 << 2
+} ZetaPluginFlags;
+
+//evaluate f(s) for count points s = sre + i sim, count never exceeds batchWidth
+typedef void (*ZetaPluginEvalF32)(void* state, const float* sre, const float* sim, uint32_t count,
+        float* re_out, float* im_out);
+typedef void (*ZetaPluginEvalF64)(void* state, const double* sre, const double* sim, uint32_t count,
+        double* re_out, double* im_out);
+
+typedef struct ZetaPluginInfo {
+    uint32_t abiVersion;
+    uint32_t flags;
+    uint32_t batchWidth;
+    const char* name;
+    ZetaPluginEvalF32 evaluateF32;
+    ZetaPluginEvalF64 evaluateF64;
+    void* state;
+} ZetaPluginInfo;
+
+typedef const ZetaPluginInfo* (*ZetaPluginDescribeFunc)(void);
+
+#endif
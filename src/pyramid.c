@@ -0,0 +1,275 @@
+#include <float.h>
+#include "arena_base.h"
+#include "pyramid.h"
+#include "parallel.h"
+
+typedef struct PyramidJob {
+    ZetaPyramid* pyramid;
+    const ZetaPoint* grid;
+    u32 level;
+    u32 x0;
+    u32 x1;
+    u32 y0;
+} PyramidJob;
+
+static void emptyNode(PyramidNode* node) {
+    node->minMag = FLT_MAX;
+    node->maxMag = -FLT_MAX;
+    node->minArg = FLT_MAX;
+    node->maxArg = -FLT_MAX;
+    node->flags = 0;
+}
+
+static void mergeNode(PyramidNode* into, const PyramidNode* from) {
+    into->minMag = (from->minMag < into->minMag) ? from->minMag : into->minMag;
+    into->maxMag = (from->maxMag > into->maxMag) ? from->maxMag : into->maxMag;
+    into->minArg = (from->minArg < into->minArg) ? from->minArg : into->minArg;
+    into->maxArg = (from->maxArg > into->maxArg) ? from->maxArg : into->maxArg;
+    into->flags |= from->flags;
+}
+
+static u32 signFlags(const ZetaPoint* zp) {
+    u32 flags = 0;
+    flags |= (zp->re >= 0.0f) ? PYRAMID_RE_POS : 0;
+    flags |= (zp->re <= 0.0f) ? PYRAMID_RE_NEG : 0;
+    flags |= (zp->im >= 0.0f) ? PYRAMID_IM_POS : 0;
+    flags |= (zp->im <= 0.0f) ? PYRAMID_IM_NEG : 0;
+    return flags;
+}
+
+static void tileSamples(const ZetaPyramid* pyramid, u32 level, u32 tx, u32 ty, u32* x0, u32* y0, u32* x1, u32* y1) {
+    u32 span = PYRAMID_TILE << level;
+    *x0 = tx * span;
+    *y0 = ty * span;
+    *x1 = (*x0 + span < pyramid->w - 1) ? *x0 + span : pyramid->w - 1;
+    *y1 = (*y0 + span < pyramid->h - 1) ? *y0 + span : pyramid->h - 1;
+}
+
+static void computeTile(ZetaPyramid* pyramid, const ZetaPoint* grid, u32 tx, u32 ty) {
+    u32 x0, y0, x1, y1;
+    tileSamples(pyramid, 0, tx, ty, &x0, &y0, &x1, &y1);
+    PyramidNode node;
+    emptyNode(&node);
+    for (u32 y = y0; y <= y1; y++) {
+        const ZetaPoint* row = &grid[(usize)y * pyramid->w];
+        for (u32 x = x0; x <= x1; x++) {
+            const ZetaPoint* zp = &row[x];
+            node.minMag = (zp->mag < node.minMag) ? zp->mag : node.minMag;
+            node.maxMag = (zp->mag > node.maxMag) ? zp->mag : node.maxMag;
+            node.minArg = (zp->arg < node.minArg) ? zp->arg : node.minArg;
+            node.maxArg = (zp->arg > node.maxArg) ? zp->arg : node.maxArg;
+            node.flags |= signFlags(zp);
+        }
+    }
+    pyramid->levels[0][ty * pyramid->levelW[0] + tx] = node;
+}
+
+static void computeParent(ZetaPyramid* pyramid, u32 level, u32 tx, u32 ty) {
+    const PyramidNode* below = pyramid->levels[level - 1];
+    u32 bw = pyramid->levelW[level - 1];
+    u32 bh = pyramid->levelH[level - 1];
+    PyramidNode node;
+    emptyNode(&node);
+    for (u32 cy = ty * 2; cy < ty * 2 + 2 && cy < bh; cy++) {
+        for (u32 cx = tx * 2; cx < tx * 2 + 2 && cx < bw; cx++) {
+            mergeNode(&node, &below[cy * bw + cx]);
+        }
+    }
+    pyramid->levels[level][ty * pyramid->levelW[level] + tx] = node;
+}
+
+static void buildRows(void* ctx, u32 begin, u32 end) {
+    PyramidJob* job = ctx;
+    for (u32 ty = job->y0 + begin; ty < job->y0 + end; ty++) {
+        for (u32 tx = job->x0; tx <= job->x1; tx++) {
+            if(job->level == 0) {
+                computeTile(job->pyramid, job->grid, tx, ty);
+            } else {
+                computeParent(job->pyramid, job->level, tx, ty);
+            }
+        }
+    }
+}
+
+i32 pyramidInit(ZetaPyramid* pyramid, PageArena* arena, u32 w, u32 h) {
+    if(w < 2 || h < 2) {
+        LOG_ERROR("Pyramid needs at least a 2x2 grid, got %ux%u", w, h);
+        return -1;
+    }
+    pyramid->w = w;
+    pyramid->h = h;
+    u32 lw = (w - 1 + PYRAMID_TILE - 1) / PYRAMID_TILE;
+    u32 lh = (h - 1 + PYRAMID_TILE - 1) / PYRAMID_TILE;
+    u32 level = 0;
+    for (;;) {
+        if(level >= PYRAMID_MAX_LEVELS) {
+            LOG_ERROR("Pyramid deeper than %d levels", PYRAMID_MAX_LEVELS);
+            return -1;
+        }
+        pyramid->levelW[level] = lw;
+        pyramid->levelH[level] = lh;
+        pyramid->levels[level] = arenaPageAlloc(arena, (usize)lw * lh * sizeof(PyramidNode), ALIGN_16);
+        if(!pyramid->levels[level]) {
+            LOG_ERROR("Pyramid level %u allocation failed.", level);
+            return -1;
+        }
+        level++;
+        if(lw == 1 && lh == 1) {
+            break;
+        }
+        lw = (lw + 1) / 2;
+        lh = (lh + 1) / 2;
+    }
+    pyramid->levelCount = level;
+    return 0;
+}
+
+static void rebuildRange(ZetaPyramid* pyramid, const ZetaPoint* grid, u32 tx0, u32 ty0, u32 tx1, u32 ty1) {
+    for (u32 level = 0; level < pyramid->levelCount; level++) {
+        PyramidJob job = {
+            .pyramid = pyramid,
+            .grid = grid,
+            .level = level,
+            .x0 = tx0,
+            .x1 = tx1,
+            .y0 = ty0
+        };
+        parallelFor(ty1 - ty0 + 1, 4, buildRows, &job);
+        tx0 >>= 1;
+        ty0 >>= 1;
+        tx1 >>= 1;
+        ty1 >>= 1;
+    }
+}
+
+void pyramidBuild(ZetaPyramid* pyramid, const ZetaPoint* grid) {
+    rebuildRange(pyramid, grid, 0, 0, pyramid->levelW[0] - 1, pyramid->levelH[0] - 1);
+}
+
+//samples on a tile edge belong to both neighbours, so widen by one on the low side
+void pyramidUpdate(ZetaPyramid* pyramid, const ZetaPoint* grid, u32 x0, u32 y0, u32 x1, u32 y1) {
+    u32 tw = pyramid->levelW[0];
+    u32 th = pyramid->levelH[0];
+    u32 tx0 = (x0 == 0) ? 0 : (x0 - 1) / PYRAMID_TILE;
+    u32 ty0 = (y0 == 0) ? 0 : (y0 - 1) / PYRAMID_TILE;
+    u32 tx1 = x1 / PYRAMID_TILE;
+    u32 ty1 = y1 / PYRAMID_TILE;
+    tx1 = (tx1 < tw) ? tx1 : tw - 1;
+    ty1 = (ty1 < th) ? ty1 : th - 1;
+    if(tx0 > tx1 || ty0 > ty1) {
+        return;
+    }
+    rebuildRange(pyramid, grid, tx0, ty0, tx1, ty1);
+}
+
+static u32 queryNode(const ZetaPyramid* pyramid, const PyramidQuery* query, u32 level, u32 tx, u32 ty,
+        PyramidVisit visit, void* ctx) {
+    if(tx >= pyramid->levelW[level] || ty >= pyramid->levelH[level]) {
+        return 0;
+    }
+    u32 x0, y0, x1, y1;
+    tileSamples(pyramid, level, tx, ty, &x0, &y0, &x1, &y1);
+    if(x1 < query->x0 || x0 > query->x1 || y1 < query->y0 || y0 > query->y1) {
+        return 0;
+    }
+    const PyramidNode* node = &pyramid->levels[level][ty * pyramid->levelW[level] + tx];
+    if(node->minMag > query->magBelow || (node->flags & query->requireFlags) != query->requireFlags) {
+        return 0;
+    }
+    if(level == 0) {
+        if(visit) {
+            visit(ctx, tx, ty, node);
+        }
+        return 1;
+    }
+    u32 hits = 0;
+    for (u32 cy = 0; cy < 2; cy++) {
+        for (u32 cx = 0; cx < 2; cx++) {
+            hits += queryNode(pyramid, query, level - 1, tx * 2 + cx, ty * 2 + cy, visit, ctx);
+        }
+    }
+    return hits;
+}
+
+u32 pyramidQuery(const ZetaPyramid* pyramid, const PyramidQuery* query, PyramidVisit visit, void* ctx) {
+    return queryNode(pyramid, query, pyramid->levelCount - 1, 0, 0, visit, ctx);
+}
+
+typedef struct ZeroSearch {
+    const ZetaPyramid* pyramid;
+    const ZetaPoint* grid;
+    f32 magBelow;
+    PyramidCell* cells;
+    u32 maxCells;
+    u32 count;
+} ZeroSearch;
+
+static void zeroVisit(void* ctx, u32 tileX, u32 tileY, const PyramidNode* node) {
+    ZeroSearch* search = ctx;
+    u32 w = search->pyramid->w;
+    u32 x0, y0, x1, y1;
+    tileSamples(search->pyramid, 0, tileX, tileY, &x0, &y0, &x1, &y1);
+    for (u32 y = y0; y < y1; y++) {
+        for (u32 x = x0; x < x1; x++) {
+            const ZetaPoint* a = &search->grid[(usize)y * w + x];
+            const ZetaPoint* b = a + 1;
+            const ZetaPoint* c = a + w;
+            const ZetaPoint* d = c + 1;
+            u32 flags = signFlags(a) | signFlags(b) | signFlags(c) | signFlags(d);
+            if((flags & (PYRAMID_RE_CHANGE | PYRAMID_IM_CHANGE)) != (PYRAMID_RE_CHANGE | PYRAMID_IM_CHANGE)) {
+                continue;
+            }
+            f32 mag = a->mag;
+            mag = (b->mag < mag) ? b->mag : mag;
+            mag = (c->mag < mag) ? c->mag : mag;
+            mag = (d->mag < mag) ? d->mag : mag;
+            if(mag > search->magBelow) {
+                continue;
+            }
+            if(search->count < search->maxCells) {
+                search->cells[search->count].x = x;
+                search->cells[search->count].y = y;
+            }
+            search->count++;
+        }
+    }
+}
+
+//cells where Re and Im both change sign and the magnitude dips below the bound,
+//returns the full count even when cells fills up
+u32 pyramidZeroCandidates(const ZetaPyramid* pyramid, const ZetaPoint* grid, f32 magBelow,
+        PyramidCell* cells, u32 maxCells) {
+    PyramidQuery query = {
+        .x0 = 0,
+        .y0 = 0,
+        .x1 = pyramid->w - 1,
+        .y1 = pyramid->h - 1,
+        .magBelow = magBelow,
+        .requireFlags = PYRAMID_RE_CHANGE | PYRAMID_IM_CHANGE
+    };
+    ZeroSearch search = {
+        .pyramid = pyramid,
+        .grid = grid,
+        .magBelow = magBelow,
+        .cells = cells,
+        .maxCells = maxCells,
+        .count = 0
+    };
+    pyramidQuery(pyramid, &query, zeroVisit, &search);
+    return search.count;
+}
+
+//coarsest level whose node over (x, y) keeps |f| within the tolerance
+u32 pyramidSelectLevel(const ZetaPyramid* pyramid, u32 x, u32 y, f32 magTolerance) {
+    u32 tx = x / PYRAMID_TILE;
+    u32 ty = y / PYRAMID_TILE;
+    tx = (tx < pyramid->levelW[0]) ? tx : pyramid->levelW[0] - 1;
+    ty = (ty < pyramid->levelH[0]) ? ty : pyramid->levelH[0] - 1;
+    for (u32 level = pyramid->levelCount; level-- > 0;) {
+        const PyramidNode* node = &pyramid->levels[level][(ty >> level) * pyramid->levelW[level] + (tx >> level)];
+        if(node->maxMag - node->minMag <= magTolerance) {
+            return level;
+        }
+    }
+    return 0;
+}
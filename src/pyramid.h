@@ -0,0 +1,65 @@
+#ifndef zeta_PYRAMID_H
+#define zeta_PYRAMID_H
+
+#include "common_types.h"
+#include "page_arena.h"
+#include "zeta.h"
+
+#define PYRAMID_TILE 8
+#define PYRAMID_MAX_LEVELS 24
+
+typedef enum PyramidFlags {
+    PYRAMID_RE_POS = 1 << 0,
+    PYRAMID_RE_NEG = 1 << 1,
+    PYRAMID_IM_POS = 1 << 2,
+    PYRAMID_IM_NEG = 1 << 3
+} PyramidFlags;
+
+#define PYRAMID_RE_CHANGE (PYRAMID_RE_POS | PYRAMID_RE_NEG)
+#define PYRAMID_IM_CHANGE (PYRAMID_IM_POS | PYRAMID_IM_NEG)
+
+typedef struct PyramidNode {
+    f32 minMag;
+    f32 maxMag;
+    f32 minArg;
+    f32 maxArg;
+    u32 flags;
+} PyramidNode;
+
+//level 0 tiles cover PYRAMID_TILE cells and share their edge samples with neighbours,
+//every level above halves each axis until one node covers the whole grid
+typedef struct ZetaPyramid {
+    u32 w;
+    u32 h;
+    u32 levelCount;
+    u32 levelW[PYRAMID_MAX_LEVELS];
+    u32 levelH[PYRAMID_MAX_LEVELS];
+    PyramidNode* levels[PYRAMID_MAX_LEVELS];
+} ZetaPyramid;
+
+typedef struct PyramidQuery {
+    u32 x0;
+    u32 y0;
+    u32 x1;
+    u32 y1;
+    f32 magBelow;
+    u32 requireFlags;
+} PyramidQuery;
+
+typedef struct PyramidCell {
+    u32 x;
+    u32 y;
+} PyramidCell;
+
+//called for each level 0 tile that survives pruning
+typedef void (*PyramidVisit)(void* ctx, u32 tileX, u32 tileY, const PyramidNode* node);
+
+i32 pyramidInit(ZetaPyramid* pyramid, PageArena* arena, u32 w, u32 h);
+void pyramidBuild(ZetaPyramid* pyramid, const ZetaPoint* grid);
+void pyramidUpdate(ZetaPyramid* pyramid, const ZetaPoint* grid, u32 x0, u32 y0, u32 x1, u32 y1);
+u32 pyramidQuery(const ZetaPyramid* pyramid, const PyramidQuery* query, PyramidVisit visit, void* ctx);
+u32 pyramidZeroCandidates(const ZetaPyramid* pyramid, const ZetaPoint* grid, f32 magBelow,
+        PyramidCell* cells, u32 maxCells);
+u32 pyramidSelectLevel(const ZetaPyramid* pyramid, u32 x, u32 y, f32 magTolerance);
+
+#endif
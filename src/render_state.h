@@ -0,0 +1,225 @@
+#ifndef zeta_RENDER_STATE_H
+#define zeta_RENDER_STATE_H
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <glad/gl.h>
+#include "common_types.h"
+#include "linmath.h"
+
+//every program declares the Frame block and reads it from this binding point
+#define RENDER_FRAME_BINDING 0
+#define RENDER_FRAME_BLOCK "Frame"
+
+//what changed since the block was last uploaded, input and window callbacks set these
+#define RENDER_DIRTY_PROJECTION 0x1u
+#define RENDER_DIRTY_VIEW 0x2u
+#define RENDER_DIRTY_MODEL 0x4u
+#define RENDER_DIRTY_PARAMS 0x8u
+#define RENDER_DIRTY_ALL 0xFu
+
+//std140 layout of the Frame block, mat4 and vec4 members need no padding
+typedef struct FrameUniforms {
+    mat4x4 projection;
+    mat4x4 view;
+    mat4x4 model;
+    //x wire line width in pixels, y palette layer, z 1 for the wire overlay
+    vec4 params;
+} FrameUniforms;
+
+typedef enum RenderCall {
+    RENDER_CALL_STATE,
+    RENDER_CALL_UNIFORM,
+    RENDER_CALL_UPLOAD,
+    RENDER_CALL_DRAW,
+    RENDER_CALL_CLEAR,
+    RENDER_CALL_QUERY,
+    RENDER_CALLS
+} RenderCall;
+
+//the bound state the render loop touches, calls that would set what is already bound are skipped and counted
+typedef struct RenderState {
+    FrameUniforms frame;
+    GLuint frameBuffer;
+    u32 dirty;
+    GLuint program;
+    GLuint vertexArray;
+    u32 restart;
+    GLuint restartIndex;
+    GLenum polygonMode;
+    u32 calls[RENDER_CALLS];
+    u32 skipped;
+    u32 lastCalls[RENDER_CALLS];
+    u32 lastSkipped;
+    u64 totalCalls[RENDER_CALLS];
+    u64 totalSkipped;
+    u32 frames;
+} RenderState;
+
+#define RENDER_COUNT(state, kind) ((state)->calls[(kind)]++)
+
+void renderStateInit(RenderState* state);
+void renderStateFree(RenderState* state);
+void renderBindFrameBlock(GLuint program);
+void renderFrameParams(RenderState* state, f32 lineWidth, u32 palette, u32 overlay);
+void renderFrameUpload(RenderState* state);
+void renderFrameEnd(RenderState* state);
+void renderUseProgram(RenderState* state, GLuint program);
+void renderBindVertexArray(RenderState* state, GLuint vertexArray);
+void renderPrimitiveRestart(RenderState* state, u32 enable, GLuint index);
+void renderPolygonMode(RenderState* state, GLenum mode);
+void renderStatsReport(const RenderState* state, FILE* out);
+
+#endif
+
+static const char* renderCallNames[RENDER_CALLS] = { "state", "uniform", "upload", "draw", "clear", "query" };
+
+//puts the context into the state the cache starts from, so the two never disagree
+void renderStateInit(RenderState* state) {
+    memset(state, 0, sizeof(RenderState));
+    mat4x4_identity(state->frame.projection);
+    mat4x4_identity(state->frame.view);
+    mat4x4_identity(state->frame.model);
+    state->dirty = RENDER_DIRTY_ALL;
+    state->polygonMode = GL_FILL;
+    glGenBuffers(1, &state->frameBuffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, state->frameBuffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), NULL, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, RENDER_FRAME_BINDING, state->frameBuffer);
+    glUseProgram(0);
+    glBindVertexArray(0);
+    glDisable(GL_PRIMITIVE_RESTART);
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+}
+
+void renderStateFree(RenderState* state) {
+    glDeleteBuffers(1, &state->frameBuffer);
+    state->frameBuffer = 0;
+}
+
+void renderBindFrameBlock(GLuint program) {
+    GLuint block = glGetUniformBlockIndex(program, RENDER_FRAME_BLOCK);
+    if(block == GL_INVALID_INDEX) {
+        LOG_ERROR("Program %u has no %s block", program, RENDER_FRAME_BLOCK);
+        return;
+    }
+    glUniformBlockBinding(program, block, RENDER_FRAME_BINDING);
+}
+
+void renderFrameParams(RenderState* state, f32 lineWidth, u32 palette, u32 overlay) {
+    vec4 params = { lineWidth, (f32)palette, (f32)overlay, 0.f };
+    if(memcmp(params, state->frame.params, sizeof(vec4)) != 0) {
+        memcpy(state->frame.params, params, sizeof(vec4));
+        state->dirty |= RENDER_DIRTY_PARAMS;
+    }
+}
+
+//one write covering the first through last dirty member, nothing when the frame matches the last one
+void renderFrameUpload(RenderState* state) {
+    if(!state->dirty) {
+        return;
+    }
+    static const usize offsets[] = { offsetof(FrameUniforms, projection), offsetof(FrameUniforms, view),
+        offsetof(FrameUniforms, model), offsetof(FrameUniforms, params), sizeof(FrameUniforms) };
+    u32 first = 0;
+    while(!(state->dirty & (1u << first))) {
+        first++;
+    }
+    u32 last = 3;
+    while(!(state->dirty & (1u << last))) {
+        last--;
+    }
+    //bound every upload rather than trusting the generic target, anything may rebind it between frames
+    glBindBuffer(GL_UNIFORM_BUFFER, state->frameBuffer);
+    RENDER_COUNT(state, RENDER_CALL_STATE);
+    glBufferSubData(GL_UNIFORM_BUFFER, offsets[first], offsets[last + 1] - offsets[first],
+            (const u8*)&state->frame + offsets[first]);
+    RENDER_COUNT(state, RENDER_CALL_UPLOAD);
+    state->dirty = 0;
+}
+
+void renderFrameEnd(RenderState* state) {
+    for (u32 k = 0; k < RENDER_CALLS; k++) {
+        state->lastCalls[k] = state->calls[k];
+        state->totalCalls[k] += state->calls[k];
+        state->calls[k] = 0;
+    }
+    state->lastSkipped = state->skipped;
+    state->totalSkipped += state->skipped;
+    state->skipped = 0;
+    state->frames++;
+}
+
+void renderUseProgram(RenderState* state, GLuint program) {
+    if(state->program == program) {
+        state->skipped++;
+        return;
+    }
+    glUseProgram(program);
+    RENDER_COUNT(state, RENDER_CALL_STATE);
+    state->program = program;
+}
+
+void renderBindVertexArray(RenderState* state, GLuint vertexArray) {
+    if(state->vertexArray == vertexArray) {
+        state->skipped++;
+        return;
+    }
+    glBindVertexArray(vertexArray);
+    RENDER_COUNT(state, RENDER_CALL_STATE);
+    state->vertexArray = vertexArray;
+}
+
+//the index only matters while restart is on, so it is left alone when disabling
+void renderPrimitiveRestart(RenderState* state, u32 enable, GLuint index) {
+    if(state->restart != enable) {
+        if(enable) {
+            glEnable(GL_PRIMITIVE_RESTART);
+        } else {
+            glDisable(GL_PRIMITIVE_RESTART);
+        }
+        RENDER_COUNT(state, RENDER_CALL_STATE);
+        state->restart = enable;
+    } else {
+        state->skipped++;
+    }
+    if(!enable) {
+        return;
+    }
+    if(state->restartIndex != index) {
+        glPrimitiveRestartIndex(index);
+        RENDER_COUNT(state, RENDER_CALL_STATE);
+        state->restartIndex = index;
+    } else {
+        state->skipped++;
+    }
+}
+
+void renderPolygonMode(RenderState* state, GLenum mode) {
+    if(state->polygonMode == mode) {
+        state->skipped++;
+        return;
+    }
+    glPolygonMode(GL_FRONT_AND_BACK, mode);
+    RENDER_COUNT(state, RENDER_CALL_STATE);
+    state->polygonMode = mode;
+}
+
+void renderStatsReport(const RenderState* state, FILE* out) {
+    u32 issued = 0;
+    fprintf(out, "INFO: gl calls last frame:");
+    for (u32 k = 0; k < RENDER_CALLS; k++) {
+        fprintf(out, " %s %u", renderCallNames[k], state->lastCalls[k]);
+        issued += state->lastCalls[k];
+    }
+    fprintf(out, ", %u issued, %u redundant skipped\n", issued, state->lastSkipped);
+    if(state->frames == 0) {
+        return;
+    }
+    fprintf(out, "INFO: gl calls per frame over %u frames:", state->frames);
+    for (u32 k = 0; k < RENDER_CALLS; k++) {
+        fprintf(out, " %s %.2f", renderCallNames[k], (f64)state->totalCalls[k] / state->frames);
+    }
+    fprintf(out, ", %.2f redundant skipped\n", (f64)state->totalSkipped / state->frames);
+}
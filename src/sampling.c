@@ -0,0 +1,238 @@
+#include <math.h>
+#include "arena_base.h"
+#include "sampling.h"
+#include "parallel.h"
+
+#define SAMPLING_TWO_PI 6.28318530717958647692
+#define SAMPLING_ROW_BLOCK 256
+#define SAMPLING_SOLVE_ITERATIONS 60
+
+//Riemann-von Mangoldt: zeros per unit t near height t is (1/2pi) log(t/2pi), none below 2pi
+static f64 zeroCount(f64 t) {
+    f64 x = fabs(t);
+    f64 n = (x > SAMPLING_TWO_PI) ? (x / SAMPLING_TWO_PI) * (log(x / SAMPLING_TWO_PI) - 1.0) + 1.0 : 0.0;
+    return (t < 0.0) ? -n : n;
+}
+
+static f64 zeroDensity(f64 t) {
+    f64 x = fabs(t);
+    return (x > SAMPLING_TWO_PI) ? log(x / SAMPLING_TWO_PI) / SAMPLING_TWO_PI : 0.0;
+}
+
+static f64 cumulative(const AxisMap* axis, f64 x) {
+    switch(axis->warp) {
+        case AXIS_LOG:
+            return asinh(x / axis->scale);
+        case AXIS_ZERO_DENSITY:
+            return axis->strength * x + zeroCount(x);
+        case AXIS_CRITICAL:
+            return x + axis->strength * axis->scale * atan((x - axis->focus) / axis->scale);
+        default:
+            return x;
+    }
+}
+
+static f64 density(const AxisMap* axis, f64 x) {
+    switch(axis->warp) {
+        case AXIS_LOG:
+            return 1.0 / (axis->scale * sqrt(1.0 + (x / axis->scale) * (x / axis->scale)));
+        case AXIS_ZERO_DENSITY:
+            return axis->strength + zeroDensity(x);
+        case AXIS_CRITICAL: {
+            f64 d = (x - axis->focus) / axis->scale;
+            return 1.0 + axis->strength / (1.0 + d * d);
+        }
+        default:
+            return 1.0;
+    }
+}
+
+static void axisFinish(AxisMap* axis) {
+    axis->cmin = cumulative(axis, axis->min);
+    axis->cmax = cumulative(axis, axis->max);
+}
+
+void axisUniform(AxisMap* axis, f32 min, f32 max) {
+    axis->warp = AXIS_UNIFORM;
+    axis->min = min;
+    axis->max = max;
+    axis->focus = 0.0f;
+    axis->scale = 1.0f;
+    axis->strength = 0.0f;
+    axisFinish(axis);
+}
+
+//asinh rather than log so the axis may cross zero, it is logarithmic for |x| >> scale
+void axisLog(AxisMap* axis, f32 min, f32 max, f32 scale) {
+    axisUniform(axis, min, max);
+    if(!(scale > 0.0f)) {
+        LOG_ERROR("Log axis scale must be positive, got %f, using uniform axis", scale);
+        return;
+    }
+    axis->warp = AXIS_LOG;
+    axis->scale = scale;
+    axisFinish(axis);
+}
+
+void axisZeroDensity(AxisMap* axis, f32 min, f32 max, f32 floorDensity) {
+    axisUniform(axis, min, max);
+    if(!(floorDensity > 0.0f)) {
+        LOG_ERROR("Zero density axis needs a positive floor density, got %f, using uniform axis", floorDensity);
+        return;
+    }
+    axis->warp = AXIS_ZERO_DENSITY;
+    axis->strength = floorDensity;
+    axisFinish(axis);
+}
+
+void axisCritical(AxisMap* axis, f32 min, f32 max, f32 focus, f32 width, f32 strength) {
+    axisUniform(axis, min, max);
+    if(!(width > 0.0f) || strength < 0.0f) {
+        LOG_ERROR("Critical axis needs width > 0 and strength >= 0, using uniform axis");
+        return;
+    }
+    axis->warp = AXIS_CRITICAL;
+    axis->focus = focus;
+    axis->scale = width;
+    axis->strength = strength;
+    axisFinish(axis);
+}
+
+f32 axisForward(const AxisMap* axis, f32 u) {
+    if(axis->warp == AXIS_UNIFORM) {
+        return axis->min + u * (axis->max - axis->min);
+    }
+    f64 target = axis->cmin + (f64)u * (axis->cmax - axis->cmin);
+    if(axis->warp == AXIS_LOG) {
+        return (f32)(axis->scale * sinh(target));
+    }
+
+    //F is monotone, Newton steps kept inside a shrinking bracket
+    f64 lo = fmin(axis->min, axis->max);
+    f64 hi = fmax(axis->min, axis->max);
+    f64 x = axis->min + (f64)u * (axis->max - axis->min);
+    for (u32 k = 0; k < SAMPLING_SOLVE_ITERATIONS; k++) {
+        f64 f = cumulative(axis, x) - target;
+        if(fabs(f) < 1e-12 * (1.0 + fabs(target))) {
+            break;
+        }
+        if(f > 0.0) hi = x; else lo = x;
+        f64 next = x - f / density(axis, x);
+        x = (next > lo && next < hi) ? next : 0.5 * (lo + hi);
+    }
+    return (f32)x;
+}
+
+f32 axisInverse(const AxisMap* axis, f32 value) {
+    f64 span = axis->cmax - axis->cmin;
+    if(span == 0.0) {
+        return 0.0f;
+    }
+    return (f32)((cumulative(axis, value) - axis->cmin) / span);
+}
+
+i32 latticeInit(SampleLattice* lattice, PageArena* arena, u32 w, u32 h, const AxisMap* sigmaAxis, const AxisMap* tAxis) {
+    if(w < 2 || h < 2) {
+        LOG_ERROR("Sample lattice needs at least 2x2 samples, got %ux%u", w, h);
+        return -1;
+    }
+    lattice->sigma = arenaPageAlloc(arena, w * sizeof(f32), ALIGN_16);
+    lattice->t = arenaPageAlloc(arena, h * sizeof(f32), ALIGN_16);
+    if(!lattice->sigma || !lattice->t) {
+        LOG_ERROR("Sample lattice allocation failed.");
+        return -1;
+    }
+    lattice->w = w;
+    lattice->h = h;
+    lattice->sigmaAxis = *sigmaAxis;
+    lattice->tAxis = *tAxis;
+    for (u32 j = 0; j < w; j++) {
+        lattice->sigma[j] = axisForward(sigmaAxis, (f32)j / (w - 1));
+    }
+    for (u32 i = 0; i < h; i++) {
+        lattice->t[i] = axisForward(tAxis, (f32)i / (h - 1));
+    }
+    return 0;
+}
+
+void latticePick(const SampleLattice* lattice, f32 sigma, f32 t, f32* gx, f32* gy) {
+    *gx = axisInverse(&lattice->sigmaAxis, sigma) * (lattice->w - 1);
+    *gy = axisInverse(&lattice->tAxis, t) * (lattice->h - 1);
+}
+
+typedef struct LatticeJob {
+    ZetaPoint* grid;
+    ZetaVertex* vertexGrid;
+    const SampleLattice* lattice;
+    ComplexRowFunc func;
+    void* ctx;
+} LatticeJob;
+
+static void populateLatticeRows(void* ctx, u32 begin, u32 end) {
+    LatticeJob* job = ctx;
+    const SampleLattice* lattice = job->lattice;
+    f32 re[SAMPLING_ROW_BLOCK];
+    f32 im[SAMPLING_ROW_BLOCK];
+
+    for (u32 i = begin; i < end; i++) {
+        for (u32 j0 = 0; j0 < lattice->w; j0 += SAMPLING_ROW_BLOCK) {
+            u32 block = (lattice->w - j0 < SAMPLING_ROW_BLOCK) ? lattice->w - j0 : SAMPLING_ROW_BLOCK;
+            usize base = (usize)i * lattice->w + j0;
+            job->func(job->ctx, lattice->sigma + j0, lattice->t[i], block, re, im);
+            storeMeshRow(&job->grid[base], &job->vertexGrid[base], lattice->sigma + j0, lattice->t[i], block, re, im);
+        }
+    }
+}
+
+void populateMeshLattice(ZetaPoint* grid, ZetaVertex* vertexGrid, const SampleLattice* lattice,
+        ComplexRowFunc func, void* ctx) {
+    LatticeJob job = {
+        .grid = grid,
+        .vertexGrid = vertexGrid,
+        .lattice = lattice,
+        .func = func,
+        .ctx = ctx
+    };
+    parallelFor(lattice->h, 1, populateLatticeRows, &job);
+}
+
+static f32 vertexDistance2(const ZetaVertex* a, const ZetaVertex* b) {
+    f32 dx = a->re - b->re;
+    f32 dy = a->im - b->im;
+    f32 dz = a->mag - b->mag;
+    return dx * dx + dy * dy + dz * dz;
+}
+
+//same quad layout as generateMesh, but each quad splits along its shorter diagonal in
+//rendered space so cells stretched by the warp do not turn into slivers
+void generateMeshLattice(u32* indices, const ZetaVertex* vertexGrid, u32 grid_w, u32 grid_h) {
+    u32 idx = 0;
+
+    for (u32 i = 0; i < grid_h - 1; i++) {
+        for (u32 j = 0; j < grid_w - 1; j++) {
+            u32 topLeft = i * grid_w + j;
+            u32 topRight = i * grid_w + (j + 1);
+            u32 bottomLeft = (i + 1) * grid_w + j;
+            u32 bottomRight = (i + 1) * grid_w + (j + 1);
+
+            if(vertexDistance2(&vertexGrid[bottomLeft], &vertexGrid[topRight]) <=
+                    vertexDistance2(&vertexGrid[topLeft], &vertexGrid[bottomRight])) {
+                indices[idx++] = topLeft;
+                indices[idx++] = bottomLeft;
+                indices[idx++] = topRight;
+
+                indices[idx++] = topRight;
+                indices[idx++] = bottomLeft;
+                indices[idx++] = bottomRight;
+            } else {
+                indices[idx++] = topLeft;
+                indices[idx++] = bottomLeft;
+                indices[idx++] = bottomRight;
+
+                indices[idx++] = topLeft;
+                indices[idx++] = bottomRight;
+                indices[idx++] = topRight;
+            }
+        }
+    }
+}
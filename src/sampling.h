@@ -0,0 +1,49 @@
+#ifndef zeta_SAMPLING_H
+#define zeta_SAMPLING_H
+
+#include "common_types.h"
+#include "page_arena.h"
+#include "zeta.h"
+
+typedef enum AxisWarp {
+    AXIS_UNIFORM,
+    AXIS_LOG,
+    AXIS_ZERO_DENSITY,
+    AXIS_CRITICAL
+} AxisWarp;
+
+//samples are spaced evenly in a cumulative density F, so x_k = F^-1(lerp(F(min), F(max), k / (n - 1)))
+typedef struct AxisMap {
+    AxisWarp warp;
+    f32 min;
+    f32 max;
+    f32 focus;
+    f32 scale;
+    f32 strength;
+    f64 cmin;
+    f64 cmax;
+} AxisMap;
+
+typedef struct SampleLattice {
+    u32 w;
+    u32 h;
+    AxisMap sigmaAxis;
+    AxisMap tAxis;
+    f32* sigma;
+    f32* t;
+} SampleLattice;
+
+void axisUniform(AxisMap* axis, f32 min, f32 max);
+void axisLog(AxisMap* axis, f32 min, f32 max, f32 scale);
+void axisZeroDensity(AxisMap* axis, f32 min, f32 max, f32 floorDensity);
+void axisCritical(AxisMap* axis, f32 min, f32 max, f32 focus, f32 width, f32 strength);
+f32 axisForward(const AxisMap* axis, f32 u);
+f32 axisInverse(const AxisMap* axis, f32 value);
+
+i32 latticeInit(SampleLattice* lattice, PageArena* arena, u32 w, u32 h, const AxisMap* sigmaAxis, const AxisMap* tAxis);
+void latticePick(const SampleLattice* lattice, f32 sigma, f32 t, f32* gx, f32* gy);
+void populateMeshLattice(ZetaPoint* grid, ZetaVertex* vertexGrid, const SampleLattice* lattice,
+        ComplexRowFunc func, void* ctx);
+void generateMeshLattice(u32* indices, const ZetaVertex* vertexGrid, u32 grid_w, u32 grid_h);
+
+#endif
@@ -9,73 +9,67 @@ typedef struct Shader {
 } Shader;
 
 Shader loadGlShaders(ScratchArena* arena, const char* vertexPath, const char* fragmentPath);
+Shader loadGlShaderStages(ScratchArena* arena, const char* vertexPath, const char* geometryPath, const char* fragmentPath);
 
 #endif
 
 #define STRING_BUFFER 512
 
-Shader loadGlShaders(ScratchArena* arena, const char* vertexPath, const char* fragmentPath) {
-    arenaScratchPush(arena);
-
-    FILE *vertexFile = fopen(vertexPath, "rb");
-    if(!vertexFile) {
-        fprintf(stderr, "ERROR: Failed to load vertex file.\n");
+static char* readShaderSource(ScratchArena* arena, const char* path, const char* stage) {
+    FILE *file = fopen(path, "rb");
+    if(!file) {
+        fprintf(stderr, "ERROR: Failed to load %s file.\n", stage);
         arenaScratchPop(arena);
         exit(-1);
     }
 
-    fseek(vertexFile, 0, SEEK_END);
-    long fileSize = ftell(vertexFile);
-    rewind(vertexFile);
-
-    char* vertSource = arenaScratchAlloc(arena, fileSize + 1, 1);
-    fread(vertSource, 1, fileSize, vertexFile);
-    vertSource[fileSize] = '\0';
-    fclose(vertexFile);
-
-    FILE *fragmentFile = fopen(fragmentPath, "rb");
-    if(!fragmentFile) {
-        fprintf(stderr, "ERROR: Failed to load fragment file.\n");
-        arenaScratchPop(arena);
-        exit(-1);
-    }
-   
-    fseek(fragmentFile, 0, SEEK_END);
-    fileSize = ftell(fragmentFile);
-    rewind(fragmentFile);
+    fseek(file, 0, SEEK_END);
+    long fileSize = ftell(file);
+    rewind(file);
 
-    char* fragSource = arenaScratchAlloc(arena, fileSize + 1, 1);
-    fread(fragSource, 1, fileSize, fragmentFile);
-    fragSource[fileSize] = '\0';
-    fclose(fragmentFile);
+    char* source = arenaScratchAlloc(arena, fileSize + 1, 1);
+    fread(source, 1, fileSize, file);
+    source[fileSize] = '\0';
+    fclose(file);
+    return source;
+}
 
-    GLuint vertex, fragment;
+static GLuint compileShaderStage(GLenum type, const char* source, const char* stage) {
     int success;
     char infoLog[STRING_BUFFER];
 
-    vertex = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex, 1, (const char**)&vertSource, NULL);
-    glCompileShader(vertex);
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, NULL);
+    glCompileShader(shader);
 
-    glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
     if(!success) {
-        glGetShaderInfoLog(vertex, STRING_BUFFER, NULL, infoLog);
-        fprintf(stderr, "ERROR: Vertex Shader: %s\n", infoLog);
+        glGetShaderInfoLog(shader, STRING_BUFFER, NULL, infoLog);
+        fprintf(stderr, "ERROR: %s Shader: %s\n", stage, infoLog);
     }
+    return shader;
+}
 
-    fragment = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment, 1, (const char**)&fragSource, NULL);
-    glCompileShader(fragment);
+//geometryPath may be NULL for a plain vertex + fragment program
+Shader loadGlShaderStages(ScratchArena* arena, const char* vertexPath, const char* geometryPath, const char* fragmentPath) {
+    arenaScratchPush(arena);
 
-    glGetShaderiv(fragment, GL_COMPILE_STATUS, &success);
-    if(!success) {
-        glGetShaderInfoLog(fragment, STRING_BUFFER, NULL, infoLog);
-        fprintf(stderr, "ERROR: Fragment Shader: %s\n", infoLog);
-    }
+    char* vertSource = readShaderSource(arena, vertexPath, "vertex");
+    char* geomSource = geometryPath ? readShaderSource(arena, geometryPath, "geometry") : NULL;
+    char* fragSource = readShaderSource(arena, fragmentPath, "fragment");
 
+    GLuint vertex = compileShaderStage(GL_VERTEX_SHADER, vertSource, "Vertex");
+    GLuint geometry = geomSource ? compileShaderStage(GL_GEOMETRY_SHADER, geomSource, "Geometry") : 0;
+    GLuint fragment = compileShaderStage(GL_FRAGMENT_SHADER, fragSource, "Fragment");
+
+    int success;
+    char infoLog[STRING_BUFFER];
     Shader temp;
     temp.ID = glCreateProgram();
     glAttachShader(temp.ID, vertex);
+    if(geometry) {
+        glAttachShader(temp.ID, geometry);
+    }
     glAttachShader(temp.ID, fragment);
     glLinkProgram(temp.ID);
 
@@ -86,6 +80,9 @@ Shader loadGlShaders(ScratchArena* arena, const char* vertexPath, const char* fr
     }
 
     glDeleteShader(vertex);
+    if(geometry) {
+        glDeleteShader(geometry);
+    }
     glDeleteShader(fragment);
 
     arenaScratchPop(arena);
@@ -93,3 +90,6 @@ Shader loadGlShaders(ScratchArena* arena, const char* vertexPath, const char* fr
     return temp;
 }
 
+Shader loadGlShaders(ScratchArena* arena, const char* vertexPath, const char* fragmentPath) {
+    return loadGlShaderStages(arena, vertexPath, NULL, fragmentPath);
+}
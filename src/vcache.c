@@ -0,0 +1,240 @@
+#include <math.h>
+#include <float.h>
+#include <string.h>
+#include "arena_base.h"
+#include "vcache.h"
+
+#define VCACHE_NONE 0xFFFFFFFFu
+//valences below this are scored from a table, grids never get close
+#define VCACHE_VALENCE_TABLE 32
+
+//both score terms precomputed, the inner loop rescores the whole cache after every triangle
+typedef struct VcacheScores {
+    f32 position[VCACHE_SIZE];
+    f32 valence[VCACHE_VALENCE_TABLE];
+} VcacheScores;
+
+static i32 checkIndices(const u32* indices, u32 count, u32 vertexCount) {
+    if(count % 3 != 0) {
+        LOG_ERROR("Expected a triangle list, got %u indices", count);
+        return -1;
+    }
+    for (u32 i = 0; i < count; i++) {
+        if(indices[i] >= vertexCount) {
+            LOG_ERROR("Index %u out of range for %u vertices", indices[i], vertexCount);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+//FIFO replacement like most hardware, a vertex is a hit while fewer than cacheSize misses came after it
+i32 vcacheMeasure(VcacheStats* stats, const u32* indices, u32 count, u32 vertexCount, u32 cacheSize, PageArena* arena) {
+    if(checkIndices(indices, count, vertexCount) != 0) {
+        return -1;
+    }
+    u32 lineCount = vertexCount / VCACHE_LINE_VERTICES + 1;
+    ArenaMark mark = arenaPageSave(arena);
+    u32* stamp = arenaPageAlloc(arena, (usize)vertexCount * sizeof(u32), ALIGN_16);
+    u32* lineStamp = arenaPageAlloc(arena, (usize)lineCount * sizeof(u32), ALIGN_16);
+    if(!stamp || !lineStamp) {
+        LOG_ERROR("No room to measure %u vertices", vertexCount);
+        arenaPageRestore(arena, mark);
+        return -1;
+    }
+    memset(stamp, 0, (usize)vertexCount * sizeof(u32));
+    memset(lineStamp, 0, (usize)lineCount * sizeof(u32));
+    u32 misses = 0;
+    u32 distinct = 0;
+    u32 lines = 0;
+    for (u32 i = 0; i < count; i++) {
+        u32 v = indices[i];
+        if(stamp[v] != 0 && misses - stamp[v] < cacheSize) {
+            continue;
+        }
+        distinct += (stamp[v] == 0);
+        stamp[v] = ++misses;
+        //only a shaded vertex is fetched
+        u32 line = v / VCACHE_LINE_VERTICES;
+        if(lineStamp[line] == 0 || lines - lineStamp[line] >= VCACHE_FETCH_LINES) {
+            lineStamp[line] = ++lines;
+        }
+    }
+    arenaPageRestore(arena, mark);
+
+    stats->triangles = count / 3;
+    stats->vertices = distinct;
+    stats->transforms = misses;
+    stats->lines = lines;
+    stats->acmr = stats->triangles ? (f32)misses / stats->triangles : 0.0f;
+    stats->atvr = distinct ? (f32)misses / distinct : 0.0f;
+    stats->fetch = misses ? (f32)lines / misses : 0.0f;
+    return 0;
+}
+
+//recently used vertices score high so their triangles go next, few remaining triangles score high so no vertex is left stranded
+static void initScores(VcacheScores* scores) {
+    for (u32 p = 0; p < VCACHE_SIZE; p++) {
+        scores->position[p] = (p < 3) ? VCACHE_LAST_TRIANGLE_SCORE :
+            powf(1.0f - (f32)(p - 3) / (VCACHE_SIZE - 3), VCACHE_DECAY_POWER);
+    }
+    scores->valence[0] = -1.0f;
+    for (u32 v = 1; v < VCACHE_VALENCE_TABLE; v++) {
+        scores->valence[v] = VCACHE_VALENCE_SCALE * powf((f32)v, -VCACHE_VALENCE_POWER);
+    }
+}
+
+static f32 vertexScore(const VcacheScores* scores, i32 position, u32 remaining) {
+    if(remaining == 0) {
+        return -1.0f;
+    }
+    f32 score = (position >= 0) ? scores->position[position] : 0.0f;
+    return score + ((remaining < VCACHE_VALENCE_TABLE) ? scores->valence[remaining] :
+            VCACHE_VALENCE_SCALE * powf((f32)remaining, -VCACHE_VALENCE_POWER));
+}
+
+i32 vcacheOptimize(u32* indices, u32 count, u32 vertexCount, PageArena* arena) {
+    if(checkIndices(indices, count, vertexCount) != 0) {
+        return -1;
+    }
+    u32 triCount = count / 3;
+    VcacheScores scores;
+    initScores(&scores);
+    ArenaMark mark = arenaPageSave(arena);
+    u32* offsets = arenaPageAlloc(arena, (usize)vertexCount * sizeof(u32), ALIGN_16);
+    u32* remaining = arenaPageAlloc(arena, (usize)vertexCount * sizeof(u32), ALIGN_16);
+    i32* position = arenaPageAlloc(arena, (usize)vertexCount * sizeof(i32), ALIGN_16);
+    f32* score = arenaPageAlloc(arena, (usize)vertexCount * sizeof(f32), ALIGN_16);
+    u32* adjacency = arenaPageAlloc(arena, (usize)count * sizeof(u32), ALIGN_16);
+    u32* out = arenaPageAlloc(arena, (usize)count * sizeof(u32), ALIGN_16);
+    u8* added = arenaPageAlloc(arena, triCount, ALIGN_16);
+    if(!offsets || !remaining || !position || !score || !adjacency || !out || !added) {
+        LOG_ERROR("No room to reorder %u triangles", triCount);
+        arenaPageRestore(arena, mark);
+        return -1;
+    }
+
+    //each vertex's triangles sit in adjacency[offsets[v], offsets[v] + remaining[v])
+    memset(remaining, 0, (usize)vertexCount * sizeof(u32));
+    memset(added, 0, triCount);
+    for (u32 i = 0; i < count; i++) {
+        remaining[indices[i]]++;
+    }
+    u32 sum = 0;
+    for (u32 v = 0; v < vertexCount; v++) {
+        offsets[v] = sum;
+        sum += remaining[v];
+        remaining[v] = 0;
+    }
+    for (u32 i = 0; i < count; i++) {
+        u32 v = indices[i];
+        adjacency[offsets[v] + remaining[v]++] = i / 3;
+    }
+    for (u32 v = 0; v < vertexCount; v++) {
+        position[v] = -1;
+        score[v] = vertexScore(&scores, -1, remaining[v]);
+    }
+
+    u32 best = VCACHE_NONE;
+    f32 bestScore = -FLT_MAX;
+    for (u32 t = 0; t < triCount; t++) {
+        f32 s = score[indices[t * 3]] + score[indices[t * 3 + 1]] + score[indices[t * 3 + 2]];
+        if(s > bestScore) {
+            bestScore = s;
+            best = t;
+        }
+    }
+
+    u32 cache[VCACHE_SIZE + 3];
+    u32 cacheCount = 0;
+    u32 cursor = 0;
+    for (u32 i = 0; i < triCount; i++) {
+        //nothing in the cache has triangles left, restart from the first one not emitted
+        if(best == VCACHE_NONE) {
+            while(added[cursor]) {
+                cursor++;
+            }
+            best = cursor;
+        }
+        const u32* tri = &indices[best * 3];
+        memcpy(&out[i * 3], tri, 3 * sizeof(u32));
+        added[best] = 1;
+        for (u32 k = 0; k < 3; k++) {
+            u32 v = tri[k];
+            u32* list = &adjacency[offsets[v]];
+            for (u32 j = 0; j < remaining[v]; j++) {
+                if(list[j] == best) {
+                    list[j] = list[remaining[v] - 1];
+                    remaining[v]--;
+                    break;
+                }
+            }
+        }
+
+        //the triangle's vertices move to the front, whatever is pushed past VCACHE_SIZE falls out
+        u32 next[VCACHE_SIZE + 3];
+        u32 nextCount = 0;
+        for (u32 k = 0; k < 3; k++) {
+            next[nextCount++] = tri[k];
+        }
+        for (u32 j = 0; j < cacheCount; j++) {
+            u32 v = cache[j];
+            if(v != tri[0] && v != tri[1] && v != tri[2]) {
+                next[nextCount++] = v;
+            }
+        }
+        for (u32 j = 0; j < nextCount; j++) {
+            u32 v = next[j];
+            position[v] = (j < VCACHE_SIZE) ? (i32)j : -1;
+            score[v] = vertexScore(&scores, position[v], remaining[v]);
+        }
+        cacheCount = (nextCount < VCACHE_SIZE) ? nextCount : VCACHE_SIZE;
+        memcpy(cache, next, cacheCount * sizeof(u32));
+
+        best = VCACHE_NONE;
+        bestScore = -FLT_MAX;
+        for (u32 j = 0; j < cacheCount; j++) {
+            u32 v = cache[j];
+            for (u32 a = 0; a < remaining[v]; a++) {
+                u32 t = adjacency[offsets[v] + a];
+                f32 s = score[indices[t * 3]] + score[indices[t * 3 + 1]] + score[indices[t * 3 + 2]];
+                if(s > bestScore) {
+                    bestScore = s;
+                    best = t;
+                }
+            }
+        }
+    }
+    memcpy(indices, out, (usize)count * sizeof(u32));
+    arenaPageRestore(arena, mark);
+    return 0;
+}
+
+i32 vcacheVertexOrder(u32* indices, u32 count, u32 vertexCount, u32* order, PageArena* arena) {
+    if(checkIndices(indices, count, vertexCount) != 0) {
+        return -1;
+    }
+    ArenaMark mark = arenaPageSave(arena);
+    u32* remap = arenaPageAlloc(arena, (usize)vertexCount * sizeof(u32), ALIGN_16);
+    if(!remap) {
+        LOG_ERROR("No room to reorder %u vertices", vertexCount);
+        return -1;
+    }
+    memset(remap, 0xFF, (usize)vertexCount * sizeof(u32));
+    u32 next = 0;
+    for (u32 i = 0; i < count; i++) {
+        u32 v = indices[i];
+        if(remap[v] == VCACHE_NONE) {
+            remap[v] = next;
+            order[next++] = v;
+        }
+        indices[i] = remap[v];
+    }
+    for (u32 v = 0; v < vertexCount; v++) {
+        if(remap[v] == VCACHE_NONE) {
+            order[next++] = v;
+        }
+    }
+    arenaPageRestore(arena, mark);
+    return 0;
+}
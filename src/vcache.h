@@ -0,0 +1,38 @@
+#ifndef zeta_VCACHE_H
+#define zeta_VCACHE_H
+
+#include "common_types.h"
+#include "page_arena.h"
+
+//entries of the LRU cache Forsyth's scoring models, real caches may be smaller or FIFO
+#define VCACHE_SIZE 32
+#define VCACHE_LAST_TRIANGLE_SCORE 0.75f
+#define VCACHE_DECAY_POWER 1.5f
+#define VCACHE_VALENCE_SCALE 2.0f
+#define VCACHE_VALENCE_POWER 0.5f
+//pre-transform fetches are modelled as a FIFO of this many lines holding VCACHE_LINE_VERTICES vertices each,
+//four ZetaVertex per 64 byte line
+#define VCACHE_FETCH_LINES 8
+#define VCACHE_LINE_VERTICES 4
+
+//acmr is vertex shader runs per triangle, atvr runs per distinct vertex, 1.0 is ideal for atvr and about 0.5 for a grid's acmr,
+//fetch is lines loaded per shaded vertex, 1 / VCACHE_LINE_VERTICES when the vertex buffer is read in order
+typedef struct VcacheStats {
+    u32 triangles;
+    u32 vertices;
+    u32 transforms;
+    u32 lines;
+    f32 acmr;
+    f32 atvr;
+    f32 fetch;
+} VcacheStats;
+
+//all of these take triangle lists, temporaries come from arena and are rolled back before returning
+i32 vcacheMeasure(VcacheStats* stats, const u32* indices, u32 count, u32 vertexCount, u32 cacheSize, PageArena* arena);
+//Forsyth's linear-speed ordering, rewrites indices in place
+i32 vcacheOptimize(u32* indices, u32 count, u32 vertexCount, PageArena* arena);
+//renumbers vertices in first use order so fetches walk the vertex buffer forwards, order[new] = old,
+//vertices no triangle uses go last
+i32 vcacheVertexOrder(u32* indices, u32 count, u32 vertexCount, u32* order, PageArena* arena);
+
+#endif
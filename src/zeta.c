@@ -1,6 +1,11 @@
 #include <math.h>
 #include "zeta.h"
 #include "linmath.h"
+#include "dirichlet.h"
+#include "parallel.h"
+
+#define ZETA_ROW_BLOCK 256
+#define ZETA_TERMS 100
 
 void generateMesh(u32* indices, u32 grid_w, u32 grid_h) {
     u32 idx = 0;
@@ -25,32 +30,97 @@ void generateMesh(u32* indices, u32 grid_w, u32 grid_h) {
     }
 }
 
+typedef struct RowJob {
+    ZetaPoint* grid;
+    ZetaVertex* gridVert;
+    u32 w;
+    u32 h;
+    f32 sigma_min;
+    f32 sigma_max;
+    f32 t_min;
+    f32 t_max;
+    ComplexRowFunc func;
+    void* ctx;
+} RowJob;
+
+typedef struct ScalarAdapter {
+    ComplexFunc func;
+} ScalarAdapter;
+
+static void scalarRow(void* ctx, const f32* sigma, f32 t, u32 count, f32* re_out, f32* im_out) {
+    ScalarAdapter* adapter = ctx;
+    for (u32 j = 0; j < count; j++) {
+        adapter->func(sigma[j], t, &re_out[j], &im_out[j]);
+    }
+}
+
+static void populateRows(void* ctx, u32 begin, u32 end) {
+    RowJob* job = ctx;
+    f32 sigma[ZETA_ROW_BLOCK];
+    f32 re[ZETA_ROW_BLOCK];
+    f32 im[ZETA_ROW_BLOCK];
+
+    for (u32 i = begin; i < end; i++) {
+        f32 t = job->t_min + i * (job->t_max - job->t_min) / (job->h - 1);
+        for (u32 j0 = 0; j0 < job->w; j0 += ZETA_ROW_BLOCK) {
+            u32 block = (job->w - j0 < ZETA_ROW_BLOCK) ? job->w - j0 : ZETA_ROW_BLOCK;
+            for (u32 j = 0; j < block; j++) {
+                sigma[j] = job->sigma_min + (j0 + j) * (job->sigma_max - job->sigma_min) / (job->w - 1);
+            }
+            job->func(job->ctx, sigma, t, block, re, im);
+            usize base = (usize)i * job->w + j0;
+            storeMeshRow(&job->grid[base], &job->gridVert[base], sigma, t, block, re, im);
+        }
+    }
+}
+
+void storeMeshRow(ZetaPoint* gridRow, ZetaVertex* vertexRow, const f32* sigma, f32 t, u32 count, 
+        const f32* re, const f32* im) {
+    for (u32 j = 0; j < count; j++) {
+        ZetaPoint* zp = &gridRow[j];
+        ZetaVertex* zv = &vertexRow[j];
+        zp->sigma = sigma[j];
+        zp->t = t;
+        zp->re = re[j];
+        zp->im = im[j];
+        zp->mag = sqrtf(re[j] * re[j] + im[j] * im[j]);
+        zp->arg = atan2f(im[j], re[j]);
+        zv->re = re[j];
+        zv->im = im[j];
+        zv->mag = zp->mag;
+        zv->arg = zp->arg;
+    }
+}
+
+void populateMeshRows(ZetaPoint* grid, ZetaVertex* gridVert, u32 w, u32 h, f32 sigma_min, f32 sigma_max, 
+        f32 t_min, f32 t_max, ComplexRowFunc func, void* ctx) {
+    RowJob job = {
+        .grid = grid,
+        .gridVert = gridVert,
+        .w = w,
+        .h = h,
+        .sigma_min = sigma_min,
+        .sigma_max = sigma_max,
+        .t_min = t_min,
+        .t_max = t_max,
+        .func = func,
+        .ctx = ctx
+    };
+    parallelFor(h, 1, populateRows, &job);
+}
+
 void populateMesh(ZetaPoint* grid, ZetaVertex* gridVert, u32 w, u32 h, f32 sigma_min, f32 sigma_max, 
         f32 t_min, f32 t_max, ComplexFunc func) {
-    for (u32 i = 0; i < h; i++) {
-        f32 t = t_min + i * (t_max - t_min) / (h - 1);
-        for (int j = 0; j < w; j++) {
-            f32 sigma = sigma_min + j * (sigma_max - sigma_min) / (w - 1);
-            f32 re, im;
-            func(sigma, t, &re, &im);
-            ZetaPoint* zp = &grid[i * w + j];
-            ZetaVertex* zv = &gridVert[i * w + j];
-            zp->sigma = sigma;
-            zp->t = t;
-            zp->re = re;
-            zp->im = im;
-            zp->mag = sqrtf(re * re + im * im);
-            zp->arg = atan2f(im, re);
-            zv->re = re;
-            zv->im = im;
-            zv->mag = zp->mag;
-            zv->arg = zp->arg;
-        }
+    if(func == zetaApprox) {
+        populateMeshRows(grid, gridVert, w, h, sigma_min, sigma_max, t_min, t_max, zetaApproxRow, NULL);
+        return;
     }
+    ScalarAdapter adapter = { .func = func };
+    populateMeshRows(grid, gridVert, w, h, sigma_min, sigma_max, t_min, t_max, scalarRow, &adapter);
 }
 
 void zetaApprox(f32 sigma, f32 t, f32* re_out, f32* im_out) {
-    u32 N = 100;
+    u32 N = ZETA_TERMS;
     f32 re = 0.0f;
     f32 im = 0.0f;
     for (u32 n = 1; n <= N; n++) {
@@ -64,6 +134,20 @@ void zetaApprox(f32 sigma, f32 t, f32* re_out, f32* im_out) {
     *im_out = im;
 }
 
+//zeta is the single series family with a(n) = 1, run on the shared Dirichlet kernel
+void zetaApproxRow(void* ctx, const f32* sigma, f32 t, u32 count, f32* re_out, f32* im_out) {
+    static const DirichletFamily zetaFamily = {
+        .termCount = ZETA_TERMS,
+        .seriesCount = 1,
+        .groupCount = 1,
+        .order = { 0 },
+        .groupStart = { 0, 1 },
+        .groupOffset = { 0.0f },
+        .series = { { .offset = 0.0f, .modulus = 1, .coeffRe = { 1.0f } } }
+    };
+    dirichletFamilyRow(&zetaFamily, sigma, t, count, re_out, im_out);
+}
+
 void expITheta(f32 sigma, f32 t, f32* re_out, f32* im_out) {
     f32 expDecay = expf(-t);
     *re_out = expDecay * cosf(sigma);
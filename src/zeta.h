@@ -4,6 +4,8 @@
 #include "common_types.h"
 
 typedef void (*ComplexFunc)(f32 sigma, f32 t, f32 *re_out, f32* im_out);
+//batched form: one grid row, sigma varies across count samples and t is shared
+typedef void (*ComplexRowFunc)(void* ctx, const f32* sigma, f32 t, u32 count, f32* re_out, f32* im_out);
 
 typedef struct ZetaPoint {
     f32 sigma;
@@ -24,8 +26,13 @@ typedef struct ZetaVertex {
 void generateMesh(u32* indices, u32 grid_h, u32 grid_w);
 void populateMesh(ZetaPoint* grid, ZetaVertex* vertexGrid, u32 w, u32 h, f32 sigma_min, f32 sigma_max, 
         f32 t_min, f32 t_max, ComplexFunc func);
+void populateMeshRows(ZetaPoint* grid, ZetaVertex* vertexGrid, u32 w, u32 h, f32 sigma_min, f32 sigma_max, 
+        f32 t_min, f32 t_max, ComplexRowFunc func, void* ctx);
+void storeMeshRow(ZetaPoint* gridRow, ZetaVertex* vertexRow, const f32* sigma, f32 t, u32 count, 
+        const f32* re, const f32* im);
 
 void zetaApprox(f32 sigma, f32 t, f32* re_out, f32* im_out); 
+void zetaApproxRow(void* ctx, const f32* sigma, f32 t, u32 count, f32* re_out, f32* im_out);
 void expITheta(f32 sigma, f32 t, f32* re_out, f32* im_out); 
 void sin_complex(f32 sigma, f32 t, f32* re_out, f32* im_out); 
 
@@ -4,6 +4,22 @@ echo "#                 Compiling All Tests....                #"
 echo "##########################################################"
 
 clang -std=c99 -Wall -Werror tests/test_scratch_arena.c -o test_lib/scratch_arena_tests -Iinclude -Isrc 
+clang -std=c99 -Wall -Werror -D_DEFAULT_SOURCE tests/test_arena_marks.c src/memory/scratch_arena.c src/memory/page_arena.c -o test_lib/arena_marks_tests -Iinclude -Isrc -Isrc/memory || exit 1
+clang -std=c99 -Wall -Werror -D_DEFAULT_SOURCE tests/test_page_arena_atomic.c src/memory/page_arena.c -o test_lib/page_arena_atomic_tests -Iinclude -Isrc -Isrc/memory -lpthread || exit 1
+clang -std=c99 -Wall -Werror -D_DEFAULT_SOURCE tests/test_page_arena_reserve.c src/memory/page_arena.c -o test_lib/page_arena_reserve_tests -Iinclude -Isrc -Isrc/memory || exit 1
+clang -std=c99 -Wall -Werror -D_DEFAULT_SOURCE tests/test_fixed_pool.c src/memory/fixed_pool.c src/memory/page_arena.c -o test_lib/fixed_pool_tests -Iinclude -Isrc -Isrc/memory || exit 1
+clang -std=c99 -Wall -Werror -D_DEFAULT_SOURCE tests/test_hash_table.c src/memory/hash_table.c src/memory/page_arena.c -o test_lib/hash_table_tests -Iinclude -Isrc -Isrc/memory || exit 1
+clang -std=c99 -Wall -Werror -D_DEFAULT_SOURCE tests/test_ring_queue.c src/memory/ring_queue.c src/memory/page_arena.c -o test_lib/ring_queue_tests -Iinclude -Isrc -Isrc/memory -lpthread || exit 1
+clang -std=c99 -Wall -Werror -D_DEFAULT_SOURCE tests/test_parallel.c src/parallel.c src/memory/scratch_pool.c src/memory/scratch_arena.c src/memory/page_arena.c -o test_lib/parallel_tests -Iinclude -Isrc -Isrc/memory -lpthread || exit 1
+clang -std=c99 -Wall -Werror -D_DEFAULT_SOURCE tests/test_lod.c src/lod.c src/vcache.c src/parallel.c src/memory/scratch_pool.c src/memory/scratch_arena.c src/memory/page_arena.c -o test_lib/lod_tests -Iinclude -Isrc -Isrc/memory -lpthread -lm || exit 1
+clang -std=c99 -Wall -Werror -D_DEFAULT_SOURCE tests/test_colormap.c src/colormap.c -o test_lib/colormap_tests -Iinclude -Isrc -Isrc/memory -lm || exit 1
+clang -std=c99 -Wall -Werror -D_DEFAULT_SOURCE tests/test_dirichlet.c src/dirichlet.c src/zeta.c src/parallel.c src/memory/scratch_pool.c src/memory/scratch_arena.c src/memory/page_arena.c -o test_lib/dirichlet_tests -Iinclude -Isrc -Isrc/memory -lpthread -lm || exit 1
+clang -std=c99 -Wall -Werror -D_DEFAULT_SOURCE tests/test_expr.c src/expr.c src/zeta.c src/dirichlet.c src/parallel.c src/memory/scratch_pool.c src/memory/scratch_arena.c src/memory/page_arena.c -o test_lib/expr_tests -Iinclude -Isrc -Isrc/memory -lpthread -lm || exit 1
+clang -std=c99 -Wall -Werror -D_DEFAULT_SOURCE tests/test_pyramid.c src/pyramid.c src/parallel.c src/memory/scratch_pool.c src/memory/scratch_arena.c src/memory/page_arena.c -o test_lib/pyramid_tests -Iinclude -Isrc -Isrc/memory -lpthread -lm || exit 1
+clang -std=c99 -Wall -Werror -D_DEFAULT_SOURCE tests/test_contour.c src/contour.c src/parallel.c src/memory/scratch_pool.c src/memory/scratch_arena.c src/memory/page_arena.c -o test_lib/contour_tests -Iinclude -Isrc -Isrc/memory -lpthread -lm || exit 1
+clang -std=c99 -Wall -Werror -D_DEFAULT_SOURCE tests/test_plugin.c src/plugin.c src/parallel.c src/memory/scratch_pool.c src/memory/scratch_arena.c src/memory/page_arena.c -o test_lib/plugin_tests -Iinclude -Isrc -Isrc/memory -ldl -lpthread -lm || exit 1
+clang -std=c99 -Wall -Werror -D_DEFAULT_SOURCE tests/test_sampling.c src/sampling.c src/zeta.c src/dirichlet.c src/parallel.c src/memory/scratch_pool.c src/memory/scratch_arena.c src/memory/page_arena.c -o test_lib/sampling_tests -Iinclude -Isrc -Isrc/memory -lpthread -lm || exit 1
+clang -std=c99 -Wall -Werror -D_DEFAULT_SOURCE tests/test_plan.c src/plan.c src/lod.c src/vcache.c src/parallel.c src/memory/scratch_pool.c src/memory/scratch_arena.c src/memory/page_arena.c -o test_lib/plan_tests -Iinclude -Isrc -Isrc/memory -lpthread -lm || exit 1
 
 if [ $? -eq 0 ]; then
     echo "[X] Tests compilation complete...."
@@ -0,0 +1,87 @@
+#include "minunit.h"
+#include "scratch_arena.h"
+#include "page_arena.h"
+
+mu_suite_start();
+int tests_run = 0;
+
+#define ARENA_SIZE 1024 * 64
+
+char *test_nested_push_pop() {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    arenaScratchAlloc(&arena, 10, ALIGN_1);
+    arenaScratchPush(&arena);
+    arenaScratchAlloc(&arena, 100, ALIGN_8);
+    usize inner = arena.offset;
+    arenaScratchPush(&arena);
+    arenaScratchAlloc(&arena, 200, ALIGN_16);
+    arenaScratchPop(&arena);
+    mu_assert(arena.offset == inner, "Inner pop should return to inner push.");
+    arenaScratchPop(&arena);
+    mu_assert(arena.offset == 10, "Outer pop should return to outer push.");
+    destroyScratchArena(&arena);
+    fprintf(stdout, "[X] Nested push/pop.\n");
+    return NULL;
+}
+
+char *test_pop_before_push() {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    arenaScratchAlloc(&arena, 64, ALIGN_8);
+    arenaScratchPop(&arena);
+    mu_assert(arena.offset == 64, "Pop without push should be a no-op.");
+    mu_assert(arena.previous == SCRATCH_NO_MARK, "Pop without push should keep the empty mark stack.");
+    destroyScratchArena(&arena);
+    fprintf(stdout, "[X] Pop before push.\n");
+    return NULL;
+}
+
+char *test_restore_drops_inner_pushes() {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    arenaScratchPush(&arena);
+    arenaScratchAlloc(&arena, 32, ALIGN_8);
+    ArenaMark mark = arenaScratchSave(&arena);
+    arenaScratchPush(&arena);
+    arenaScratchAlloc(&arena, 512, ALIGN_8);
+    arenaScratchRestore(&arena, mark);
+    mu_assert(arena.offset == mark.offset, "Restore should return to the saved offset.");
+    arenaScratchPop(&arena);
+    mu_assert(arena.offset == 0, "Pop after restore should reach the push made before the mark.");
+    destroyScratchArena(&arena);
+    fprintf(stdout, "[X] Restore past inner pushes.\n");
+    return NULL;
+}
+
+char *test_page_marks() {
+    memMap* map = initMemMap(ARENA_SIZE * 4);
+    PageArena* outer = createPageArena(map, ARENA_SIZE);
+    PageArena* inner = createPageArena(map, ARENA_SIZE);
+    mu_assert(outer && inner, "Expected two page arenas.");
+    usize mapOffset = map->offset;
+    ArenaMark first = arenaPageSave(inner);
+    arenaPageAlloc(inner, 100, ALIGN_8);
+    ArenaMark second = arenaPageSave(inner);
+    arenaPageAlloc(inner, 1000, ALIGN_64);
+    arenaPageRestore(inner, second);
+    mu_assert(inner->offset == 100, "Restore should return to the inner mark.");
+    arenaPageRestore(inner, first);
+    mu_assert(inner->offset == 0, "Restore should return to the outer mark.");
+    arenaPageRestore(outer, first);
+    mu_assert(outer->offset == 0, "Foreign mark should be rejected.");
+    arenaPagePop(map);
+    mu_assert(map->offset < mapOffset, "Pop should rewind the map past the popped arena.");
+    arenaPagePop(map);
+    mu_assert(map->offset == 0, "Popping every arena should rewind the map to zero.");
+    releasePages(map);
+    fprintf(stdout, "[X] Page arena marks.\n");
+    return NULL;
+}
+
+static char* all_tests() {
+    mu_run_test(test_nested_push_pop);
+    mu_run_test(test_pop_before_push);
+    mu_run_test(test_restore_drops_inner_pushes);
+    mu_run_test(test_page_marks);
+    return NULL;
+}
+
+RUN_TESTS(all_tests);
@@ -0,0 +1,85 @@
+#include <math.h>
+#include <stdlib.h>
+#include "minunit.h"
+#include "colormap.h"
+
+mu_suite_start();
+int tests_run = 0;
+
+//the branchy hsv2rgb mathModel.fs used to run per fragment, clamped like the framebuffer
+static void shaderHsv(f32* rgb, f32 h, f32 s, f32 v) {
+    f32 c = v * s;
+    f32 hp = h / (3.1415926f / 3.0f);
+    hp -= 6.0f * floorf(hp / 6.0f);
+    f32 x = c * (1.0f - fabsf(fmodf(hp, 2.0f) - 1.0f));
+    f32 r, g, b;
+    if (0.0f <= hp && hp < 1.0f) { r = c; g = x; b = 0; }
+    else if (1.0f <= hp && hp < 2.0f) { r = x; g = c; b = 0; }
+    else if (2.0f <= hp && hp < 3.0f) { r = 0; g = c; b = x; }
+    else if (3.0f <= hp && hp < 4.0f) { r = 0; g = x; b = c; }
+    else if (4.0f <= hp && hp < 5.0f) { r = x; g = 0; b = c; }
+    else { r = c; g = 0; b = x; }
+    rgb[0] = fminf(fmaxf(r + v - c, 0.0f), 1.0f);
+    rgb[1] = fminf(fmaxf(g + v - c, 0.0f), 1.0f);
+    rgb[2] = fminf(fmaxf(b + v - c, 0.0f), 1.0f);
+}
+
+char *test_hsv_matches_shader() {
+    u8* rgba = malloc(COLORMAP_LAYER_BYTES);
+    mu_assert(rgba, "Expected a layer buffer.");
+    mu_assert(colormapBake(rgba, COLORMAP_PALETTES) != 0, "Unknown palettes should be rejected.");
+    mu_assert(colormapBake(rgba, COLORMAP_HSV) == 0, "Expected the hsv layer to bake.");
+    i32 worst = 0;
+    for (u32 y = 0; y < COLORMAP_HEIGHT; y++) {
+        for (u32 x = 0; x < COLORMAP_WIDTH; x++) {
+            f32 rgb[3];
+            shaderHsv(rgb, colormapArg(x), 1.0f, colormapLength(y) * 0.25f);
+            for (u32 k = 0; k < 3; k++) {
+                i32 d = abs((i32)rgba[(y * COLORMAP_WIDTH + x) * 4 + k] - (i32)(rgb[k] * 255.0f + 0.5f));
+                worst = (d > worst) ? d : worst;
+            }
+        }
+    }
+    free(rgba);
+    mu_assert(worst <= 1, "The hsv layer should reproduce the shader at every texel centre.");
+    fprintf(stdout, "[X] hsv layer within %d of the shader.\n", worst);
+    return NULL;
+}
+
+//GL_REPEAT joins the last column to the first, no palette may show a seam at arg = +-pi
+char *test_palettes_wrap() {
+    u8* rgba = malloc(COLORMAP_LAYER_BYTES);
+    mu_assert(rgba, "Expected a layer buffer.");
+    for (u32 p = 0; p < COLORMAP_PALETTES; p++) {
+        mu_assert(colormapFind(colormapName(p)) == p, "Palette names should round trip.");
+        mu_assert(colormapBake(rgba, p) == 0, "Expected every palette to bake.");
+        i32 seam = 0, step = 0;
+        for (u32 y = 0; y < COLORMAP_HEIGHT; y++) {
+            const u8* row = &rgba[y * COLORMAP_WIDTH * 4];
+            for (u32 x = 0; x < COLORMAP_WIDTH; x++) {
+                u32 next = (x + 1) % COLORMAP_WIDTH;
+                for (u32 k = 0; k < 3; k++) {
+                    i32 d = abs((i32)row[next * 4 + k] - (i32)row[x * 4 + k]);
+                    if(next == 0) {
+                        seam = (d > seam) ? d : seam;
+                    } else {
+                        step = (d > step) ? d : step;
+                    }
+                }
+            }
+        }
+        mu_assert(seam <= step, "The wrap should be no larger a step than any other column.");
+    }
+    mu_assert(colormapFind("none") == COLORMAP_PALETTES, "Unknown names should not match.");
+    free(rgba);
+    fprintf(stdout, "[X] all %u palettes wrap without a seam.\n", COLORMAP_PALETTES);
+    return NULL;
+}
+
+static char* all_tests() {
+    mu_run_test(test_hsv_matches_shader);
+    mu_run_test(test_palettes_wrap);
+    return NULL;
+}
+
+RUN_TESTS(all_tests);
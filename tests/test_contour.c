@@ -0,0 +1,189 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "minunit.h"
+#include "contour.h"
+#include "parallel.h"
+
+mu_suite_start();
+int tests_run = 0;
+
+#define MAP_SIZE 1024 * 1024 * 8
+#define GRID_W 60
+#define GRID_H 47
+#define SPACING 0.1f
+#define RADIUS 1.93f
+#define PI_F 3.14159265f
+//Re = sin(pi x) is zero on x = -2..2, every line halfway between two sample columns
+#define RE_LINES 5
+//x = -1, 0, 1 cross the circle twice
+#define ZERO_COUNT 6
+
+static ZetaPoint grid[GRID_W * GRID_H];
+static ZetaVertex vertexGrid[GRID_W * GRID_H];
+
+//samples on cell centres of a SPACING lattice, vertices carry the plane position so strips can be checked in x, y
+static void fillField(void) {
+    for (u32 i = 0; i < GRID_H; i++) {
+        for (u32 j = 0; j < GRID_W; j++) {
+            f32 x = -0.5f * GRID_W * SPACING + (j + 0.5f) * SPACING;
+            f32 y = -0.5f * GRID_H * SPACING + (i + 0.5f) * SPACING;
+            ZetaPoint* zp = &grid[i * GRID_W + j];
+            zp->sigma = x;
+            zp->t = y;
+            zp->re = sinf(PI_F * x);
+            zp->im = x * x + y * y - RADIUS * RADIUS;
+            zp->mag = sqrtf(zp->re * zp->re + zp->im * zp->im);
+            zp->arg = atan2f(zp->im, zp->re);
+            vertexGrid[i * GRID_W + j] = (ZetaVertex){ .re = x, .im = y, .mag = zp->mag, .arg = zp->arg };
+        }
+    }
+}
+
+static u32 signChanges(u32 component) {
+    u32 count = 0;
+    for (u32 i = 0; i < GRID_H; i++) {
+        for (u32 j = 0; j < GRID_W; j++) {
+            const ZetaPoint* zp = &grid[i * GRID_W + j];
+            f32 v = component ? zp->im : zp->re;
+            if(j + 1 < GRID_W) {
+                f32 right = component ? zp[1].im : zp[1].re;
+                count += (v > 0.0f) != (right > 0.0f);
+            }
+            if(i + 1 < GRID_H) {
+                f32 below = component ? zp[GRID_W].im : zp[GRID_W].re;
+                count += (v > 0.0f) != (below > 0.0f);
+            }
+        }
+    }
+    return count;
+}
+
+//neighbouring indices in a strip sit on edges of one cell
+static u32 stepsAdjacent(const ContourLines* lines, u32 from, u32 to) {
+    for (u32 k = from + 1; k < to; k++) {
+        const ZetaVertex* a = &lines->vertices[lines->indices[k - 1]];
+        const ZetaVertex* b = &lines->vertices[lines->indices[k]];
+        if(fabsf(a->re - b->re) > SPACING * 1.01f || fabsf(a->im - b->im) > SPACING * 1.01f) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+char *test_open_strips() {
+    memMap* map = initMemMap(MAP_SIZE);
+    PageArena* arena = createPageArena(map, MAP_SIZE / 2);
+    ContourField field;
+    mu_assert(contourInit(&field, arena, GRID_W, 1, 64, 0) != 0, "A one row grid should be rejected.");
+    mu_assert(contourInit(&field, arena, GRID_W, GRID_H, GRID_W * GRID_H / 4, CONTOUR_ZERO_CAPACITY) == 0,
+            "Expected a contour field.");
+    fillField();
+    contourExtract(&field, grid, vertexGrid);
+
+    const ContourLines* re = &field.reLines;
+    mu_assert(!re->overflow, "The Re family should fit.");
+    mu_assert(re->vertexCount == signChanges(0) && re->vertexCount == RE_LINES * GRID_H,
+            "Every Re sign change should be one vertex.");
+    mu_assert(re->stripCount == RE_LINES, "Each zero line of Re should be one strip.");
+    mu_assert(re->indexCount == re->vertexCount + RE_LINES - 1, "Strips should be split by one restart each.");
+
+    //restarts only between strips, each strip a full column of rows on one line
+    static u8 seen[GRID_W * GRID_H];
+    u32 start = 0, strips = 0;
+    for (u32 k = 0; k <= re->indexCount; k++) {
+        if(k < re->indexCount && re->indices[k] != CONTOUR_RESTART) {
+            mu_assert(re->indices[k] < re->vertexCount && !seen[re->indices[k]], "Each vertex should appear once.");
+            seen[re->indices[k]] = 1;
+            continue;
+        }
+        mu_assert(k - start == GRID_H, "Each Re strip should cross every row.");
+        mu_assert(stepsAdjacent(re, start, k), "Strip steps should stay within one cell.");
+        f32 x = re->vertices[re->indices[start]].re;
+        mu_assert(fabsf(x - roundf(x)) < 1e-3f, "Re strips should lie on the integer lines.");
+        for (u32 v = start; v < k; v++) {
+            mu_assert(fabsf(re->vertices[re->indices[v]].re - x) < 1e-3f, "Re strips should be straight.");
+        }
+        strips++;
+        start = k + 1;
+    }
+    mu_assert(strips == RE_LINES && re->indices[0] != CONTOUR_RESTART && re->indices[re->indexCount - 1] != CONTOUR_RESTART,
+            "No restart at either end of the index list.");
+
+    //the circle is one closed loop ending back on its first vertex
+    const ContourLines* im = &field.imLines;
+    mu_assert(!im->overflow && im->vertexCount == signChanges(1), "Every Im sign change should be one vertex.");
+    mu_assert(im->stripCount == 1 && im->indexCount == im->vertexCount + 1, "The circle should be one strip.");
+    mu_assert(im->indices[0] == im->indices[im->indexCount - 1], "The loop should close on its first vertex.");
+    mu_assert(stepsAdjacent(im, 0, im->indexCount), "Loop steps should stay within one cell.");
+    for (u32 k = 0; k < im->indexCount; k++) {
+        const ZetaVertex* v = &im->vertices[im->indices[k]];
+        mu_assert(im->indices[k] != CONTOUR_RESTART, "A single loop has no restarts.");
+        mu_assert(fabsf(sqrtf(v->re * v->re + v->im * v->im) - RADIUS) < 0.01f, "Loop vertices should be on the circle.");
+    }
+
+    mu_assert(field.zeroCount == ZERO_COUNT, "Every crossing of the two families should be a zero.");
+    ContourZero first[ZERO_COUNT];
+    memcpy(first, field.zeros, sizeof(first));
+    contourExtract(&field, grid, vertexGrid);
+    mu_assert(field.zeroCount == ZERO_COUNT && memcmp(first, field.zeros, sizeof(first)) == 0,
+            "Extracting again should report the same zeros in the same order.");
+    for (u32 z = 0; z < field.zeroCount; z++) {
+        const ContourZero* zero = &field.zeros[z];
+        mu_assert(z == 0 || zero->t > field.zeros[z - 1].t ||
+                (zero->t == field.zeros[z - 1].t && zero->sigma >= field.zeros[z - 1].sigma),
+                "Zeros should be sorted by t, then sigma.");
+        f32 k = roundf(zero->sigma);
+        mu_assert(fabsf(zero->sigma - k) < 1e-3f && fabsf(fabsf(zero->t) - sqrtf(RADIUS * RADIUS - k * k)) < 0.01f,
+                "Zeros should sit where the lines cross the circle.");
+    }
+
+    arenaPagePop(map);
+    releasePages(map);
+    fprintf(stdout, "[X] %u Re strips, one Im loop of %u vertices, %u zeros.\n", re->stripCount, im->vertexCount,
+            field.zeroCount);
+    return NULL;
+}
+
+//too few vertices flags overflow but never writes or indexes past the buffers
+char *test_overflow_bounded() {
+    memMap* map = initMemMap(MAP_SIZE);
+    PageArena* arena = createPageArena(map, MAP_SIZE / 2);
+    ContourField field;
+    u32 capacity = GRID_H * 2 + 7;
+    mu_assert(contourInit(&field, arena, GRID_W, GRID_H, capacity, 2) == 0, "Expected a contour field.");
+    fillField();
+    contourExtract(&field, grid, vertexGrid);
+    const ContourLines* re = &field.reLines;
+    mu_assert(re->overflow && re->vertexCount == capacity, "Re should overflow and clamp its vertex count.");
+    mu_assert(re->indexCount <= re->indexCapacity, "Indices should stay in capacity.");
+    for (u32 k = 0; k < re->indexCount; k++) {
+        mu_assert(re->indices[k] == CONTOUR_RESTART || re->indices[k] < capacity, "Indices should stay below capacity.");
+        mu_assert(k == 0 || re->indices[k] != CONTOUR_RESTART || re->indices[k - 1] != CONTOUR_RESTART,
+                "No empty strips between restarts.");
+    }
+    mu_assert(field.zeroCount == 2, "Zeros should clamp to their capacity.");
+    arenaPagePop(map);
+    releasePages(map);
+    fprintf(stdout, "[X] Contour overflow stays in bounds.\n");
+    return NULL;
+}
+
+static char* all_tests() {
+    mu_run_test(test_open_strips);
+    mu_run_test(test_overflow_bounded);
+    return NULL;
+}
+
+int main(int argc, char* argv[]) {
+    parallelInit(4);
+    char* result = all_tests();
+    parallelShutdown();
+    if(result != 0) {
+        printf("FAILED: %s\n", result);
+    } else {
+        printf("ALL TESTS PASSED\n");
+    }
+    printf("Tests run: %d\n", tests_run);
+    exit(result != 0);
+}
@@ -0,0 +1,98 @@
+#include <math.h>
+#include "minunit.h"
+#include "dirichlet.h"
+
+mu_suite_start();
+int tests_run = 0;
+
+#define CATALAN 0.91596559417721901f
+#define TERMS 4096
+
+static u32 gcd(u32 a, u32 b) {
+    while(b) {
+        u32 r = a % b;
+        a = b;
+        b = r;
+    }
+    return a;
+}
+
+char *test_character_counts() {
+    static const u32 phi[] = { 0, 1, 1, 2, 2, 4, 2, 6, 4, 6, 4, 10, 4, 12, 6, 8, 8 };
+    for (u32 q = 0; q < sizeof(phi) / sizeof(phi[0]); q++) {
+        mu_assert(dirichletCharacterCount(q) == phi[q], "Character count should be Euler's phi.");
+    }
+    DirichletSeries s;
+    mu_assert(dirichletSeriesCharacter(&s, DIRICHLET_MAX_MODULUS + 1, 0) != 0, "Moduli past the limit should fail.");
+    mu_assert(dirichletSeriesCharacter(&s, 0, 0) != 0, "Modulus 0 should fail.");
+    mu_assert(dirichletSeriesCharacter(&s, 5, 4) != 0, "Index past phi should fail.");
+    fprintf(stdout, "[X] Character counts match phi.\n");
+    return NULL;
+}
+
+//sum over r of chi_i(r) conj(chi_j(r)) is phi(q) when i == j and 0 otherwise, chi(ab) = chi(a) chi(b)
+char *test_characters_orthogonal() {
+    static DirichletSeries chars[DIRICHLET_MAX_MODULUS];
+    for (u32 q = 1; q <= DIRICHLET_MAX_MODULUS; q++) {
+        u32 count = dirichletCharacterCount(q);
+        for (u32 i = 0; i < count; i++) {
+            mu_assert(dirichletSeriesCharacter(&chars[i], q, i) == 0, "Expected every character to build.");
+            const DirichletSeries* c = &chars[i];
+            for (u32 a = 0; a < q; a++) {
+                f32 norm = c->coeffRe[a] * c->coeffRe[a] + c->coeffIm[a] * c->coeffIm[a];
+                mu_assert(fabsf(norm - (gcd(a, q) == 1 ? 1.0f : 0.0f)) < 1e-4f, "Characters are unit on units, zero elsewhere.");
+                for (u32 b = 0; b < q; b++) {
+                    u32 ab = (a * b) % q;
+                    f32 re = c->coeffRe[a] * c->coeffRe[b] - c->coeffIm[a] * c->coeffIm[b];
+                    f32 im = c->coeffRe[a] * c->coeffIm[b] + c->coeffIm[a] * c->coeffRe[b];
+                    mu_assert(fabsf(re - c->coeffRe[ab]) < 1e-4f && fabsf(im - c->coeffIm[ab]) < 1e-4f,
+                            "Characters should be multiplicative.");
+                }
+            }
+        }
+        for (u32 i = 0; i < count; i++) {
+            for (u32 j = 0; j < count; j++) {
+                f32 re = 0.0f, im = 0.0f;
+                for (u32 r = 0; r < q; r++) {
+                    re += chars[i].coeffRe[r] * chars[j].coeffRe[r] + chars[i].coeffIm[r] * chars[j].coeffIm[r];
+                    im += chars[i].coeffIm[r] * chars[j].coeffRe[r] - chars[i].coeffRe[r] * chars[j].coeffIm[r];
+                }
+                f32 expect = (i == j) ? (f32)count : 0.0f;
+                mu_assert(fabsf(re - expect) < 1e-3f && fabsf(im) < 1e-3f, "Characters should be orthogonal.");
+            }
+        }
+    }
+    fprintf(stdout, "[X] Characters mod 1..%d are multiplicative and orthogonal.\n", DIRICHLET_MAX_MODULUS);
+    return NULL;
+}
+
+char *test_known_values() {
+    DirichletSeries s;
+    mu_assert(dirichletSeriesCharacter(&s, 4, 0) == 0 && s.coeffRe[1] == 1.0f && s.coeffRe[3] == 1.0f && s.coeffRe[2] == 0.0f,
+            "Index 0 should be the principal character.");
+    mu_assert(dirichletSeriesCharacter(&s, 4, 1) == 0 && s.coeffRe[1] == 1.0f && s.coeffRe[3] == -1.0f,
+            "The character mod 4 should send 3 to -1.");
+    //generator 2 mod 5 with digit 1 sends 2 to i, 4 to -1, 3 to -i
+    mu_assert(dirichletSeriesCharacter(&s, 5, 1) == 0 && s.coeffIm[2] == 1.0f && s.coeffRe[4] == -1.0f &&
+            s.coeffIm[3] == -1.0f, "Expected the order 4 character mod 5.");
+
+    //L(2, chi_4) is Catalan's constant, the tail after TERMS is below 1 / TERMS^2
+    DirichletFamily family;
+    dirichletFamilyInit(&family, TERMS);
+    dirichletSeriesCharacter(&s, 4, 1);
+    mu_assert(dirichletFamilyAdd(&family, &s) == 0, "Expected one series.");
+    f32 sigma = 2.0f, re, im;
+    dirichletRow(&family, &sigma, 0.0f, 1, &re, &im);
+    mu_assert(fabsf(re - CATALAN) < 1e-5f && fabsf(im) < 1e-6f, "L(2, chi_4) should be Catalan's constant.");
+    fprintf(stdout, "[X] L(2, chi_4) = %.7f.\n", re);
+    return NULL;
+}
+
+static char* all_tests() {
+    mu_run_test(test_character_counts);
+    mu_run_test(test_characters_orthogonal);
+    mu_run_test(test_known_values);
+    return NULL;
+}
+
+RUN_TESTS(all_tests);
@@ -0,0 +1,129 @@
+#include <complex.h>
+#include <math.h>
+#include <string.h>
+#include "minunit.h"
+#include "expr.h"
+
+mu_suite_start();
+int tests_run = 0;
+
+//more than one EXPR_LANES block, with a short tail
+#define POINTS 150
+//far past any real expression, enough to overflow the stack without a depth limit
+#define NESTING 100000
+
+typedef double complex (*Reference)(double complex s);
+
+static double complex refPoly(double complex s) { return s * s + 1.0; }
+static double complex refExpI(double complex s) { return cexp(I * s); }
+static double complex refRational(double complex s) { return (s - 1.0) / (s + 2.0) - 3.0 * s; }
+static double complex refOne(double complex s) { return 1.0; }
+static double complex refLog(double complex s) { return clog(s); }
+static double complex refNegSquare(double complex s) { return -(s * s); }
+static double complex refNegExp(double complex s) { return -cexp(-s); }
+static double complex refRoot(double complex s) { return s * 0.5 + csqrt(s) * csqrt(s) / s; }
+
+typedef struct ExprCase {
+    const char* source;
+    Reference reference;
+} ExprCase;
+
+static const ExprCase cases[] = {
+    { "s*s + 1", refPoly },
+    { "exp(i*s)", refExpI },
+    { "(s - 1)/(s + 2) - 3*s", refRational },
+    { "sin(s)^2 + cos(s)^2", refOne },
+    { "pow(s, 3) - s^3 + log(s)", refLog },
+    { "-s^2", refNegSquare },
+    { "sinh(s) - cosh(s)", refNegExp },
+    { "s/2 + sqrt(s)*sqrt(s)/s", refRoot },
+};
+
+static void samplePoints(f32* re, f32* im) {
+    for (u32 p = 0; p < POINTS; p++) {
+        re[p] = 0.25f + 1.5f * (f32)(p % 10) / 10.0f;
+        im[p] = -2.0f + 4.0f * (f32)(p / 10) / (POINTS / 10);
+    }
+}
+
+//every case against the same formula in double complex
+char *test_compiled_matches_reference() {
+    f32 sre[POINTS], sim[POINTS], re[POINTS], im[POINTS];
+    samplePoints(sre, sim);
+    ExprProgram program;
+    for (u32 k = 0; k < sizeof(cases) / sizeof(cases[0]); k++) {
+        mu_assert(exprCompile(&program, cases[k].source) == 0, "Expected the expression to compile.");
+        exprEval(&program, sre, sim, POINTS, re, im);
+        for (u32 p = 0; p < POINTS; p++) {
+            double complex expect = cases[k].reference(sre[p] + I * sim[p]);
+            double err = cabs((re[p] + I * im[p]) - expect);
+            if(err > 1e-4 * (1.0 + cabs(expect))) {
+                fprintf(stderr, "%s at %g%+gi: got %g%+gi, expected %g%+gi\n", cases[k].source, sre[p], sim[p],
+                        re[p], im[p], creal(expect), cimag(expect));
+                mu_assert(0, "Compiled expression should match the reference.");
+            }
+        }
+    }
+    fprintf(stdout, "[X] %u expressions match the reference at %u points.\n", (u32)(sizeof(cases) / sizeof(cases[0])), POINTS);
+    return NULL;
+}
+
+//exprRow takes the zeta row kernel for a grid row, exprEval the pointwise path
+char *test_row_matches_eval() {
+    f32 sigma[POINTS], t[POINTS], re[POINTS], im[POINTS], rowRe[POINTS], rowIm[POINTS];
+    for (u32 p = 0; p < POINTS; p++) {
+        sigma[p] = 0.5f + (f32)p / POINTS;
+        t[p] = 14.0f;
+    }
+    ExprProgram program;
+    mu_assert(exprCompile(&program, "zeta(s) * (s - 1) + s") == 0, "Expected zeta to compile.");
+    exprEval(&program, sigma, t, POINTS, re, im);
+    exprRow(&program, sigma, 14.0f, POINTS, rowRe, rowIm);
+    for (u32 p = 0; p < POINTS; p++) {
+        f32 scale = 1.0f + sqrtf(re[p] * re[p] + im[p] * im[p]);
+        mu_assert(fabsf(rowRe[p] - re[p]) < 1e-3f * scale && fabsf(rowIm[p] - im[p]) < 1e-3f * scale,
+                "The row path should agree with pointwise evaluation.");
+    }
+    fprintf(stdout, "[X] Row and pointwise zeta agree.\n");
+    return NULL;
+}
+
+char *test_errors_rejected() {
+    static const char* bad[] = { "", "s +", "foo(s)", "(s", "exp s", "pow(s)", "s)", "1 2", "s $ 2", "sin(s,", "2^" };
+    ExprProgram program;
+    for (u32 k = 0; k < sizeof(bad) / sizeof(bad[0]); k++) {
+        if(exprCompile(&program, bad[k]) == 0) {
+            fprintf(stderr, "accepted '%s'\n", bad[k]);
+            mu_assert(0, "Malformed expressions should be rejected.");
+        }
+    }
+    mu_assert(exprCompile(&program, "  s  ") == 0 && program.codeCount == 1, "A lone s should be one instruction.");
+
+    //deep nesting is a parse error, not a stack overflow
+    static char nested[2 * NESTING + 2];
+    memset(nested, '(', NESTING);
+    nested[NESTING] = 's';
+    memset(nested + NESTING + 1, ')', NESTING);
+    nested[2 * NESTING + 1] = '\0';
+    mu_assert(exprCompile(&program, nested) != 0, "Deeply nested parentheses should be rejected.");
+    memset(nested, '-', NESTING);
+    nested[NESTING] = 's';
+    nested[NESTING + 1] = '\0';
+    mu_assert(exprCompile(&program, nested) != 0, "A long chain of unary minus should be rejected.");
+    memset(nested, '(', 32);
+    nested[32] = 's';
+    memset(nested + 33, ')', 32);
+    nested[65] = '\0';
+    mu_assert(exprCompile(&program, nested) == 0, "Moderate nesting should still compile.");
+    fprintf(stdout, "[X] %u malformed expressions rejected.\n", (u32)(sizeof(bad) / sizeof(bad[0])));
+    return NULL;
+}
+
+static char* all_tests() {
+    mu_run_test(test_compiled_matches_reference);
+    mu_run_test(test_row_matches_eval);
+    mu_run_test(test_errors_rejected);
+    return NULL;
+}
+
+RUN_TESTS(all_tests);
@@ -0,0 +1,81 @@
+#include "minunit.h"
+#include "fixed_pool.h"
+
+mu_suite_start();
+int tests_run = 0;
+
+#define MAP_SIZE 1024 * 1024
+#define CAPACITY 256
+
+typedef struct Tile {
+    f32 values[5];
+    u32 id;
+} Tile;
+
+char *test_alloc_free_reuse() {
+    memMap* map = initMemMap(MAP_SIZE);
+    FixedPool pool;
+    mu_assert(fixedPoolInit(&pool, map, sizeof(Tile), ALIGN_16, CAPACITY, 0) == 0, "Expected pool init.");
+    Tile* a = fixedPoolAlloc(&pool);
+    Tile* b = fixedPoolAlloc(&pool);
+    mu_assert(a && b && a != b, "Expected two distinct objects.");
+    mu_assert(((usize)a % ALIGN_16) == 0 && ((usize)b % ALIGN_16) == 0, "Objects should be aligned.");
+    fixedPoolFree(&pool, a);
+    Tile* c = fixedPoolAlloc(&pool);
+    mu_assert(c == a, "Freed object should be reused first.");
+    arenaPagePop(map);
+    releasePages(map);
+    fprintf(stdout, "[X] Alloc, free and reuse.\n");
+    return NULL;
+}
+
+char *test_exhaust_and_reset() {
+    memMap* map = initMemMap(MAP_SIZE);
+    FixedPool pool;
+    mu_assert(fixedPoolInit(&pool, map, sizeof(Tile), ALIGN_8, CAPACITY, 0) == 0, "Expected pool init.");
+    Tile* first = NULL;
+    for (u32 i = 0; i < CAPACITY; i++) {
+        Tile* t = fixedPoolAlloc(&pool);
+        mu_assert(t != NULL, "Expected allocation within capacity.");
+        first = first ? first : t;
+    }
+    mu_assert(fixedPoolAlloc(&pool) == NULL, "Expected NULL past capacity.");
+    fixedPoolReset(&pool);
+    mu_assert(fixedPoolAlloc(&pool) == first, "Reset should start again from the first slot.");
+    arenaPagePop(map);
+    releasePages(map);
+    fprintf(stdout, "[X] Exhaust and reset.\n");
+    return NULL;
+}
+
+char *test_local_caches() {
+    memMap* map = initMemMap(MAP_SIZE);
+    FixedPool pool;
+    mu_assert(fixedPoolInit(&pool, map, sizeof(Tile), ALIGN_8, CAPACITY, 2) == 0, "Expected pool init.");
+    Tile* held[CAPACITY];
+    for (u32 i = 0; i < CAPACITY; i++) {
+        held[i] = fixedPoolAllocLocal(&pool, i % 2);
+        mu_assert(held[i] != NULL, "Expected cached allocation within capacity.");
+    }
+    for (u32 i = 0; i < CAPACITY; i++) {
+        fixedPoolFreeLocal(&pool, 0, held[i]);
+    }
+    mu_assert(pool.caches[0].count < FIXED_POOL_CACHE_MAX, "Cache should spill to the shared list.");
+    u32 spilled = CAPACITY - pool.caches[0].count;
+    for (u32 i = 0; i < spilled; i++) {
+        mu_assert(fixedPoolAllocLocal(&pool, 1) != NULL, "Spilled objects should reach the other cache.");
+    }
+    arenaPagePop(map);
+    releasePages(map);
+    fprintf(stdout, "[X] Per-thread caches.\n");
+    return NULL;
+}
+
+static char* all_tests() {
+    mu_run_test(test_alloc_free_reuse);
+    mu_run_test(test_exhaust_and_reset);
+    mu_run_test(test_local_caches);
+    return NULL;
+}
+
+RUN_TESTS(all_tests);
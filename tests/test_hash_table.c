@@ -0,0 +1,100 @@
+#include "minunit.h"
+#include "hash_table.h"
+
+mu_suite_start();
+int tests_run = 0;
+
+#define MAP_SIZE 1024 * 1024 * 8
+#define KEY_COUNT 20000
+
+typedef struct TileEntry {
+    u32 level;
+    u32 hits;
+} TileEntry;
+
+char *test_insert_find() {
+    memMap* map = initMemMap(MAP_SIZE);
+    PageArena* arena = createPageArena(map, MAP_SIZE / 2);
+    HashTable table;
+    mu_assert(hashInit(&table, arena, KEY_COUNT, sizeof(TileEntry)) == 0, "Expected table init.");
+    for (u32 i = 0; i < KEY_COUNT; i++) {
+        u32 inserted = 0;
+        TileEntry* e = hashInsert(&table, (u64)i * 7919, &inserted);
+        mu_assert(e && inserted, "Expected a fresh entry.");
+        e->level = i;
+    }
+    u32 inserted = 1;
+    TileEntry* again = hashInsert(&table, 7919, &inserted);
+    mu_assert(again && !inserted && again->level == 1, "Existing key should return its entry.");
+    for (u32 i = 0; i < KEY_COUNT; i++) {
+        TileEntry* e = hashFind(&table, (u64)i * 7919);
+        mu_assert(e && e->level == i, "Expected every key to be found.");
+    }
+    mu_assert(hashFind(&table, 1) == NULL, "Missing key should not be found.");
+    arenaPagePop(map);
+    releasePages(map);
+    fprintf(stdout, "[X] Insert and find.\n");
+    return NULL;
+}
+
+char *test_remove_keeps_runs() {
+    memMap* map = initMemMap(MAP_SIZE);
+    PageArena* arena = createPageArena(map, MAP_SIZE / 2);
+    HashTable table;
+    mu_assert(hashInit(&table, arena, KEY_COUNT, sizeof(u64)) == 0, "Expected table init.");
+    for (u32 i = 0; i < KEY_COUNT; i++) {
+        u64* v = hashInsert(&table, i, NULL);
+        *v = i;
+    }
+    for (u32 i = 0; i < KEY_COUNT; i += 2) {
+        mu_assert(hashRemove(&table, i) == 0, "Expected key removed.");
+    }
+    mu_assert(hashRemove(&table, 0) == -1, "Removing twice should fail.");
+    mu_assert(table.count == KEY_COUNT / 2, "Count should drop by the removed keys.");
+    for (u32 i = 0; i < KEY_COUNT; i++) {
+        u64* v = hashFind(&table, i);
+        if(i % 2) {
+            mu_assert(v && *v == i, "Kept keys must survive backward shifts.");
+        } else {
+            mu_assert(v == NULL, "Removed keys must be gone.");
+        }
+    }
+    for (u32 i = 0; i < table.capacity; i++) {
+        mu_assert(table.ctrl[i] == HASH_CTRL_EMPTY || table.ctrl[i] < 0x80, "No tombstones expected.");
+    }
+    for (u32 i = 0; i < HASH_GROUP_WIDTH; i++) {
+        mu_assert(table.ctrl[table.capacity + i] == table.ctrl[i], "Mirrored control bytes out of sync.");
+    }
+    arenaPagePop(map);
+    releasePages(map);
+    fprintf(stdout, "[X] Remove with backward shift.\n");
+    return NULL;
+}
+
+char *test_clear_and_full() {
+    memMap* map = initMemMap(MAP_SIZE);
+    PageArena* arena = createPageArena(map, MAP_SIZE / 2);
+    HashTable table;
+    mu_assert(hashInit(&table, arena, 10, 0) == 0, "Expected table init.");
+    u32 stored = 0;
+    for (u32 i = 0; i < 1000 && hashInsert(&table, i, NULL); i++) {
+        stored++;
+    }
+    mu_assert(stored == table.maxCount, "Insert should stop at the load limit.");
+    hashClear(&table);
+    mu_assert(table.count == 0 && hashFind(&table, 3) == NULL, "Clear should empty the table.");
+    mu_assert(hashInsert(&table, 3, NULL) != NULL, "Cleared table should accept keys.");
+    arenaPagePop(map);
+    releasePages(map);
+    fprintf(stdout, "[X] Clear and load limit.\n");
+    return NULL;
+}
+
+static char* all_tests() {
+    mu_run_test(test_insert_find);
+    mu_run_test(test_remove_keeps_runs);
+    mu_run_test(test_clear_and_full);
+    return NULL;
+}
+
+RUN_TESTS(all_tests);
@@ -0,0 +1,280 @@
+#include "minunit.h"
+#include "linmath.h"
+#include "lod.h"
+#include "vcache.h"
+
+mu_suite_start();
+int tests_run = 0;
+
+#define MAP_SIZE 1024 * 1024 * 8
+#define CHUNKS 4
+#define SIDE (CHUNKS * LOD_CHUNK + 1)
+
+static i64 signedTwiceArea(u16 a, u16 b, u16 c) {
+    i64 ax = a % LOD_CHUNK_SIDE, ay = a / LOD_CHUNK_SIDE;
+    i64 bx = b % LOD_CHUNK_SIDE, by = b / LOD_CHUNK_SIDE;
+    i64 cx = c % LOD_CHUNK_SIDE, cy = c / LOD_CHUNK_SIDE;
+    return (bx - ax) * (cy - ay) - (cx - ax) * (by - ay);
+}
+
+static i64 twiceArea(u16 a, u16 b, u16 c) {
+    i64 ax = a % LOD_CHUNK_SIDE, ay = a / LOD_CHUNK_SIDE;
+    i64 bx = b % LOD_CHUNK_SIDE, by = b / LOD_CHUNK_SIDE;
+    i64 cx = c % LOD_CHUNK_SIDE, cy = c / LOD_CHUNK_SIDE;
+    i64 area = (bx - ax) * (cy - ay) - (cx - ax) * (by - ay);
+    return area < 0 ? -area : area;
+}
+
+char *test_templates_cover_chunk() {
+    memMap* map = initMemMap(MAP_SIZE);
+    PageArena* arena = createPageArena(map, MAP_SIZE / 2);
+    ZetaLod lod;
+    mu_assert(lodInit(&lod, arena, SIDE, SIDE) == 0, "Expected LOD over whole chunks.");
+    mu_assert(lodInit(&lod, arena, SIDE + 1, SIDE) != 0, "Partial chunks should be rejected.");
+    mu_assert(lodInit(&lod, arena, SIDE, SIDE) == 0, "Expected LOD over whole chunks.");
+    for (u32 l = 0; l < LOD_LEVELS; l++) {
+        u32 coarse = 2u << l;
+        for (u32 e = 0; e < LOD_EDGE_VARIANTS; e++) {
+            const LodRange* range = &lod.ranges[l][e];
+            const u16* strip = &lod.indices[range->offset];
+            i64 area = 0;
+            u32 snapped = 1;
+            u32 triangles = 0;
+            for (u32 i = 0; i < range->count; i++) {
+                if(strip[i] == LOD_RESTART) {
+                    continue;
+                }
+                mu_assert(strip[i] < LOD_CHUNK_VERTICES, "Template indices should stay inside one chunk.");
+                if(i >= 2 && strip[i - 1] != LOD_RESTART && strip[i - 2] != LOD_RESTART) {
+                    area += twiceArea(strip[i - 2], strip[i - 1], strip[i]);
+                    triangles += (strip[i - 2] != strip[i - 1] && strip[i - 1] != strip[i] && strip[i - 2] != strip[i]);
+                }
+                u32 x = strip[i] % LOD_CHUNK_SIDE;
+                u32 y = strip[i] / LOD_CHUNK_SIDE;
+                if(coarse <= LOD_CHUNK) {
+                    snapped &= !((e & LOD_EDGE_TOP) && y == 0 && x % coarse);
+                    snapped &= !((e & LOD_EDGE_BOTTOM) && y == LOD_CHUNK && x % coarse);
+                    snapped &= !((e & LOD_EDGE_LEFT) && x == 0 && y % coarse);
+                    snapped &= !((e & LOD_EDGE_RIGHT) && x == LOD_CHUNK && y % coarse);
+                }
+            }
+            mu_assert(area == 2 * LOD_CHUNK * LOD_CHUNK, "Every template should tile the chunk exactly.");
+            mu_assert(triangles == range->triangles, "Range should count the strip's real triangles.");
+            mu_assert(snapped, "Stitched edges should only use the coarser neighbour's samples.");
+        }
+    }
+    arenaPagePop(map);
+    releasePages(map);
+    fprintf(stdout, "[X] LOD templates tile the chunk and stitch.\n");
+    return NULL;
+}
+
+//strip triangles as a list, both orders then go through the same cache model
+//odd triangles after a restart are wound (b, a, c) like GL draws them
+static u32 stripToList(u32* out, const u16* strip, u32 count) {
+    u32 n = 0;
+    u32 first = 0;
+    for (u32 i = 0; i < count; i++) {
+        if(strip[i] == LOD_RESTART) {
+            first = i + 1;
+            continue;
+        }
+        if(i < first + 2) {
+            continue;
+        }
+        u16 a = strip[i - 2], b = strip[i - 1], c = strip[i];
+        if(a != b && b != c && a != c) {
+            u32 odd = (i - first) & 1;
+            out[n++] = odd ? b : a;
+            out[n++] = odd ? a : b;
+            out[n++] = c;
+        }
+    }
+    return n;
+}
+
+char *test_cache_order_tiles_and_saves() {
+    memMap* map = initMemMap(MAP_SIZE);
+    PageArena* arena = createPageArena(map, MAP_SIZE / 2);
+    ZetaLod lod;
+    u32* list = arenaPageAlloc(arena, LOD_CHUNK * LOD_CHUNK * 6 * sizeof(u32), ALIGN_16);
+    mu_assert(list && lodInit(&lod, arena, SIDE, SIDE) == 0, "Expected LOD setup.");
+    VcacheStats strips, cached;
+    //every strip triangle faces the same way, the lists must keep that orientation,
+    //snapped edges leave a few collinear slivers with no area and no winding
+    i64 stripSign = 0;
+    for (u32 l = 0; l < LOD_LEVELS; l++) {
+        for (u32 e = 0; e < LOD_EDGE_VARIANTS; e++) {
+            const LodRange* range = &lod.ranges[l][e];
+            u32 n = stripToList(list, &lod.indices[range->offset], range->count);
+            for (u32 i = 0; i < n; i += 3) {
+                i64 area = signedTwiceArea(list[i], list[i + 1], list[i + 2]);
+                stripSign = (stripSign || area == 0) ? stripSign : (area > 0 ? 1 : -1);
+                mu_assert(area * stripSign >= 0, "Strip triangles should share one winding.");
+            }
+        }
+    }
+    u32 count = stripToList(list, &lod.indices[lod.ranges[0][0].offset], lod.ranges[0][0].count);
+    mu_assert(vcacheMeasure(&strips, list, count, LOD_CHUNK_VERTICES, 16, arena) == 0, "Expected strip stats.");
+
+    mu_assert(lodCacheOptimize(&lod, arena) == 0 && lod.order == LOD_ORDER_CACHE, "Expected cache ordered templates.");
+    for (u32 l = 0; l < LOD_LEVELS; l++) {
+        for (u32 e = 0; e < LOD_EDGE_VARIANTS; e++) {
+            const LodRange* range = &lod.ranges[l][e];
+            i64 area = 0;
+            for (u32 i = 0; i < range->count; i += 3) {
+                const u16* tri = &lod.indices[range->offset + i];
+                i64 signedArea = signedTwiceArea(lod.vertexOrder[tri[0]], lod.vertexOrder[tri[1]], lod.vertexOrder[tri[2]]);
+                mu_assert(signedArea * stripSign >= 0, "Reordered triangles should keep the strips' winding.");
+                area += signedArea * stripSign;
+            }
+            mu_assert(area == 2 * LOD_CHUNK * LOD_CHUNK, "Reordered templates should still tile the chunk.");
+        }
+    }
+    for (u32 i = 0; i < lod.ranges[0][0].count; i++) {
+        list[i] = lod.indices[lod.ranges[0][0].offset + i];
+    }
+    mu_assert(vcacheMeasure(&cached, list, lod.ranges[0][0].count, LOD_CHUNK_VERTICES, 16, arena) == 0, "Expected stats.");
+    mu_assert(cached.triangles == strips.triangles && cached.acmr < strips.acmr, "Cache order should shade fewer vertices.");
+    arenaPagePop(map);
+    releasePages(map);
+    fprintf(stdout, "[X] Cache ordered templates tile the chunk, ACMR %.3f -> %.3f.\n", strips.acmr, cached.acmr);
+    return NULL;
+}
+
+char *test_select_limits_neighbours() {
+    memMap* map = initMemMap(MAP_SIZE);
+    PageArena* arena = createPageArena(map, MAP_SIZE / 2);
+    ZetaLod lod;
+    ZetaVertex* grid = arenaPageAlloc(arena, SIDE * SIDE * sizeof(ZetaVertex), ALIGN_16);
+    mu_assert(grid && lodInit(&lod, arena, SIDE, SIDE) == 0, "Expected LOD setup.");
+    ZetaVertex* packed = arenaPageAlloc(arena, lod.vertexCount * sizeof(ZetaVertex), ALIGN_16);
+    mu_assert(packed && lod.vertexCount == lodVertexCount(SIDE, SIDE), "Expected a packed vertex buffer.");
+    //flat sheet with one sample poking up in the first chunk
+    for (u32 y = 0; y < SIDE; y++) {
+        for (u32 x = 0; x < SIDE; x++) {
+            ZetaVertex* v = &grid[y * SIDE + x];
+            v->re = (f32)x;
+            v->im = (f32)y;
+            v->mag = (x == 5 && y == 5) ? 10.0f : 0.0f;
+            v->arg = 0.0f;
+        }
+    }
+    lodBuild(&lod, grid, packed);
+    const ZetaVertex* corner = &packed[lod.chunks[CHUNKS + 1].baseVertex + LOD_CHUNK_VERTICES - 1];
+    mu_assert(corner->re == 2 * LOD_CHUNK && corner->im == 2 * LOD_CHUNK, "Chunks should be packed with their edges.");
+    mu_assert(lod.chunks[1].error[LOD_LEVELS - 1] == 0.0f, "Flat chunks should have no error.");
+    mu_assert(lod.chunks[0].error[1] > 0.0f, "The bump should show up as error.");
+
+    f32 far[3] = { 64.0f, 64.0f, 100000.0f };
+    lodSelect(&lod, far, NULL, 1.0f, 1000.0f, LOD_PIXEL_ERROR);
+    mu_assert(lod.chunks[0].level == LOD_LEVELS - 1, "Far away everything should be coarsest.");
+
+    f32 near[3] = { 5.0f, 5.0f, 11.0f };
+    u32 drawn = lodSelect(&lod, near, NULL, 1.0f, 1000.0f, LOD_PIXEL_ERROR);
+    mu_assert(lod.chunks[0].level == 0, "The bump should be drawn at full detail up close.");
+    mu_assert(lod.drawCount == CHUNKS * CHUNKS && drawn > 0, "Expected one draw per chunk.");
+    u32 limited = 1;
+    for (u32 cy = 0; cy < CHUNKS; cy++) {
+        for (u32 cx = 0; cx + 1 < CHUNKS; cx++) {
+            i32 a = (i32)lod.chunks[cy * CHUNKS + cx].level;
+            i32 b = (i32)lod.chunks[cy * CHUNKS + cx + 1].level;
+            i32 c = (i32)lod.chunks[cx * CHUNKS + cy].level;
+            i32 d = (i32)lod.chunks[(cx + 1) * CHUNKS + cy].level;
+            limited &= (a - b <= 1 && b - a <= 1 && c - d <= 1 && d - c <= 1);
+        }
+    }
+    mu_assert(limited, "Neighbouring chunks should be at most one level apart.");
+    arenaPagePop(map);
+    releasePages(map);
+    fprintf(stdout, "[X] LOD selection limits neighbours.\n");
+    return NULL;
+}
+
+char *test_frustum_culls_behind() {
+    memMap* map = initMemMap(MAP_SIZE);
+    PageArena* arena = createPageArena(map, MAP_SIZE / 2);
+    ZetaLod lod;
+    ZetaVertex* grid = arenaPageAlloc(arena, SIDE * SIDE * sizeof(ZetaVertex), ALIGN_16);
+    mu_assert(grid && lodInit(&lod, arena, SIDE, SIDE) == 0, "Expected LOD setup.");
+    for (u32 y = 0; y < SIDE; y++) {
+        for (u32 x = 0; x < SIDE; x++) {
+            grid[y * SIDE + x] = (ZetaVertex){ (f32)x, (f32)y, 0.0f, 0.0f };
+        }
+    }
+    lodBuild(&lod, grid, NULL);
+    //standing over the first chunk looking down at it, the rest of the sheet is out of view
+    mat4x4 projection, view, clip;
+    mat4x4_perspective(projection, 0.5f, 1.0f, 0.01f, 500.0f);
+    vec3 eye = { 16.0f, 16.0f, 20.0f };
+    vec3 center = { 16.0f, 16.0f, 0.0f };
+    vec3 up = { 0.0f, 1.0f, 0.0f };
+    mat4x4_look_at(view, eye, center, up);
+    mat4x4_mul(clip, projection, view);
+    LodFrustum frustum;
+    lodFrustumFromMatrix(&frustum, (const f32*)clip);
+    lodSelect(&lod, eye, &frustum, 0.5f, 1000.0f, LOD_PIXEL_ERROR);
+    mu_assert(lod.stats.drawCalls >= 1 && lod.stats.culled > 0, "Chunks out of view should be culled.");
+    mu_assert(lod.stats.drawCalls + lod.stats.culled == CHUNKS * CHUNKS, "Every chunk is drawn or culled.");
+    mu_assert(lod.draws[0].baseVertex == 0, "The chunk under the camera should be drawn.");
+    mu_assert(lod.stats.drawnTriangles < lod.stats.lodTriangles, "Culling should save triangles.");
+    arenaPagePop(map);
+    releasePages(map);
+    fprintf(stdout, "[X] Frustum culls chunks out of view.\n");
+    return NULL;
+}
+
+char *test_unorm16_within_bound() {
+    memMap* map = initMemMap(MAP_SIZE);
+    PageArena* arena = createPageArena(map, MAP_SIZE / 2);
+    ZetaLod lod;
+    ZetaVertex* grid = arenaPageAlloc(arena, SIDE * SIDE * sizeof(ZetaVertex), ALIGN_16);
+    mu_assert(grid && lodInit(&lod, arena, SIDE, SIDE) == 0, "Expected LOD setup.");
+    LodVertex* packed = arenaPageAlloc(arena, lod.vertexCount * sizeof(LodVertex), ALIGN_16);
+    mu_assert(packed && sizeof(LodVertex) * 2 == sizeof(ZetaVertex), "unorm16 vertices should be half size.");
+    for (u32 y = 0; y < SIDE; y++) {
+        for (u32 x = 0; x < SIDE; x++) {
+            f32 re = 0.01f * x, im = 5.0f + 0.1f * y;
+            grid[y * SIDE + x] = (ZetaVertex){ re, im, sqrtf(re * re + im * im), atan2f(im, re - 0.5f) };
+        }
+    }
+    lod.format = LOD_FORMAT_UNORM16;
+    lodBuild(&lod, grid, packed);
+    f32 bound = lodQuantizationError(&lod);
+    f32 worst = 0.0f;
+    f32 worstArg = 0.0f;
+    for (u32 c = 0; c < lod.chunkCount; c++) {
+        const LodChunk* chunk = &lod.chunks[c];
+        u32 x0 = (c % CHUNKS) * LOD_CHUNK, y0 = (c / CHUNKS) * LOD_CHUNK;
+        for (u32 i = 0; i < LOD_CHUNK_VERTICES; i++) {
+            const LodVertex* q = &packed[chunk->baseVertex + i];
+            const ZetaVertex* v = &grid[(y0 + i / LOD_CHUNK_SIDE) * SIDE + x0 + i % LOD_CHUNK_SIDE];
+            f32 p[3] = { v->re, v->im, v->mag };
+            f32 d2 = 0.0f;
+            for (u32 k = 0; k < 3; k++) {
+                f32 d = chunk->origin[k] + q->pos[k] / LOD_UNORM16_MAX * chunk->extent[k] - p[k];
+                d2 += d * d;
+            }
+            f32 arg = -LOD_ARG_RANGE + q->arg / LOD_UNORM16_MAX * 2.0f * LOD_ARG_RANGE;
+            worst = (sqrtf(d2) > worst) ? sqrtf(d2) : worst;
+            worstArg = (fabsf(arg - v->arg) > worstArg) ? fabsf(arg - v->arg) : worstArg;
+        }
+    }
+    mu_assert(bound > 0.0f && worst <= bound * 1.01f, "Decoded positions should stay within the stated bound.");
+    mu_assert(worstArg <= 1.01f * LOD_ARG_RANGE / LOD_UNORM16_MAX, "Decoded arg should be within half a step.");
+    arenaPagePop(map);
+    releasePages(map);
+    fprintf(stdout, "[X] unorm16 vertices decode within %g.\n", bound);
+    return NULL;
+}
+
+static char* all_tests() {
+    mu_run_test(test_templates_cover_chunk);
+    mu_run_test(test_cache_order_tiles_and_saves);
+    mu_run_test(test_select_limits_neighbours);
+    mu_run_test(test_frustum_culls_behind);
+    mu_run_test(test_unorm16_within_bound);
+    return NULL;
+}
+
+RUN_TESTS(all_tests);
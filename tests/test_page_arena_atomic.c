@@ -0,0 +1,118 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "minunit.h"
+#include "page_arena.h"
+
+mu_suite_start();
+int tests_run = 0;
+
+#define RESERVE_SIZE MiB(256)
+#define ARENA_SIZE MiB(128)
+#define THREADS 8
+#define ALLOCS 4000
+//small enough that threads refill often and some requests skip the chunk
+#define CHUNK_SIZE 1024 * 16
+
+typedef struct Block {
+    byte base;
+    usize size;
+    u32 thread;
+} Block;
+
+typedef struct Worker {
+    PageArena* arena;
+    Block blocks[ALLOCS];
+    u32 count;
+    u32 thread;
+    u32 misaligned;
+} Worker;
+
+static Worker workers[THREADS];
+static Block all[THREADS * ALLOCS];
+static u32 start;
+
+static const usize alignments[] = { ALIGN_1, ALIGN_2, ALIGN_4, ALIGN_8, ALIGN_16, ALIGN_32, ALIGN_64, ALIGN_128 };
+
+static void* allocLoop(void* ctx) {
+    Worker* worker = ctx;
+    ArenaChunk chunk;
+    arenaChunkInit(&chunk, worker->arena, CHUNK_SIZE);
+    u32 seed = worker->thread * 2654435761u + 1;
+    while(!__atomic_load_n(&start, __ATOMIC_ACQUIRE)) {
+    }
+    for (u32 i = 0; i < ALLOCS; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        //mostly small, every 16th larger than a quarter chunk so it takes the shared path
+        usize size = ((seed >> 8) & 15) == 0 ? CHUNK_SIZE / 4 + 1 + (seed >> 16) % 8192 : 1 + (seed >> 16) % 512;
+        usize alignment = alignments[(seed >> 4) % 8];
+        byte p = arenaChunkAlloc(&chunk, size, alignment);
+        if(!p) {
+            break;
+        }
+        if((usize)p % alignment != 0) {
+            worker->misaligned++;
+        }
+        //writes fault if the page was never committed
+        memset(p, (int)(worker->thread + 1), size);
+        worker->blocks[worker->count++] = (Block){ .base = p, .size = size, .thread = worker->thread };
+    }
+    return NULL;
+}
+
+static int byBase(const void* a, const void* b) {
+    const Block* x = a;
+    const Block* y = b;
+    return (x->base > y->base) - (x->base < y->base);
+}
+
+char *test_concurrent_chunks_disjoint() {
+    memMap* map = initMemMapReserve(RESERVE_SIZE);
+    mu_assert(map, "Expected a growable map.");
+    PageArena* arena = createPageArena(map, ARENA_SIZE);
+    mu_assert(arena && arena->committed == 0, "A reserved arena should start with nothing committed.");
+
+    pthread_t threads[THREADS];
+    for (u32 t = 0; t < THREADS; t++) {
+        workers[t].arena = arena;
+        workers[t].thread = t;
+        pthread_create(&threads[t], NULL, allocLoop, &workers[t]);
+    }
+    __atomic_store_n(&start, 1, __ATOMIC_RELEASE);
+    u32 count = 0;
+    for (u32 t = 0; t < THREADS; t++) {
+        pthread_join(threads[t], NULL);
+        mu_assert(workers[t].count == ALLOCS, "Every allocation should fit in the arena.");
+        mu_assert(workers[t].misaligned == 0, "Every pointer should honour its alignment.");
+        memcpy(&all[count], workers[t].blocks, workers[t].count * sizeof(Block));
+        count += workers[t].count;
+    }
+
+    qsort(all, count, sizeof(Block), byBase);
+    for (u32 i = 0; i < count; i++) {
+        mu_assert(all[i].base >= arena->base && all[i].base + all[i].size <= arena->base + arena->offset,
+                "Blocks should lie below the arena offset.");
+        mu_assert(i + 1 == count || all[i].base + all[i].size <= all[i + 1].base, "No two blocks may overlap.");
+        for (usize b = 0; b < all[i].size; b++) {
+            mu_assert(all[i].base[b] == (u8)(all[i].thread + 1), "A block was written by another thread.");
+        }
+    }
+
+    //the largest end sets the offset, committed is exactly that rounded up to a page
+    usize pageSize = map->pageSize;
+    mu_assert(arena->committed % pageSize == 0, "Committed bytes should be whole pages.");
+    mu_assert(arena->committed >= arena->offset && arena->committed - arena->offset < pageSize,
+            "Committed pages should cover the offset and nothing past its page.");
+
+    arenaPagePop(map);
+    releasePages(map);
+    fprintf(stdout, "[X] %u threads made %u disjoint aligned allocations.\n", THREADS, count);
+    return NULL;
+}
+
+static char* all_tests() {
+    mu_run_test(test_concurrent_chunks_disjoint);
+    return NULL;
+}
+
+RUN_TESTS(all_tests);
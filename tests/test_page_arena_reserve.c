@@ -0,0 +1,100 @@
+#include <string.h>
+#include "minunit.h"
+#include "page_arena.h"
+
+mu_suite_start();
+int tests_run = 0;
+
+#define RESERVE_SIZE MiB(64)
+#define FIRST_SIZE KiB(16)
+#define EXTRA_ARENAS 5
+
+//the newest arena grows by doubling into the reservation, committing only the pages it touches
+char *test_arena_grows() {
+    memMap* map = initMemMapReserve(RESERVE_SIZE);
+    mu_assert(map && map->growable, "Expected a growable map.");
+    usize pageSize = map->pageSize;
+    PageArena* arena = createPageArena(map, FIRST_SIZE);
+    mu_assert(arena && arena->size == FIRST_SIZE && arena->committed == 0, "A new arena should commit nothing.");
+
+    byte small = arenaPageAlloc(arena, KiB(10), ALIGN_16);
+    mu_assert(small && arena->size == FIRST_SIZE, "Fitting allocations should not grow the arena.");
+    mu_assert(arena->committed == KiB(10) + AlignPad(KiB(10), pageSize), "Only touched pages should be committed.");
+
+    byte big = arenaPageAlloc(arena, KiB(100), ALIGN_64);
+    mu_assert(big, "Allocating past the requested size should grow the arena.");
+    memset(big, 0xAB, KiB(100));
+    mu_assert(arena->size == KiB(128), "Growth should double the arena until the request fits.");
+    mu_assert(arena->committed % pageSize == 0 && arena->committed >= arena->offset &&
+            arena->committed - arena->offset < pageSize, "Committed should cover the offset to the next page.");
+    mu_assert(map->offset == arena->mapOffset + arena->size, "The map should end at the grown arena.");
+
+    mu_assert(arenaPageAlloc(arena, RESERVE_SIZE, ALIGN_8) == NULL, "Growth should stop at the reservation.");
+    mu_assert(arena->size == KiB(128), "A failed growth should leave the arena alone.");
+
+    //only the newest arena borders free address space
+    PageArena* newer = createPageArena(map, FIRST_SIZE);
+    mu_assert(newer, "Expected a second arena.");
+    usize before = arena->size;
+    mu_assert(arenaPageAlloc(arena, before, ALIGN_8) == NULL && arena->size == before, "An older arena should not grow.");
+    mu_assert(arenaPageAlloc(newer, FIRST_SIZE * 3, ALIGN_8) != NULL && newer->size == FIRST_SIZE * 4,
+            "The newest arena should still grow.");
+
+    arenaPagePop(map);
+    arenaPagePop(map);
+    releasePages(map);
+
+    memMap* fixed = initMemMap(MiB(1));
+    PageArena* bounded = createPageArena(fixed, FIRST_SIZE);
+    mu_assert(bounded->committed == FIRST_SIZE, "A fixed map commits the whole arena up front.");
+    mu_assert(arenaPageAlloc(bounded, FIRST_SIZE + 1, ALIGN_8) == NULL && bounded->size == FIRST_SIZE,
+            "Arenas on a fixed map should not grow.");
+    arenaPagePop(fixed);
+    releasePages(fixed);
+    fprintf(stdout, "[X] Reserved arenas grow to %d KiB and commit by page.\n", 128);
+    return NULL;
+}
+
+//descriptors past the first page of the table are committed as arenas are created, popping gives it all back
+char *test_descriptor_table_and_pop() {
+    memMap* map = initMemMapReserve(RESERVE_SIZE);
+    usize pageSize = map->pageSize;
+    mu_assert(map->tableSize == pageSize, "The table should start with one committed page.");
+    u32 perPage = (u32)((pageSize - sizeof(memMap)) / sizeof(PageArena));
+    u32 count = perPage + EXTRA_ARENAS;
+    for (u32 k = 0; k < count; k++) {
+        PageArena* arena = createPageArena(map, pageSize);
+        mu_assert(arena, "Expected every arena to be created.");
+        u32* p = arenaPageAlloc(arena, sizeof(u32), ALIGN_4);
+        mu_assert(p, "Expected an allocation in every arena.");
+        *p = k;
+    }
+    mu_assert(map->arenaCount == count, "Every arena should be counted.");
+    mu_assert(map->tableSize > pageSize && map->tableSize % pageSize == 0, "The table should grow by whole pages.");
+    mu_assert(map->tableSize >= sizeof(memMap) + count * sizeof(PageArena) && map->tableSize <= map->tableLimit,
+            "The table should cover every descriptor within its reservation.");
+    mu_assert(*(u32*)map->arenaCurrent->base == count - 1, "The newest arena should keep its data.");
+
+    for (u32 k = 0; k < count; k++) {
+        arenaPagePop(map);
+    }
+    mu_assert(map->offset == 0 && map->arenaCount == 0 && map->arenaCurrent == NULL, "Popping every arena should empty the map.");
+
+    //the popped range is decommitted, a new arena starts from nothing and commits again
+    PageArena* again = createPageArena(map, pageSize);
+    mu_assert(again && again->committed == 0 && again->mapOffset == 0, "A new arena should reuse the start of the map.");
+    u32* p = arenaPageAlloc(again, sizeof(u32), ALIGN_4);
+    mu_assert(p && *p == 0, "Recommitted pages should come back zeroed.");
+    arenaPagePop(map);
+    releasePages(map);
+    fprintf(stdout, "[X] %u arenas grew the descriptor table and popped back to empty.\n", count);
+    return NULL;
+}
+
+static char* all_tests() {
+    mu_run_test(test_arena_grows);
+    mu_run_test(test_descriptor_table_and_pop);
+    return NULL;
+}
+
+RUN_TESTS(all_tests);
@@ -0,0 +1,134 @@
+#include "minunit.h"
+#include "parallel.h"
+
+mu_suite_start();
+int tests_run = 0;
+
+#define WORKERS 4
+#define RANGE_COUNT 10000
+#define CHILD_COUNT 100
+//enough rounds that the root outlives several trips around every job pool
+#define ROOT_ROUNDS 400
+#define ROOT_RANGE 100000
+
+static u32 hits[RANGE_COUNT];
+
+static void countHits(void* ctx, u32 begin, u32 end) {
+    for (u32 i = begin; i < end; i++) {
+        __atomic_add_fetch(&hits[i], 1, __ATOMIC_RELAXED);
+    }
+}
+
+char *test_parallel_for_covers_range() {
+    parallelFor(RANGE_COUNT, 7, countHits, NULL);
+    for (u32 i = 0; i < RANGE_COUNT; i++) {
+        mu_assert(hits[i] == 1, "Every index should be visited exactly once.");
+    }
+    fprintf(stdout, "[X] parallelFor covers the range once.\n");
+    return NULL;
+}
+
+typedef struct GraphState {
+    u32 clock;
+    u32 stamp[4];
+    u32 children;
+    u32 childrenAtJoin;
+} GraphState;
+
+static void childWork(Job* job, void* ctx, u32 begin, u32 end) {
+    GraphState* state = ctx;
+    __atomic_add_fetch(&state->children, 1, __ATOMIC_RELAXED);
+}
+
+//stage 0 fans out children, stages 1 and 2 follow it, stage 3 joins them
+static void stage(Job* job, void* ctx, u32 begin, u32 end) {
+    GraphState* state = ctx;
+    if(begin == 0) {
+        for (u32 i = 0; i < CHILD_COUNT; i++) {
+            Job* child = jobCreate(job, childWork, state, 0, 0);
+            if(child) {
+                jobSubmit(child);
+            } else {
+                childWork(NULL, state, 0, 0);
+            }
+        }
+    }
+    if(begin == 3) {
+        state->childrenAtJoin = __atomic_load_n(&state->children, __ATOMIC_RELAXED);
+    }
+    state->stamp[begin] = __atomic_add_fetch(&state->clock, 1, __ATOMIC_ACQ_REL);
+}
+
+char *test_job_graph_order() {
+    GraphState state = {0};
+    Job* jobs[4];
+    for (u32 i = 0; i < 4; i++) {
+        jobs[i] = jobCreate(NULL, stage, &state, i, 0);
+        mu_assert(jobs[i] != NULL, "Expected a job from the main thread.");
+    }
+    mu_assert(jobDepend(jobs[1], jobs[0]) == 0 && jobDepend(jobs[2], jobs[0]) == 0, "Expected dependencies.");
+    mu_assert(jobDepend(jobs[3], jobs[1]) == 0 && jobDepend(jobs[3], jobs[2]) == 0, "Expected join dependencies.");
+    for (u32 i = 4; i > 0; i--) {
+        jobSubmit(jobs[i - 1]);
+    }
+    jobWait(jobs[3]);
+    mu_assert(state.stamp[0] < state.stamp[1] && state.stamp[0] < state.stamp[2], "Stages should follow stage 0.");
+    mu_assert(state.stamp[3] > state.stamp[1] && state.stamp[3] > state.stamp[2], "Join should run last.");
+    mu_assert(state.childrenAtJoin == CHILD_COUNT, "Children should finish before the continuations run.");
+    fprintf(stdout, "[X] Job graph runs in dependency order.\n");
+    return NULL;
+}
+
+static u32 nestedSum;
+
+static void innerRows(void* ctx, u32 begin, u32 end) {
+    __atomic_add_fetch(&nestedSum, end - begin, __ATOMIC_RELAXED);
+}
+
+static void outerRows(void* ctx, u32 begin, u32 end) {
+    for (u32 i = begin; i < end; i++) {
+        parallelFor(64, 4, innerRows, NULL);
+    }
+}
+
+char *test_nested_parallel_for() {
+    parallelFor(32, 1, outerRows, NULL);
+    mu_assert(nestedSum == 32 * 64, "Nested loops should run every inner iteration.");
+    fprintf(stdout, "[X] Nested parallelFor.\n");
+    return NULL;
+}
+
+static u64 rootSum;
+
+static void rootRows(void* ctx, u32 begin, u32 end) {
+    __atomic_add_fetch(&rootSum, end - begin, __ATOMIC_RELAXED);
+}
+
+//every slot a nested loop takes wraps around to the root's own slot on worker 0 at some point
+static void longRoot(Job* job, void* ctx, u32 begin, u32 end) {
+    for (u32 i = 0; i < ROOT_ROUNDS; i++) {
+        parallelFor(ROOT_RANGE, 1, rootRows, NULL);
+    }
+}
+
+char *test_root_outlives_pool() {
+    Job* root = jobCreate(NULL, longRoot, NULL, 0, 0);
+    mu_assert(root != NULL, "Expected a root job.");
+    jobSubmit(root);
+    jobWait(root);
+    mu_assert(rootSum == (u64)ROOT_ROUNDS * ROOT_RANGE, "Every round under the root should run in full.");
+    fprintf(stdout, "[X] %u nested loops under one root job.\n", ROOT_ROUNDS);
+    return NULL;
+}
+
+static char* all_tests() {
+    parallelInit(WORKERS);
+    mu_run_test(test_parallel_for_covers_range);
+    mu_run_test(test_job_graph_order);
+    mu_run_test(test_nested_parallel_for);
+    mu_run_test(test_root_outlives_pool);
+    parallelShutdown();
+    return NULL;
+}
+
+RUN_TESTS(all_tests);
@@ -0,0 +1,100 @@
+#include "minunit.h"
+#include "plan.h"
+#include "lod.h"
+#include "zeta.h"
+
+mu_suite_start();
+int tests_run = 0;
+
+#define SMALL_SIDE 20
+
+static PlanRequest request(usize budget) {
+    PlanRequest r = {
+        .budget = budget,
+        .aspect = 1.5f,
+        .evaluator = PLAN_EVAL_ZETA,
+        .warped = 1,
+        .vertexFormat = 0,
+        .workers = 4,
+        .workerScratch = MiB(1)
+    };
+    return r;
+}
+
+static u32 widthFor(u32 h, f32 aspect) {
+    f32 wf = (f32)h * aspect + 0.5f;
+    return (wf < 2.0f) ? 2 : (u32)wf;
+}
+
+//each plan fits its budget, a row more would not, and more budget never buys a smaller grid
+char *test_plan_fits_budget() {
+    static const usize budgets[] = { MiB(8), MiB(32), MiB(128), MiB(512), GiB(2) };
+    usize lastSamples = 0;
+    for (u32 k = 0; k < sizeof(budgets) / sizeof(budgets[0]); k++) {
+        PlanRequest r = request(budgets[k]);
+        GridPlan plan;
+        mu_assert(planGrid(&plan, &r) == 0, "Expected a plan.");
+        mu_assert(plan.total <= budgets[k] && plan.budget == budgets[k], "The plan should fit the budget.");
+        mu_assert(plan.w == widthFor(plan.h, r.aspect), "The plan should keep the requested aspect.");
+        usize samples = (usize)plan.w * plan.h;
+        mu_assert(samples > lastSamples, "A larger budget should give a larger grid.");
+        lastSamples = samples;
+
+        GridPlan bigger;
+        planMeasure(&bigger, &r, widthFor(plan.h + 1, r.aspect), plan.h + 1);
+        mu_assert(bigger.total > budgets[k], "One more row should not fit, the plan should be the largest.");
+        usize host = plan.field + plan.vertices + plan.indices + plan.lattice + plan.pyramid + plan.contour +
+            plan.workerScratch;
+        mu_assert(plan.meshArenaSize >= host && plan.total == plan.meshArenaSize + plan.evaluator + plan.gpu,
+                "The total should add up its stages.");
+    }
+    fprintf(stdout, "[X] Plans fit and grow with their budgets.\n");
+    return NULL;
+}
+
+char *test_plan_floor() {
+    //square, so the smallest candidate planGrid tries is exactly 2x2
+    PlanRequest r = request(0);
+    r.aspect = 1.0f;
+    GridPlan floor;
+    planMeasure(&floor, &r, 2, 2);
+    //the mesh arena rounds up to a huge page, so even 2x2 needs a couple of MiB
+    mu_assert(floor.total > PAGE_HUGE_SIZE, "The floor should include a whole huge page.");
+    GridPlan plan;
+    r.budget = floor.total - 1;
+    mu_assert(planGrid(&plan, &r) == -1, "A budget below a 2x2 grid should fail.");
+    r.budget = MiB(2);
+    mu_assert(planGrid(&plan, &r) == -1, "Two MiB is below the floor.");
+    r.budget = floor.total;
+    mu_assert(planGrid(&plan, &r) == 0 && plan.h >= 2 && plan.total <= r.budget, "The floor itself should fit.");
+    fprintf(stdout, "[X] Budgets below the %.2f MiB floor are rejected.\n", floor.total / (1024.0 * 1024.0));
+    return NULL;
+}
+
+//grids smaller than a chunk draw from a plain u32 index buffer, the host copy and the GPU copy both count it
+char *test_plan_small_grid_indices() {
+    PlanRequest r = request(GiB(1));
+    GridPlan small;
+    planMeasure(&small, &r, SMALL_SIDE, SMALL_SIDE);
+    usize indexBytes = (usize)(SMALL_SIDE - 1) * (SMALL_SIDE - 1) * 6 * sizeof(u32);
+    mu_assert(small.indices == indexBytes + PLAN_ALLOC_SLACK, "Small grids should reserve u32 indices on the host.");
+    mu_assert(small.gpu >= indexBytes + (usize)SMALL_SIDE * SMALL_SIDE * sizeof(ZetaVertex),
+            "Small grids should upload u32 indices and full vertices.");
+
+    //one chunk and up switches to the shared u16 templates
+    GridPlan chunked;
+    planMeasure(&chunked, &r, LOD_CHUNK + 1, LOD_CHUNK + 1);
+    usize templateBytes = sizeof(LodChunk) + sizeof(LodDraw) + lodTemplateCapacity() * sizeof(u16) + 3 * PLAN_ALLOC_SLACK;
+    mu_assert(chunked.indices == templateBytes, "A one chunk grid should count its chunk and the u16 templates.");
+    fprintf(stdout, "[X] Small grids plan %zu bytes of u32 indices.\n", indexBytes);
+    return NULL;
+}
+
+static char* all_tests() {
+    mu_run_test(test_plan_fits_budget);
+    mu_run_test(test_plan_floor);
+    mu_run_test(test_plan_small_grid_indices);
+    return NULL;
+}
+
+RUN_TESTS(all_tests);
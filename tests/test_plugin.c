@@ -0,0 +1,151 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "minunit.h"
+#include "plugin.h"
+#include "parallel.h"
+
+mu_suite_start();
+int tests_run = 0;
+
+#define ETA_TERMS 200
+#define ROW_COUNT 150
+#define ECHO_BATCH 7
+#define ECHO_ROWS 64
+
+//f32 kernel with a configurable header, it flags batches past its width and overlapping calls in re
+static const char* fixtureSource =
+    "#include \"plugin_api.h\"\n"
+    "#define STR(x) #x\n"
+    "#define NAME(x) STR(x)\n"
+    "static uint32_t inside;\n"
+    "static void echo(void* state, const float* sre, const float* sim, uint32_t count, float* re, float* im) {\n"
+    "    uint32_t bad = __atomic_add_fetch(&inside, 1, __ATOMIC_SEQ_CST) > 1 || count > FIXTURE_BATCH;\n"
+    "    for (volatile uint32_t spin = 0; spin < 2000; spin++) {\n"
+    "    }\n"
+    "    for (uint32_t l = 0; l < count; l++) {\n"
+    "        re[l] = bad ? -1.0f : sre[l];\n"
+    "        im[l] = sim[l];\n"
+    "    }\n"
+    "    __atomic_sub_fetch(&inside, 1, __ATOMIC_SEQ_CST);\n"
+    "}\n"
+    "static const ZetaPluginInfo info = { .abiVersion = FIXTURE_ABI, .flags = FIXTURE_FLAGS,\n"
+    "    .batchWidth = FIXTURE_BATCH, .name = NAME(FIXTURE_NAME), .evaluateF32 = echo };\n"
+    "const ZetaPluginInfo* zetaPluginDescribe(void) { return &info; }\n";
+
+static char directory[] = "/tmp/zeta_pluginsXXXXXX";
+static PluginRegistry registry;
+
+static i32 buildPlugin(const char* source, const char* name, const char* defines) {
+    char command[1024];
+    snprintf(command, sizeof(command), "cc -std=c99 -shared -fPIC -Isrc %s -o %s/%s.so %s -lm", defines, directory, name, source);
+    return system(command);
+}
+
+static i32 buildFixture(const char* name, u32 abi, u32 flags) {
+    char defines[256];
+    snprintf(defines, sizeof(defines), "-DFIXTURE_NAME=%s -DFIXTURE_ABI=%u -DFIXTURE_FLAGS=%u -DFIXTURE_BATCH=%d",
+            name, abi, flags, ECHO_BATCH);
+    char source[256];
+    snprintf(source, sizeof(source), "%s/fixture.c", directory);
+    return buildPlugin(source, name, defines);
+}
+
+char *test_discover_validates() {
+    mu_assert(mkdtemp(directory) != NULL, "Expected a temp directory.");
+    char path[256];
+    snprintf(path, sizeof(path), "%s/fixture.c", directory);
+    FILE* file = fopen(path, "w");
+    mu_assert(file, "Expected to write the fixture source.");
+    fputs(fixtureSource, file);
+    fclose(file);
+
+    mu_assert(buildPlugin("plugins/eta_plugin.c", "eta", "") == 0, "Expected the eta plugin to build.");
+    mu_assert(buildFixture("echo", ZETA_PLUGIN_ABI_VERSION, ZETA_PLUGIN_F32) == 0, "Expected the echo fixture to build.");
+    mu_assert(buildFixture("future", ZETA_PLUGIN_ABI_VERSION + 1, ZETA_PLUGIN_F32 | ZETA_PLUGIN_THREAD_SAFE) == 0,
+            "Expected the future fixture to build.");
+    //declares f64 but only has an f32 kernel
+    mu_assert(buildFixture("hollow", ZETA_PLUGIN_ABI_VERSION, ZETA_PLUGIN_F64) == 0, "Expected the hollow fixture to build.");
+
+    mu_assert(pluginDiscover(&registry, "/nonexistent/zeta_plugins") == 0, "A missing directory should load nothing.");
+    mu_assert(pluginDiscover(&registry, directory) == 2, "Only the eta and echo plugins should load.");
+    mu_assert(pluginFind(&registry, "eta") && pluginFind(&registry, "echo"), "Expected eta and echo by name.");
+    mu_assert(!pluginFind(&registry, "future"), "A plugin built for another ABI should be rejected.");
+    mu_assert(!pluginFind(&registry, "hollow"), "A plugin without a kernel for its flags should be rejected.");
+    fprintf(stdout, "[X] Discovery loads 2 plugins and rejects 2.\n");
+    return NULL;
+}
+
+//the f64 kernel runs through the staging buffers in batches of 64 with a short tail
+char *test_eta_matches_sum() {
+    ZetaPlugin* eta = pluginFind(&registry, "eta");
+    mu_assert(eta, "Expected the eta plugin.");
+    f32 sigma[ROW_COUNT], re[ROW_COUNT], im[ROW_COUNT];
+    f32 t = 14.134725f;
+    for (u32 k = 0; k < ROW_COUNT; k++) {
+        sigma[k] = 0.25f + 1.5f * k / ROW_COUNT;
+    }
+    pluginRow(eta, sigma, t, ROW_COUNT, re, im);
+    for (u32 k = 0; k < ROW_COUNT; k++) {
+        f64 sumRe = 0.0, sumIm = 0.0;
+        for (u32 n = 1; n <= ETA_TERMS; n++) {
+            f64 amp = pow((f64)n, -(f64)sigma[k]) * ((n & 1) ? 1.0 : -1.0);
+            sumRe += amp * cos(t * log((f64)n));
+            sumIm -= amp * sin(t * log((f64)n));
+        }
+        f64 scale = 1.0 + sqrt(sumRe * sumRe + sumIm * sumIm);
+        mu_assert(fabs(re[k] - sumRe) < 1e-4 * scale && fabs(im[k] - sumIm) < 1e-4 * scale,
+                "pluginRow should match a direct eta sum.");
+    }
+    fprintf(stdout, "[X] Eta plugin matches the direct sum at %d points.\n", ROW_COUNT);
+    return NULL;
+}
+
+static u32 echoFailures;
+
+static void echoRows(void* ctx, u32 begin, u32 end) {
+    f32 sigma[ROW_COUNT], re[ROW_COUNT], im[ROW_COUNT];
+    for (u32 row = begin; row < end; row++) {
+        for (u32 k = 0; k < ROW_COUNT; k++) {
+            sigma[k] = 1.0f + k;
+        }
+        pluginRow(ctx, sigma, (f32)row, ROW_COUNT, re, im);
+        for (u32 k = 0; k < ROW_COUNT; k++) {
+            if(re[k] != sigma[k] || im[k] != (f32)row) {
+                __atomic_add_fetch(&echoFailures, 1, __ATOMIC_RELAXED);
+            }
+        }
+    }
+}
+
+//not thread safe, so rows on every worker must still enter it one at a time and in batches of ECHO_BATCH
+char *test_serialized_batches() {
+    ZetaPlugin* echo = pluginFind(&registry, "echo");
+    mu_assert(echo, "Expected the echo plugin.");
+    parallelInit(4);
+    parallelFor(ECHO_ROWS, 1, echoRows, echo);
+    parallelShutdown();
+    mu_assert(echoFailures == 0, "The kernel should see small batches and never overlap.");
+
+    pluginUnloadAll(&registry);
+    mu_assert(registry.count == 0, "Unloading should empty the registry.");
+    static const char* files[] = { "eta.so", "echo.so", "future.so", "hollow.so", "fixture.c" };
+    char path[256];
+    for (u32 k = 0; k < sizeof(files) / sizeof(files[0]); k++) {
+        snprintf(path, sizeof(path), "%s/%s", directory, files[k]);
+        unlink(path);
+    }
+    rmdir(directory);
+    fprintf(stdout, "[X] Serialized plugin saw batches of at most %d from 4 workers.\n", ECHO_BATCH);
+    return NULL;
+}
+
+static char* all_tests() {
+    mu_run_test(test_discover_validates);
+    mu_run_test(test_eta_matches_sum);
+    mu_run_test(test_serialized_batches);
+    return NULL;
+}
+
+RUN_TESTS(all_tests);
@@ -0,0 +1,156 @@
+#include <math.h>
+#include <stdlib.h>
+#include "minunit.h"
+#include "pyramid.h"
+#include "parallel.h"
+
+mu_suite_start();
+int tests_run = 0;
+
+#define MAP_SIZE 1024 * 1024 * 4
+//neither side a multiple of PYRAMID_TILE so the edge tiles are partial
+#define GRID_W 61
+#define GRID_H 45
+#define MAX_CELLS 256
+#define MAG_BELOW 0.5f
+#define ZEROS 3
+
+static ZetaPoint grid[GRID_W * GRID_H];
+static PyramidCell found[MAX_CELLS];
+static PyramidCell scanned[MAX_CELLS];
+
+//f(z) = prod (z - zero_k) over x, y in [-3, 3] x [-2, 2], zeros off the sample lines
+static void fillGrid(const f32* zeroRe, const f32* zeroIm, u32 x0, u32 y0, u32 x1, u32 y1) {
+    for (u32 y = y0; y <= y1; y++) {
+        for (u32 x = x0; x <= x1; x++) {
+            f32 zr = -3.0f + 6.0f * x / (GRID_W - 1);
+            f32 zi = -2.0f + 4.0f * y / (GRID_H - 1);
+            f32 re = 1.0f, im = 0.0f;
+            for (u32 k = 0; k < ZEROS; k++) {
+                f32 dr = zr - zeroRe[k], di = zi - zeroIm[k];
+                f32 r = re * dr - im * di;
+                im = re * di + im * dr;
+                re = r;
+            }
+            ZetaPoint* zp = &grid[y * GRID_W + x];
+            zp->sigma = zr;
+            zp->t = zi;
+            zp->re = re;
+            zp->im = im;
+            zp->mag = sqrtf(re * re + im * im);
+            zp->arg = atan2f(im, re);
+        }
+    }
+}
+
+//the same test zeroVisit makes, on every cell of the grid
+static u32 bruteForce(PyramidCell* cells) {
+    u32 count = 0;
+    for (u32 y = 0; y + 1 < GRID_H; y++) {
+        for (u32 x = 0; x + 1 < GRID_W; x++) {
+            const ZetaPoint* corner[4] = { &grid[y * GRID_W + x], &grid[y * GRID_W + x + 1],
+                &grid[(y + 1) * GRID_W + x], &grid[(y + 1) * GRID_W + x + 1] };
+            u32 rePos = 0, reNeg = 0, imPos = 0, imNeg = 0;
+            f32 mag = corner[0]->mag;
+            for (u32 k = 0; k < 4; k++) {
+                rePos |= corner[k]->re >= 0.0f;
+                reNeg |= corner[k]->re <= 0.0f;
+                imPos |= corner[k]->im >= 0.0f;
+                imNeg |= corner[k]->im <= 0.0f;
+                mag = (corner[k]->mag < mag) ? corner[k]->mag : mag;
+            }
+            if(rePos && reNeg && imPos && imNeg && mag <= MAG_BELOW && count < MAX_CELLS) {
+                cells[count].x = x;
+                cells[count].y = y;
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+static int byCell(const void* a, const void* b) {
+    const PyramidCell* p = a;
+    const PyramidCell* q = b;
+    return (p->y != q->y) ? (p->y > q->y) - (p->y < q->y) : (p->x > q->x) - (p->x < q->x);
+}
+
+static u32 sameCells(PyramidCell* a, PyramidCell* b, u32 count) {
+    qsort(a, count, sizeof(PyramidCell), byCell);
+    qsort(b, count, sizeof(PyramidCell), byCell);
+    for (u32 i = 0; i < count; i++) {
+        if(a[i].x != b[i].x || a[i].y != b[i].y) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static u32 containsZero(const PyramidCell* cells, u32 count, f32 zr, f32 zi) {
+    u32 x = (u32)((zr + 3.0f) / 6.0f * (GRID_W - 1));
+    u32 y = (u32)((zi + 2.0f) / 4.0f * (GRID_H - 1));
+    for (u32 i = 0; i < count; i++) {
+        if(cells[i].x == x && cells[i].y == y) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+char *test_zeros_match_scan() {
+    memMap* map = initMemMap(MAP_SIZE);
+    PageArena* arena = createPageArena(map, MAP_SIZE / 2);
+    ZetaPyramid pyramid;
+    mu_assert(pyramidInit(&pyramid, arena, 1, GRID_H) != 0, "A one sample wide grid should be rejected.");
+    mu_assert(pyramidInit(&pyramid, arena, GRID_W, GRID_H) == 0, "Expected a pyramid.");
+    mu_assert(pyramid.levelW[pyramid.levelCount - 1] == 1 && pyramid.levelH[pyramid.levelCount - 1] == 1,
+            "The top level should be one node.");
+
+    f32 zeroRe[ZEROS] = { -1.91f, 0.37f, 2.23f };
+    f32 zeroIm[ZEROS] = { -0.73f, 1.29f, 0.11f };
+    fillGrid(zeroRe, zeroIm, 0, 0, GRID_W - 1, GRID_H - 1);
+    pyramidBuild(&pyramid, grid);
+    u32 count = pyramidZeroCandidates(&pyramid, grid, MAG_BELOW, found, MAX_CELLS);
+    u32 expect = bruteForce(scanned);
+    mu_assert(count == expect && count < MAX_CELLS, "The pyramid should find as many cells as the scan.");
+    mu_assert(sameCells(found, scanned, count), "The pyramid should find the same cells as the scan.");
+    for (u32 k = 0; k < ZEROS; k++) {
+        mu_assert(containsZero(found, count, zeroRe[k], zeroIm[k]), "Every zero's cell should be a candidate.");
+    }
+    mu_assert(pyramidZeroCandidates(&pyramid, grid, MAG_BELOW, found, 1) == count, "A full buffer still counts every cell.");
+    mu_assert(pyramidZeroCandidates(&pyramid, grid, 0.0f, found, MAX_CELLS) == 0, "A zero bound should prune every tile.");
+
+    //refill a block with a zero of its own, the pyramid only rebuilds the tiles touching it
+    f32 patchRe[ZEROS] = { 0.93f, 0.93f, 0.93f };
+    f32 patchIm[ZEROS] = { -1.41f, -1.41f, -1.41f };
+    fillGrid(patchRe, patchIm, 30, 3, 47, 12);
+    pyramidUpdate(&pyramid, grid, 30, 3, 47, 12);
+    count = pyramidZeroCandidates(&pyramid, grid, MAG_BELOW, found, MAX_CELLS);
+    expect = bruteForce(scanned);
+    mu_assert(count == expect && count < MAX_CELLS, "Updated pyramid should count the cells of a fresh scan.");
+    mu_assert(sameCells(found, scanned, count), "Updated pyramid should match a fresh scan.");
+    mu_assert(containsZero(found, count, patchRe[0], patchIm[0]), "The patched zero should be found.");
+
+    arenaPagePop(map);
+    releasePages(map);
+    fprintf(stdout, "[X] Pyramid zero candidates match a full scan, %u cells.\n", count);
+    return NULL;
+}
+
+static char* all_tests() {
+    mu_run_test(test_zeros_match_scan);
+    return NULL;
+}
+
+int main(int argc, char* argv[]) {
+    parallelInit(4);
+    char* result = all_tests();
+    parallelShutdown();
+    if(result != 0) {
+        printf("FAILED: %s\n", result);
+    } else {
+        printf("ALL TESTS PASSED\n");
+    }
+    printf("Tests run: %d\n", tests_run);
+    exit(result != 0);
+}
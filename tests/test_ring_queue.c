@@ -0,0 +1,97 @@
+#include <pthread.h>
+#include "minunit.h"
+#include "ring_queue.h"
+
+mu_suite_start();
+int tests_run = 0;
+
+#define MAP_SIZE 1024 * 1024 * 4
+#define STRESS_COUNT 50000
+#define PRODUCERS 3
+
+char *test_spsc_wrap_and_batch() {
+    memMap* map = initMemMap(MAP_SIZE);
+    PageArena* arena = createPageArena(map, MAP_SIZE / 2);
+    SpscRing* ring = spscCreate(arena, 8, sizeof(u32));
+    mu_assert(ring && ring->capacity == 8, "Expected an 8 slot ring.");
+    u32 in[12];
+    u32 out[12];
+    for (u32 i = 0; i < 12; i++) {
+        in[i] = i;
+    }
+    mu_assert(spscPush(ring, in, 5) == 5, "Expected 5 pushed.");
+    mu_assert(spscPop(ring, out, 3) == 3 && out[2] == 2, "Expected 3 popped in order.");
+    mu_assert(spscPush(ring, in + 5, 7) == 6, "Push should stop when the ring is full.");
+    mu_assert(spscPop(ring, out, 12) == 8, "Expected everything left popped.");
+    for (u32 i = 0; i < 8; i++) {
+        mu_assert(out[i] == i + 3, "Elements should come back in order across the wrap.");
+    }
+    mu_assert(spscPop(ring, out, 1) == 0, "Empty ring should pop nothing.");
+    arenaPagePop(map);
+    releasePages(map);
+    fprintf(stdout, "[X] SPSC wrap and batches.\n");
+    return NULL;
+}
+
+static MpscRing* sharedRing;
+
+static void* produce(void* arg) {
+    u64 id = (u64)(usize)arg;
+    u64 batch[4];
+    for (u64 i = 0; i < STRESS_COUNT;) {
+        u32 n = 0;
+        for (; n < 4 && i + n < STRESS_COUNT; n++) {
+            batch[n] = (id << 32) | (i + n);
+        }
+        u32 pushed = mpscPush(sharedRing, batch, n);
+        i += pushed;
+        if(pushed < n) {
+            for (u32 k = 0; k + pushed < n; k++) {
+                batch[k] = batch[k + pushed];
+            }
+        }
+    }
+    return NULL;
+}
+
+char *test_mpsc_order_per_producer() {
+    memMap* map = initMemMap(MAP_SIZE);
+    PageArena* arena = createPageArena(map, MAP_SIZE / 2);
+    sharedRing = mpscCreate(arena, 1024, sizeof(u64));
+    mu_assert(sharedRing != NULL, "Expected an MPSC ring.");
+    pthread_t threads[PRODUCERS];
+    for (u32 p = 0; p < PRODUCERS; p++) {
+        pthread_create(&threads[p], NULL, produce, (void*)(usize)p);
+    }
+    u64 next[PRODUCERS] = {0};
+    u64 received = 0;
+    u64 items[16];
+    u32 ordered = 1;
+    while(received < (u64)PRODUCERS * STRESS_COUNT) {
+        u32 n = mpscPop(sharedRing, items, 16);
+        for (u32 i = 0; i < n; i++) {
+            u64 p = items[i] >> 32;
+            ordered &= (p < PRODUCERS && (items[i] & 0xFFFFFFFFu) == next[p]);
+            if(p < PRODUCERS) {
+                next[p]++;
+            }
+        }
+        received += n;
+    }
+    for (u32 p = 0; p < PRODUCERS; p++) {
+        pthread_join(threads[p], NULL);
+    }
+    mu_assert(ordered, "Each producer's items should arrive once and in order.");
+    arenaPagePop(map);
+    releasePages(map);
+    fprintf(stdout, "[X] MPSC per-producer order.\n");
+    return NULL;
+}
+
+static char* all_tests() {
+    mu_run_test(test_spsc_wrap_and_batch);
+    mu_run_test(test_mpsc_order_per_producer);
+    return NULL;
+}
+
+RUN_TESTS(all_tests);
@@ -0,0 +1,182 @@
+#include <math.h>
+#include "minunit.h"
+#include "sampling.h"
+
+mu_suite_start();
+int tests_run = 0;
+
+#define MAP_SIZE 1024 * 1024 * 4
+#define STEPS 1000
+#define LATTICE_W 33
+#define LATTICE_H 57
+
+typedef struct AxisCase {
+    const char* name;
+    AxisMap axis;
+} AxisCase;
+
+static AxisCase cases[4];
+static ZetaPoint grid[LATTICE_W * LATTICE_H];
+static ZetaVertex vertexGrid[LATTICE_W * LATTICE_H];
+static u32 indices[(LATTICE_W - 1) * (LATTICE_H - 1) * 6];
+
+static void buildCases(void) {
+    cases[0].name = "uniform";
+    axisUniform(&cases[0].axis, -2.0f, 3.0f);
+    //crosses zero, so asinh is used on both sides
+    cases[1].name = "log";
+    axisLog(&cases[1].axis, -40.0f, 200.0f, 2.0f);
+    cases[2].name = "zero density";
+    axisZeroDensity(&cases[2].axis, 0.0f, 300.0f, 0.05f);
+    cases[3].name = "critical";
+    axisCritical(&cases[3].axis, -1.0f, 2.0f, 0.5f, 0.1f, 8.0f);
+}
+
+char *test_axis_round_trip() {
+    buildCases();
+    for (u32 c = 0; c < 4; c++) {
+        const AxisMap* axis = &cases[c].axis;
+        mu_assert(fabsf(axisForward(axis, 0.0f) - axis->min) < 1e-4f * (1.0f + fabsf(axis->min)) &&
+                fabsf(axisForward(axis, 1.0f) - axis->max) < 1e-4f * (1.0f + fabsf(axis->max)),
+                "Forward should map the unit interval onto the axis range.");
+        f32 last = axisForward(axis, 0.0f);
+        for (u32 k = 1; k <= STEPS; k++) {
+            f32 u = (f32)k / STEPS;
+            f32 x = axisForward(axis, u);
+            mu_assert(x > last, "Forward should be strictly increasing.");
+            last = x;
+            if(fabsf(axisInverse(axis, x) - u) > 1e-5f) {
+                fprintf(stderr, "%s: inverse(forward(%f)) = %f\n", cases[c].name, u, axisInverse(axis, x));
+                mu_assert(0, "Inverse should undo forward.");
+            }
+        }
+    }
+    fprintf(stdout, "[X] 4 axis warps round trip over %d steps.\n", STEPS);
+    return NULL;
+}
+
+//samples crowd where the density is high: higher t for zeros, the focus for the critical line
+char *test_axis_density() {
+    const AxisMap* zeros = &cases[2].axis;
+    f32 step = 1.0f / STEPS;
+    f32 lowGap = axisForward(zeros, 0.1f + step) - axisForward(zeros, 0.1f);
+    f32 highGap = axisForward(zeros, 0.9f + step) - axisForward(zeros, 0.9f);
+    mu_assert(highGap < lowGap, "Zero density samples should tighten as t grows.");
+    f32 prevGap = INFINITY;
+    for (u32 k = 1; k < STEPS; k++) {
+        f32 u = (f32)k / STEPS;
+        f32 gap = axisForward(zeros, u + step) - axisForward(zeros, u);
+        mu_assert(gap <= prevGap * 1.001f, "Zero density spacing should never widen with t.");
+        prevGap = gap;
+    }
+
+    const AxisMap* critical = &cases[3].axis;
+    f32 uFocus = axisInverse(critical, 0.5f);
+    f32 focusGap = axisForward(critical, uFocus + step) - axisForward(critical, uFocus);
+    f32 edgeGap = axisForward(critical, 1.0f) - axisForward(critical, 1.0f - step);
+    mu_assert(focusGap * 4.0f < edgeGap, "Critical samples should crowd around the focus.");
+
+    AxisMap fallback;
+    axisLog(&fallback, 1.0f, 2.0f, 0.0f);
+    mu_assert(fallback.warp == AXIS_UNIFORM, "A zero log scale should fall back to uniform.");
+    axisZeroDensity(&fallback, 1.0f, 2.0f, -1.0f);
+    mu_assert(fallback.warp == AXIS_UNIFORM, "A negative floor density should fall back to uniform.");
+    axisCritical(&fallback, 1.0f, 2.0f, 0.5f, 0.0f, 1.0f);
+    mu_assert(fallback.warp == AXIS_UNIFORM, "A zero critical width should fall back to uniform.");
+    fprintf(stdout, "[X] Warped axes place samples by their density.\n");
+    return NULL;
+}
+
+//the identity puts every vertex at its lattice position, so rendered distances are lattice distances
+static void identityRow(void* ctx, const f32* sigma, f32 t, u32 count, f32* re_out, f32* im_out) {
+    for (u32 j = 0; j < count; j++) {
+        re_out[j] = sigma[j];
+        im_out[j] = t;
+    }
+}
+
+static f32 distance2(u32 a, u32 b) {
+    f32 dx = vertexGrid[a].re - vertexGrid[b].re;
+    f32 dy = vertexGrid[a].im - vertexGrid[b].im;
+    f32 dz = vertexGrid[a].mag - vertexGrid[b].mag;
+    return dx * dx + dy * dy + dz * dz;
+}
+
+char *test_lattice_pick_and_mesh() {
+    memMap* map = initMemMap(MAP_SIZE);
+    PageArena* arena = createPageArena(map, MAP_SIZE / 2);
+    SampleLattice lattice;
+    mu_assert(latticeInit(&lattice, arena, 1, LATTICE_H, &cases[3].axis, &cases[2].axis) != 0,
+            "A one sample wide lattice should be rejected.");
+    mu_assert(latticeInit(&lattice, arena, LATTICE_W, LATTICE_H, &cases[3].axis, &cases[2].axis) == 0,
+            "Expected a lattice.");
+
+    for (u32 i = 0; i < LATTICE_H; i++) {
+        for (u32 j = 0; j < LATTICE_W; j++) {
+            f32 gx, gy;
+            latticePick(&lattice, lattice.sigma[j], lattice.t[i], &gx, &gy);
+            mu_assert(fabsf(gx - j) < 1e-3f && fabsf(gy - i) < 1e-3f, "Picking a sample should give its grid position.");
+        }
+    }
+    f32 gx, gy;
+    f32 midSigma = 0.5f * (lattice.sigma[10] + lattice.sigma[11]);
+    latticePick(&lattice, midSigma, lattice.t[20], &gx, &gy);
+    mu_assert(gx > 10.0f && gx < 11.0f, "Picking between samples should land between their columns.");
+
+    populateMeshLattice(grid, vertexGrid, &lattice, identityRow, NULL);
+    for (u32 i = 0; i < LATTICE_H; i++) {
+        for (u32 j = 0; j < LATTICE_W; j++) {
+            const ZetaPoint* zp = &grid[i * LATTICE_W + j];
+            mu_assert(zp->sigma == lattice.sigma[j] && zp->t == lattice.t[i] && zp->re == zp->sigma,
+                    "Every point should be evaluated at its lattice sample.");
+        }
+    }
+
+    //both triangles of a quad wind the same way in grid space, share the shorter diagonal and cover all four corners
+    generateMeshLattice(indices, vertexGrid, LATTICE_W, LATTICE_H);
+    u32 quad = 0;
+    for (u32 i = 0; i + 1 < LATTICE_H; i++) {
+        for (u32 j = 0; j + 1 < LATTICE_W; j++, quad++) {
+            const u32* tri = &indices[quad * 6];
+            u32 corners = 0;
+            for (u32 k = 0; k < 6; k += 3) {
+                i32 x[3], y[3];
+                for (u32 v = 0; v < 3; v++) {
+                    mu_assert(tri[k + v] < LATTICE_W * LATTICE_H, "Indices should stay inside the grid.");
+                    x[v] = (i32)(tri[k + v] % LATTICE_W) - (i32)j;
+                    y[v] = (i32)(tri[k + v] / LATTICE_W) - (i32)i;
+                    mu_assert(x[v] >= 0 && x[v] <= 1 && y[v] >= 0 && y[v] <= 1, "Triangles should stay in their quad.");
+                    corners |= 1u << (y[v] * 2 + x[v]);
+                }
+                i32 area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+                mu_assert(area == -1, "Every triangle should be non degenerate with the generateMesh winding.");
+            }
+            mu_assert(corners == 0xF, "The two triangles should cover the quad.");
+            u32 topLeft = i * LATTICE_W + j;
+            u32 a = topLeft + 1, b = topLeft + LATTICE_W;
+            if(distance2(a, b) > distance2(topLeft, topLeft + LATTICE_W + 1)) {
+                a = topLeft;
+                b = topLeft + LATTICE_W + 1;
+            }
+            for (u32 k = 0; k < 6; k += 3) {
+                u32 hasA = tri[k] == a || tri[k + 1] == a || tri[k + 2] == a;
+                u32 hasB = tri[k] == b || tri[k + 1] == b || tri[k + 2] == b;
+                mu_assert(hasA && hasB, "Quads should split along the shorter rendered diagonal.");
+            }
+        }
+    }
+
+    arenaPagePop(map);
+    releasePages(map);
+    fprintf(stdout, "[X] Lattice picks recover grid coordinates, %u quads split cleanly.\n", quad);
+    return NULL;
+}
+
+static char* all_tests() {
+    mu_run_test(test_axis_round_trip);
+    mu_run_test(test_axis_density);
+    mu_run_test(test_lattice_pick_and_mesh);
+    return NULL;
+}
+
+RUN_TESTS(all_tests);